@@ -249,6 +249,7 @@ XCSOAR_SOURCES := \
 	$(SRC)/Computer/GlideRatioCalculator.cpp \
 	$(SRC)/Computer/GlideRatioComputer.cpp \
 	$(SRC)/Computer/GlideComputer.cpp \
+	$(SRC)/Computer/PipelineProfile.cpp \
 	$(SRC)/Computer/GlideComputerBlackboard.cpp \
 	$(SRC)/Computer/GlideComputerAirData.cpp \
 	$(SRC)/Computer/WaveComputer.cpp \
@@ -508,6 +509,7 @@ XCSOAR_SOURCES := \
 	$(SRC)/Computer/Settings.cpp \
 	$(SRC)/MergeThread.cpp \
 	$(SRC)/CalculationThread.cpp \
+	$(SRC)/SolverThread.cpp \
 	$(SRC)/DisplayMode.cpp \
 	\
 	$(SRC)/Topography/TopographyFile.cpp \
@@ -55,7 +55,7 @@ PYTHON_SOURCES = \
 	$(SRC)/NMEA/Aircraft.cpp
 PYTHON_LDADD = $(DEBUG_REPLAY_LDADD)
 PYTHON_LDLIBS = $(shell python-config --ldflags)
-PYTHON_DEPENDS = CONTEST WAYPOINT UTIL ZZIP GEO MATH TIME
+PYTHON_DEPENDS = CONTEST THREAD WAYPOINT UTIL ZZIP GEO MATH TIME
 PYTHON_CPPFLAGS = $(shell python-config --includes) \
 	-I$(TEST_SRC_DIR) -Wno-write-strings
 PYTHON_FILTER_FLAGS = -Wwrite-strings
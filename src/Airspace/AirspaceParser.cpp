@@ -39,11 +39,19 @@ Copyright_License {
 #include "Geo/GeoVector.hpp"
 #include "Engine/Airspace/AirspaceClass.hpp"
 #include "Util/StaticString.hxx"
+#include "Thread/Parallel.hpp"
+#include "Thread/Handle.hpp"
+
+#include <vector>
+#include <atomic>
+#include <algorithm>
 
 #include <tchar.h>
 #include <stdio.h>
 #include <stdlib.h>
 
+typedef std::vector<AbstractAirspace *> AirspaceList;
+
 enum class AirspaceFileType {
   UNKNOWN,
   OPENAIR,
@@ -144,6 +152,7 @@ struct TempAirspaceType
   Reset()
   {
     days_of_operation.SetAll();
+    name.clear();
     radio = _T("");
     type = OTHER;
     base = top = AirspaceAltitude();
@@ -166,7 +175,7 @@ struct TempAirspaceType
   }
 
   void
-  AddPolygon(Airspaces &airspace_database)
+  AddPolygon(AirspaceList &airspace_list)
   {
     if (points.size() < 3)
       return;
@@ -175,17 +184,17 @@ struct TempAirspaceType
     as->SetProperties(std::move(name), type, base, top);
     as->SetRadio(radio);
     as->SetDays(days_of_operation);
-    airspace_database.Add(as);
+    airspace_list.push_back(as);
   }
 
   void
-  AddCircle(Airspaces &airspace_database)
+  AddCircle(AirspaceList &airspace_list)
   {
     AbstractAirspace *as = new AirspaceCircle(center, radius);
     as->SetProperties(std::move(name), type, base, top);
     as->SetRadio(radio);
     as->SetDays(days_of_operation);
-    airspace_database.Add(as);
+    airspace_list.push_back(as);
   }
 
   static int
@@ -547,7 +556,7 @@ ValueAfterSpace(const TCHAR *p)
 }
 
 static bool
-ParseLine(Airspaces &airspace_database, TCHAR *line,
+ParseLine(AirspaceList &airspace_list, TCHAR *line,
           TempAirspaceType &temp_area)
 {
   const TCHAR *value;
@@ -581,7 +590,7 @@ ParseLine(Airspaces &airspace_database, TCHAR *line,
     case _T('c'):
       temp_area.radius = Units::ToSysUnit(fixed(ParseDouble(&line[2])),
                                           Unit::NAUTICAL_MILES);
-      temp_area.AddCircle(airspace_database);
+      temp_area.AddCircle(airspace_list);
       temp_area.Reset();
       break;
 
@@ -621,7 +630,7 @@ ParseLine(Airspaces &airspace_database, TCHAR *line,
       if (value == nullptr)
         break;
 
-      temp_area.AddPolygon(airspace_database);
+      temp_area.AddPolygon(airspace_list);
       temp_area.Reset();
 
       temp_area.type = ParseType(value);
@@ -794,7 +803,7 @@ ParseCircleTNP(const TCHAR *buffer, TempAirspaceType &temp_area)
 }
 
 static bool
-ParseLineTNP(Airspaces &airspace_database, TCHAR *line,
+ParseLineTNP(AirspaceList &airspace_list, TCHAR *line,
              TempAirspaceType &temp_area, bool &ignore)
 {
   if (*line == _T('#'))
@@ -824,7 +833,7 @@ ParseLineTNP(Airspaces &airspace_database, TCHAR *line,
     if (!ParseCircleTNP(parameter, temp_area))
       return false;
 
-    temp_area.AddCircle(airspace_database);
+    temp_area.AddCircle(airspace_list);
     temp_area.ResetTNP();
   } else if ((parameter =
       StringAfterPrefixCI(line, _T("CLOCKWISE "))) != nullptr) {
@@ -837,12 +846,12 @@ ParseLineTNP(Airspaces &airspace_database, TCHAR *line,
     if (!ParseArcTNP(parameter, temp_area))
       return false;
   } else if ((parameter = StringAfterPrefixCI(line, _T("TITLE="))) != nullptr) {
-    temp_area.AddPolygon(airspace_database);
+    temp_area.AddPolygon(airspace_list);
     temp_area.ResetTNP();
 
     temp_area.name = parameter;
   } else if ((parameter = StringAfterPrefixCI(line, _T("TYPE="))) != nullptr) {
-    temp_area.AddPolygon(airspace_database);
+    temp_area.AddPolygon(airspace_list);
     temp_area.ResetTNP();
 
     temp_area.type = ParseTypeTNP(parameter);
@@ -881,19 +890,121 @@ DetectFileType(const TCHAR *line)
   return AirspaceFileType::UNKNOWN;
 }
 
-bool
-AirspaceParser::Parse(TLineReader &reader, OperationEnvironment &operation)
+/**
+ * Does this OpenAir line begin a new airspace record?  ParseLine()
+ * starts from a fresh #TempAirspaceType after such a line, so the
+ * file can be split there.
+ */
+gcc_pure
+static bool
+IsRecordStart(const TCHAR *line)
+{
+  return (line[0] == _T('A') || line[0] == _T('a')) &&
+    (line[1] == _T('C') || line[1] == _T('c')) &&
+    (line[2] == _T('\0') || line[2] == _T(' ') || line[2] == _T('*'));
+}
+
+/**
+ * A non-empty line of the airspace file.
+ */
+struct AirspaceLine {
+  /** the position of the line in the text buffer */
+  size_t offset;
+
+  /** the line number in the file, for error messages */
+  unsigned number;
+};
+
+/**
+ * A range of lines which can be parsed independently of the others.
+ */
+struct AirspaceChunk {
+  /** the range within the line list */
+  unsigned begin, end;
+
+  /** the airspaces found in this chunk, in file order */
+  AirspaceList airspaces;
+
+  /** the first line which could not be parsed, or #end */
+  unsigned error;
+
+  AirspaceChunk(unsigned _begin, unsigned _end)
+    :begin(_begin), end(_end), error(_end) {}
+};
+
+/**
+ * The minimum number of lines per chunk, to keep the threading
+ * overhead negligible.
+ */
+static constexpr unsigned MIN_CHUNK_LINES = 1024;
+
+static void
+SplitChunks(AirspaceFileType filetype, const std::vector<TCHAR> &text,
+            const std::vector<AirspaceLine> &lines, unsigned n_threads,
+            std::vector<AirspaceChunk> &chunks)
+{
+  const unsigned n_lines = lines.size();
+
+  if (filetype != AirspaceFileType::OPENAIR) {
+    /* TNP records inherit class, type, radio and activity from their
+       predecessors, so the file must be parsed in one piece */
+    chunks.emplace_back(0, n_lines);
+    return;
+  }
+
+  const unsigned chunk_lines =
+    std::max(n_lines / (n_threads * 4), MIN_CHUNK_LINES);
+
+  unsigned begin = 0;
+  while (begin < n_lines) {
+    unsigned end = std::min(begin + chunk_lines, n_lines);
+    while (end < n_lines && !IsRecordStart(&text[lines[end].offset]))
+      ++end;
+
+    chunks.emplace_back(begin, end);
+    begin = end;
+  }
+}
+
+static void
+ParseChunk(AirspaceFileType filetype, std::vector<TCHAR> &text,
+           const std::vector<AirspaceLine> &lines, AirspaceChunk &chunk)
 {
+  TempAirspaceType temp_area;
   bool ignore = false;
 
-  // Create and init ProgressDialog
+  for (unsigned i = chunk.begin; i < chunk.end; ++i) {
+    TCHAR *line = &text[lines[i].offset];
+
+    const bool success = filetype == AirspaceFileType::OPENAIR
+      ? ParseLine(chunk.airspaces, line, temp_area)
+      : ParseLineTNP(chunk.airspaces, line, temp_area, ignore);
+    if (!success) {
+      chunk.error = i;
+      return;
+    }
+  }
+
+  // Process final area (if any)
+  temp_area.AddPolygon(chunk.airspaces);
+}
+
+bool
+AirspaceParser::Parse(TLineReader &reader, OperationEnvironment &operation)
+{
+  /* Create and init ProgressDialog; the first half of the range is
+     for reading the file, the second half for parsing it */
   operation.SetProgressRange(1024);
 
   const long file_size = reader.GetSize();
 
-  TempAirspaceType temp_area;
   AirspaceFileType filetype = AirspaceFileType::UNKNOWN;
 
+  /* read all relevant lines into one buffer first, so the records can
+     be parsed by several threads */
+  std::vector<TCHAR> text;
+  std::vector<AirspaceLine> lines;
+
   TCHAR *line;
 
   // Iterate through the lines
@@ -910,20 +1021,12 @@ AirspaceParser::Parse(TLineReader &reader, OperationEnvironment &operation)
         continue;
     }
 
-    // Parse the line
-    if (filetype == AirspaceFileType::OPENAIR)
-      if (!ParseLine(airspaces, line, temp_area) &&
-          !ShowParseWarning(line_num, line, operation))
-        return false;
-
-    if (filetype == AirspaceFileType::TNP)
-      if (!ParseLineTNP(airspaces, line, temp_area, ignore) &&
-          !ShowParseWarning(line_num, line, operation))
-        return false;
+    lines.push_back({text.size(), line_num});
+    text.insert(text.end(), line, line + StringLength(line) + 1);
 
     // Update the ProgressDialog
     if ((line_num & 0xff) == 0)
-      operation.SetProgressPosition(reader.Tell() * 1024 / file_size);
+      operation.SetProgressPosition(reader.Tell() * 512 / file_size);
   }
 
   if (filetype == AirspaceFileType::UNKNOWN) {
@@ -931,8 +1034,48 @@ AirspaceParser::Parse(TLineReader &reader, OperationEnvironment &operation)
     return false;
   }
 
-  // Process final area (if any)
-  temp_area.AddPolygon(airspaces);
+  const unsigned n_threads = max_threads > 0
+    ? max_threads
+    : GetProcessorCount();
 
-  return true;
+  std::vector<AirspaceChunk> chunks;
+  SplitChunks(filetype, text, lines, n_threads, chunks);
+
+  operation.SetProgressPosition(512);
+
+  /* the OperationEnvironment may only be used by this thread, which
+     is one of the workers */
+  const ThreadHandle caller = ThreadHandle::GetCurrent();
+  std::atomic<unsigned> finished(0);
+
+  ParallelFor(chunks.size(), n_threads, [filetype, &text, &lines,
+                                         &chunks, &operation,
+                                         caller, &finished](unsigned i){
+    ParseChunk(filetype, text, lines, chunks[i]);
+
+    const unsigned n = ++finished;
+    if (caller.IsInside())
+      operation.SetProgressPosition(512 + n * 512 / chunks.size());
+  });
+
+  /* add the airspaces in file order, up to the first error */
+  bool success = true;
+  for (auto &chunk : chunks) {
+    if (!success) {
+      for (auto *as : chunk.airspaces)
+        delete as;
+      continue;
+    }
+
+    for (auto *as : chunk.airspaces)
+      airspaces.Add(as);
+
+    if (chunk.error != chunk.end) {
+      const AirspaceLine &error = lines[chunk.error];
+      success = ShowParseWarning(error.number, &text[error.offset],
+                                 operation);
+    }
+  }
+
+  return success;
 }
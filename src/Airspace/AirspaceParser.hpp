@@ -32,8 +32,15 @@ class AirspaceParser
 {
   Airspaces &airspaces;
 
+  /**
+   * The maximum number of threads parsing OpenAir records in
+   * parallel; 0 means one per processor.
+   */
+  unsigned max_threads;
+
 public:
-  AirspaceParser(Airspaces &_airspaces): airspaces(_airspaces) {}
+  AirspaceParser(Airspaces &_airspaces, unsigned _max_threads=0)
+    :airspaces(_airspaces), max_threads(_max_threads) {}
 
   bool Parse(TLineReader &reader, OperationEnvironment &operation);
 };
@@ -35,7 +35,8 @@ Copyright_License {
 CalculationThread::CalculationThread(GlideComputer &_glide_computer)
   :WorkerThread("CalcThread", 450, 100, 50),
    force(false),
-   glide_computer(_glide_computer) {
+   glide_computer(_glide_computer),
+   solver_thread(_glide_computer) {
 }
 
 void
@@ -95,6 +96,9 @@ CalculationThread::Tick()
     // perform idle call if time advanced and slow calculations need to be updated
     do_idle |= glide_computer.ProcessGPS(force);
 
+  // pick up the results of the last SolverThread run
+  solver_thread.ReadContestStatistics(glide_computer.SetContestStatistics());
+
   // values changed, so copy them back now: ONLY CALCULATED INFO
   // should be changed in DoCalculations, so we only need to write
   // that one back (otherwise we may write over new data)
@@ -110,7 +114,12 @@ CalculationThread::Tick()
 
   if (do_idle) {
     // do slow calculations last, to minimise latency
-    glide_computer.ProcessIdle();
+    glide_computer.ProcessIdleFast();
+
+    // the solvers run in their own thread on a snapshot, so they
+    // cannot delay the next GPS fix
+    solver_thread.Submit(glide_computer.Basic(), glide_computer.Calculated(),
+                         glide_computer.GetComputerSettings());
   }
 }
 
@@ -27,6 +27,7 @@ Copyright_License {
 #include "Thread/WorkerThread.hpp"
 #include "Thread/Mutex.hpp"
 #include "Computer/Settings.hpp"
+#include "SolverThread.hpp"
 
 class GlideComputer;
 
@@ -56,6 +57,13 @@ class CalculationThread final : public WorkerThread {
   /** Pointer to the GlideComputer that should be used */
   GlideComputer &glide_computer;
 
+  /**
+   * Runs the contest solvers and the task optimisation on snapshots
+   * submitted by this thread.  It is started, suspended and stopped
+   * together with this thread.
+   */
+  SolverThread solver_thread;
+
 public:
   CalculationThread(GlideComputer &_glide_computer);
 
@@ -63,13 +71,41 @@ public:
   void SetScreenDistanceMeters(fixed new_value);
 
   bool Start(bool suspended=false) {
-    if (!WorkerThread::Start(suspended))
+    if (!solver_thread.Start(suspended))
       return false;
 
+    if (!WorkerThread::Start(suspended)) {
+      solver_thread.BeginStop();
+      solver_thread.Join();
+      return false;
+    }
+
     SetLowPriority();
     return true;
   }
 
+  void Suspend() {
+    WorkerThread::BeginSuspend();
+    solver_thread.BeginSuspend();
+    WorkerThread::WaitUntilSuspended();
+    solver_thread.WaitUntilSuspended();
+  }
+
+  void Resume() {
+    solver_thread.Resume();
+    WorkerThread::Resume();
+  }
+
+  void BeginStop() {
+    WorkerThread::BeginStop();
+    solver_thread.BeginStop();
+  }
+
+  void Join() {
+    WorkerThread::Join();
+    solver_thread.Join();
+  }
+
   void ForceTrigger();
 
 protected:
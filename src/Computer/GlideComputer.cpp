@@ -107,16 +107,22 @@ GlideComputer::ProcessGPS(bool force)
 
   calculated.Expire(basic.clock);
 
+  const uint64_t start_us = MonotonicClockUS();
+
   // Process basic information
   air_data_computer.ProcessBasic(Basic(), SetCalculated(),
                                  GetComputerSettings());
+  uint64_t t = profile.Lap(PipelineStage::AIR_DATA, start_us);
 
   // Process basic task information
   task_computer.ProcessBasicTask(basic,
                                  calculated,
                                  GetComputerSettings(),
                                  force);
+  t = profile.Lap(PipelineStage::BASIC_TASK, t);
+
   task_computer.ProcessMoreTask(basic, calculated, GetComputerSettings());
+  t = profile.Lap(PipelineStage::ROUTE, t);
 
   // Check if everything is okay with the gps time and process it
   air_data_computer.FlightTimes(Basic(), SetCalculated(),
@@ -125,6 +131,7 @@ GlideComputer::ProcessGPS(bool force)
   TakeoffLanding(last_flying);
 
   task_computer.ProcessAutoTask(basic, calculated);
+  t = profile.Lap(PipelineStage::FLIGHT_TIMES, t);
 
   // Process extended information
   air_data_computer.ProcessVertical(Basic(),
@@ -132,6 +139,7 @@ GlideComputer::ProcessGPS(bool force)
                                     GetComputerSettings());
 
   stats_computer.ProcessClimbEvents(calculated);
+  t = profile.Lap(PipelineStage::VERTICAL, t);
 
   // Calculate the team code
   CalculateOwnTeamCode();
@@ -154,35 +162,68 @@ GlideComputer::ProcessGPS(bool force)
 
   // Update the ConditionMonitors
   ConditionMonitorsUpdate(Basic(), Calculated(), settings);
+  t = profile.Lap(PipelineStage::MISC, t);
+
+  profile.Add(PipelineStage::GPS, unsigned(t - start_us));
 
   return idle_clock.CheckUpdate(500);
 }
 
 /**
- * Process slow calculations. Called by the CalculationThread.
+ * Process slow calculations synchronously.
  */
 void
 GlideComputer::ProcessIdle(bool exhaustive)
+{
+  ProcessIdleFast();
+  ProcessSolvers(Basic(), SetCalculated(), GetComputerSettings(),
+                 exhaustive);
+}
+
+/**
+ * Process the cheap part of the slow calculations.  Called by the
+ * CalculationThread.
+ */
+void
+GlideComputer::ProcessIdleFast()
 {
   const MoreData &basic = Basic();
   DerivedInfo &calculated = SetCalculated();
 
+  const uint64_t start_us = MonotonicClockUS();
+
   // Log GPS fixes for internal usage
   // (snail trail, stats, olc, ...)
   stats_computer.DoLogging(basic, calculated);
   log_computer.Run(basic, calculated, GetComputerSettings().logger);
-
-  task_computer.ProcessIdle(basic, calculated, GetComputerSettings(),
-                            exhaustive);
+  const uint64_t t = profile.Lap(PipelineStage::LOGGING, start_us);
 
   warning_computer.Update(GetComputerSettings(), basic,
                           calculated, calculated.airspace_warnings);
+  profile.Lap(PipelineStage::WARNINGS, t);
 
   // Calculate summary of flight
   if (basic.location_available)
     retrospective.UpdateSample(basic.location);
 }
 
+/**
+ * Process the contest solvers and the task optimisation.  Called by
+ * the SolverThread.
+ */
+void
+GlideComputer::ProcessSolvers(const MoreData &basic, DerivedInfo &calculated,
+                              const ComputerSettings &settings,
+                              bool exhaustive)
+{
+  const uint64_t start_us = MonotonicClockUS();
+  task_computer.ProcessContest(basic, calculated, settings, exhaustive);
+  const uint64_t t = profile.Lap(PipelineStage::CONTEST, start_us);
+
+  task_computer.ProcessIdleTask(basic, calculated);
+  profile.Lap(PipelineStage::TASK_IDLE, t);
+}
+
 bool
 GlideComputer::DetermineTeamCodeRefLocation()
 {
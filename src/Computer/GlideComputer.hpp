@@ -34,6 +34,7 @@ Copyright_License {
 #include "LogComputer.hpp"
 #include "WarningComputer.hpp"
 #include "CuComputer.hpp"
+#include "PipelineProfile.hpp"
 #include "Compiler.h"
 #include "Engine/Contest/Solvers/Retrospective.hpp"
 
@@ -71,6 +72,8 @@ class GlideComputer : public GlideComputerBlackboard
    */
   DeltaTime trace_history_time;
 
+  PipelineProfile profile;
+
 public:
   GlideComputer(const Waypoints &_way_points,
                 Airspaces &_airspace_database,
@@ -95,8 +98,37 @@ public:
    */
   bool ProcessGPS(bool force=false); // returns true if idle needs processing
 
+  /**
+   * Perform all slow calculations synchronously: ProcessIdleFast()
+   * and ProcessSolvers() on the current blackboard.
+   */
   void ProcessIdle(bool exhaustive=false);
 
+  /**
+   * The part of the slow calculations which must see every GPS fix
+   * and is cheap enough for the #CalculationThread: logging, flight
+   * statistics and airspace warnings.
+   */
+  void ProcessIdleFast();
+
+  /**
+   * Run the contest solvers and the task optimisation.  This does
+   * not access the GlideComputer's blackboard, and may therefore run
+   * in the #SolverThread, on snapshots of #basic and #calculated.
+   * Only DerivedInfo::contest_stats is written.
+   */
+  void ProcessSolvers(const MoreData &basic, DerivedInfo &calculated,
+                      const ComputerSettings &settings,
+                      bool exhaustive=false);
+
+  /**
+   * Returns a writable reference to the contest results, to be
+   * updated with the results of ProcessSolvers() on a snapshot.
+   */
+  ContestStatistics &SetContestStatistics() {
+    return SetCalculated().contest_stats;
+  }
+
   void ProcessExhaustive() {
     ProcessIdle(true);
   }
@@ -141,6 +173,18 @@ public:
     return stats_computer.GetFlightStats();
   }
 
+  /**
+   * Per-stage timing of ProcessGPS(), ProcessIdleFast() and
+   * ProcessSolvers().
+   */
+  const PipelineProfile &GetProfile() const {
+    return profile;
+  }
+
+  PipelineProfile &GetProfile() {
+    return profile;
+  }
+
   const Retrospective &GetRetrospective() const {
     return retrospective;
   }
@@ -0,0 +1,124 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "PipelineProfile.hpp"
+#include "Util/Macros.hpp"
+
+#include <algorithm>
+
+void
+PipelineStageStatistics::Clear()
+{
+  std::fill_n(buckets, N_BUCKETS, 0u);
+  count = 0;
+  total_us = 0;
+  last_us = max_us = 0;
+}
+
+void
+PipelineStageStatistics::Add(unsigned us)
+{
+  if (count >= WINDOW) {
+    /* roll the window: halve all counters */
+    count = 0;
+    for (auto &i : buckets) {
+      i /= 2;
+      count += i;
+    }
+
+    total_us /= 2;
+    max_us = 0;
+  }
+
+  unsigned bucket = 0;
+  for (unsigned i = us >> 1; i > 0 && bucket < N_BUCKETS - 1; i >>= 1)
+    ++bucket;
+
+  ++buckets[bucket];
+  ++count;
+  total_us += us;
+  last_us = us;
+  max_us = std::max(max_us, us);
+}
+
+unsigned
+PipelineStageStatistics::GetPercentile(unsigned percent) const
+{
+  if (count == 0)
+    return 0;
+
+  const unsigned threshold = (count * percent + 99) / 100;
+  unsigned sum = 0;
+  for (unsigned i = 0; i < N_BUCKETS - 1; ++i) {
+    sum += buckets[i];
+    if (sum >= threshold)
+      return 2u << i;
+  }
+
+  return max_us;
+}
+
+void
+PipelineProfile::Clear()
+{
+  const ScopeLock protect(mutex);
+  for (auto &i : stages)
+    i.Clear();
+}
+
+void
+PipelineProfile::Add(PipelineStage stage, unsigned us)
+{
+  const ScopeLock protect(mutex);
+  stages[unsigned(stage)].Add(us);
+}
+
+PipelineStageStatistics
+PipelineProfile::Get(PipelineStage stage) const
+{
+  const ScopeLock protect(mutex);
+  return stages[unsigned(stage)];
+}
+
+const TCHAR *
+PipelineProfile::GetStageName(PipelineStage stage)
+{
+  static const TCHAR *const names[] = {
+    _T("AirData"),
+    _T("BasicTask"),
+    _T("Route"),
+    _T("FlightTimes"),
+    _T("Vertical"),
+    _T("Misc"),
+    _T("GPS"),
+    _T("Logging"),
+    _T("Warnings"),
+    _T("Contest"),
+    _T("TaskIdle"),
+  };
+
+  static_assert(ARRAY_SIZE(names) == unsigned(PipelineStage::COUNT),
+                "Wrong name list");
+
+  return names[unsigned(stage)];
+}
@@ -0,0 +1,168 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_PIPELINE_PROFILE_HPP
+#define XCSOAR_PIPELINE_PROFILE_HPP
+
+#include "Thread/Mutex.hpp"
+#include "OS/Clock.hpp"
+#include "Compiler.h"
+
+#include <stdint.h>
+#include <tchar.h>
+
+/**
+ * The stages of the #GlideComputer pipeline which are timed by
+ * #PipelineProfile.
+ */
+enum class PipelineStage : uint8_t {
+  /** GlideComputerAirData::ProcessBasic() */
+  AIR_DATA,
+
+  /** TaskComputer::ProcessBasicTask() */
+  BASIC_TASK,
+
+  /** TaskComputer::ProcessMoreTask(), mostly reach and route */
+  ROUTE,
+
+  /** GlideComputerAirData::FlightTimes() and takeoff/landing */
+  FLIGHT_TIMES,
+
+  /** GlideComputerAirData::ProcessVertical() */
+  VERTICAL,
+
+  /** team code, voice, trace history and condition monitors */
+  MISC,
+
+  /** the whole GlideComputer::ProcessGPS() call */
+  GPS,
+
+  /** StatsComputer and LogComputer */
+  LOGGING,
+
+  /** WarningComputer::Update() */
+  WARNINGS,
+
+  /** the contest solvers */
+  CONTEST,
+
+  /** task optimisation in TaskManager::UpdateIdle() */
+  TASK_IDLE,
+
+  COUNT
+};
+
+/**
+ * A rolling histogram of the durations of one #PipelineStage.  The
+ * buckets are powers of two microseconds.  When #WINDOW samples have
+ * been collected, all counters are halved, so old samples fade out.
+ */
+struct PipelineStageStatistics {
+  static constexpr unsigned N_BUCKETS = 16;
+  static constexpr unsigned WINDOW = 1024;
+
+  /**
+   * Bucket i counts samples below 2^(i+1) us; the last bucket counts
+   * all samples of 2^(N_BUCKETS-1) us and above.
+   */
+  unsigned buckets[N_BUCKETS];
+
+  /**
+   * The number of samples in the histogram.
+   */
+  unsigned count;
+
+  /**
+   * The sum of all samples in the histogram [us].
+   */
+  uint64_t total_us;
+
+  /**
+   * The most recent sample [us].
+   */
+  unsigned last_us;
+
+  /**
+   * The largest sample since the histogram was last halved [us].
+   */
+  unsigned max_us;
+
+  void Clear();
+
+  void Add(unsigned us);
+
+  gcc_pure
+  unsigned GetAverage() const {
+    return count > 0 ? unsigned(total_us / count) : 0;
+  }
+
+  /**
+   * Returns the upper bound of the histogram bucket which contains
+   * the given percentile [us].
+   */
+  gcc_pure
+  unsigned GetPercentile(unsigned percent) const;
+};
+
+/**
+ * Collects per-stage timing of the #GlideComputer.  Stages may be
+ * timed from the #CalculationThread and from the #SolverThread, and
+ * may be read from any thread.
+ */
+class PipelineProfile {
+  mutable Mutex mutex;
+
+  PipelineStageStatistics stages[unsigned(PipelineStage::COUNT)];
+
+public:
+  PipelineProfile() {
+    Clear();
+  }
+
+  void Clear();
+
+  void Add(PipelineStage stage, unsigned us);
+
+  /**
+   * Add the time since #start_us to the given stage.
+   *
+   * @return the current time, to be passed as #start_us for the
+   * next stage
+   */
+  uint64_t Lap(PipelineStage stage, uint64_t start_us) {
+    const uint64_t now = MonotonicClockUS();
+    Add(stage, unsigned(now - start_us));
+    return now;
+  }
+
+  /**
+   * Returns a copy of the histogram of the given stage.
+   */
+  gcc_pure
+  PipelineStageStatistics Get(PipelineStage stage) const;
+
+  gcc_const
+  static const TCHAR *GetStageName(PipelineStage stage);
+};
+
+#endif
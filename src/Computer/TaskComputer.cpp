@@ -42,7 +42,7 @@ TaskComputer::TaskComputer(ProtectedTaskManager &_task,
                            const ProtectedAirspaceWarningManager *warnings)
   :task(_task),
    route(airspace_database, warnings),
-   contest(trace.GetFull(), trace.GetContest(), trace.GetSprint())
+   contest(trace.GetSolverFull(), trace.GetContest(), trace.GetSprint())
 {
   task.SetRoutePlanner(&route.GetRoutePlanner());
 }
@@ -145,10 +145,12 @@ Predicted(const ContestSettings &settings,
 }
 
 void
-TaskComputer::ProcessIdle(const MoreData &basic, DerivedInfo &calculated,
-                          const ComputerSettings &settings_computer,
-                          bool exhaustive)
+TaskComputer::ProcessContest(const MoreData &basic, DerivedInfo &calculated,
+                             const ComputerSettings &settings_computer,
+                             bool exhaustive)
 {
+  trace.Flush(settings_computer);
+
   contest.SetPredicted(Predicted(settings_computer.contest, basic,
                                  calculated.task_stats.current_leg));
 
@@ -157,7 +159,12 @@ TaskComputer::ProcessIdle(const MoreData &basic, DerivedInfo &calculated,
                             calculated.contest_stats);
   else
     contest.Solve(settings_computer.contest, calculated.contest_stats);
+}
 
+void
+TaskComputer::ProcessIdleTask(const MoreData &basic,
+                              const DerivedInfo &calculated)
+{
   const AircraftState as = ToAircraftState(basic, calculated);
 
   ProtectedTaskManager::ExclusiveLease _task(task);
@@ -101,9 +101,19 @@ public:
    */
   void ProcessAutoTask(const NMEAInfo &basic, const DerivedInfo &calculated);
 
-  void ProcessIdle(const MoreData &basic, DerivedInfo &calculated,
-                   const ComputerSettings &settings_computer,
-                   bool exhaustive=false);
+  /**
+   * Run the contest solvers.  This may be called from the
+   * #SolverThread with snapshots of the blackboard; only
+   * DerivedInfo::contest_stats is written.
+   */
+  void ProcessContest(const MoreData &basic, DerivedInfo &calculated,
+                      const ComputerSettings &settings_computer,
+                      bool exhaustive=false);
+
+  /**
+   * Run the task optimisation (TaskManager::UpdateIdle()).
+   */
+  void ProcessIdleTask(const MoreData &basic, const DerivedInfo &calculated);
 };
 
 #endif
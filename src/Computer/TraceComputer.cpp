@@ -39,8 +39,15 @@ static constexpr unsigned sprint_trace_size =
 static constexpr unsigned full_trace_no_thin_time =
   HasLittleMemory() ? 60 : 120;
 
+/**
+ * The maximum number of points waiting for Flush().  This limit is
+ * only reached if nobody runs the contest solvers.
+ */
+static constexpr unsigned max_pending = 3600;
+
 TraceComputer::TraceComputer()
  :full(full_trace_no_thin_time, Trace::null_time, full_trace_size),
+  solver_full(full_trace_no_thin_time, Trace::null_time, full_trace_size),
   contest(0, Trace::null_time, contest_trace_size),
   sprint(0, 9000, sprint_trace_size)
 {
@@ -52,8 +59,10 @@ TraceComputer::Reset()
   {
     const ScopeLock lock(mutex);
     full.clear();
+    pending.clear();
   }
 
+  solver_full.clear();
   contest.clear();
   sprint.clear();
 }
@@ -87,14 +96,30 @@ TraceComputer::Update(const ComputerSettings &settings_computer,
 
   const TracePoint point(basic);
 
+  const ScopeLock lock(mutex);
+  full.push_back(point);
+
+  if (pending.size() < max_pending)
+    pending.push_back(point);
+}
+
+void
+TraceComputer::Flush(const ComputerSettings &settings_computer)
+{
   {
     const ScopeLock lock(mutex);
-    full.push_back(point);
+    flushing.swap(pending);
   }
 
-  // only olc requires trace_sprint
-  if (settings_computer.contest.enable) {
-    sprint.push_back(point);
-    contest.push_back(point);
+  for (const auto &point : flushing) {
+    solver_full.push_back(point);
+
+    // only olc requires trace_sprint
+    if (settings_computer.contest.enable) {
+      sprint.push_back(point);
+      contest.push_back(point);
+    }
   }
+
+  flushing.clear();
 }
@@ -26,6 +26,7 @@ Copyright_License {
 
 #include "Thread/Mutex.hpp"
 #include "Engine/Trace/Trace.hpp"
+#include "Engine/Trace/Vector.hpp"
 
 struct ComputerSettings;
 struct MoreData;
@@ -33,16 +34,35 @@ struct DerivedInfo;
 
 /**
  * Record a trace of the current flight.
+ *
+ * The full trace is updated directly by the #CalculationThread.  The
+ * contest solvers work on their own copies (see GetSolverFull(),
+ * GetContest(), GetSprint()), which are fed by Flush() in the
+ * #SolverThread, so a long contest solve never blocks Update().
  */
 class TraceComputer {
   /**
-   * This mutex protects trace_full: it must be locked while editing
-   * the trace, and while reading it from a thread other than the
-   * #CalculationThread.
+   * This mutex protects #full and #pending: it must be locked while
+   * editing the trace, and while reading it from a thread other than
+   * the #CalculationThread.
    */
   mutable Mutex mutex;
 
-  Trace full, contest, sprint;
+  Trace full;
+
+  /**
+   * Points which were recorded by Update(), but have not yet been
+   * passed to the solver traces by Flush().  Protected by #mutex.
+   */
+  TracePointVector pending;
+
+  /**
+   * Buffer used by Flush() to move #pending out of the critical
+   * section, kept here to avoid reallocation.
+   */
+  TracePointVector flushing;
+
+  Trace solver_full, contest, sprint;
 
 public:
   TraceComputer();
@@ -63,9 +83,18 @@ public:
     return full;
   }
 
+  /**
+   * Returns an unprotected reference to the solver's copy of the
+   * full trace.  This object may be used only inside the
+   * #SolverThread.
+   */
+  const Trace &GetSolverFull() const {
+    return solver_full;
+  }
+
   /**
    * Returns an unprotected reference to the contest trace.  This
-   * object may be used only inside the #CalculationThread.
+   * object may be used only inside the #SolverThread.
    */
   const Trace &GetContest() const {
     return contest;
@@ -73,12 +102,16 @@ public:
 
   /**
    * Returns an unprotected reference to the sprint trace.  This
-   * object may be used only inside the #CalculationThread.
+   * object may be used only inside the #SolverThread.
    */
   const Trace &GetSprint() const {
     return sprint;
   }
 
+  /**
+   * Clear all traces.  Must not be called while the #SolverThread
+   * is running.
+   */
   void Reset();
 
   /**
@@ -96,6 +129,12 @@ public:
 
   void Update(const ComputerSettings &settings_computer,
               const MoreData &basic, const DerivedInfo &calculated);
+
+  /**
+   * Pass the points recorded by Update() since the last call to the
+   * solver traces.  To be called by the #SolverThread before solving.
+   */
+  void Flush(const ComputerSettings &settings_computer);
 };
 
 #endif
@@ -51,6 +51,8 @@ AirspacePolygon::AirspacePolygon(const std::vector<GeoPoint> &pts,
   } else {
     is_convex = TriState::UNKNOWN;
   }
+
+  band_index.Build(m_border);
 }
 
 const GeoPoint
@@ -82,7 +84,9 @@ AirspacePolygon::GetCenter() const
 bool
 AirspacePolygon::Inside(const GeoPoint &loc) const
 {
-  return m_border.IsInside(loc);
+  return band_index.IsDefined()
+    ? band_index.IsInside(m_border, loc)
+    : m_border.IsInside(loc);
 }
 
 AirspaceIntersectionVector
@@ -94,12 +98,25 @@ AirspacePolygon::Intersects(const GeoPoint &start, const GeoPoint &end,
 
   AirspaceIntersectSort sorter(start, *this);
 
-  for (auto it = m_border.begin(); it + 1 != m_border.end(); ++it) {
-
-    const FlatRay r_seg(it->GetFlatLocation(), (it + 1)->GetFlatLocation());
+  const auto visitor = [this, &ray, &projection, &sorter](unsigned i){
+    const FlatRay r_seg(m_border[i].GetFlatLocation(),
+                        m_border[i + 1].GetFlatLocation());
     fixed t = ray.DistinctIntersection(r_seg);
     if (!negative(t))
       sorter.add(t, projection.Unproject(ray.Parametric(t)));
+  };
+
+  if (band_index.IsDefined()) {
+    /* the flat projection rounds to about 0.001 degrees; look at
+       all edges which may overlap the ray after rounding */
+    const Angle margin = Angle::Degrees(fixed(0.002));
+    band_index.VisitEdges(m_border,
+                          std::min(start.latitude, end.latitude) - margin,
+                          std::max(start.latitude, end.latitude) + margin,
+                          visitor);
+  } else {
+    for (unsigned i = 0; i + 1 < m_border.size(); ++i)
+      visitor(i);
   }
 
   return sorter.all();
@@ -24,6 +24,8 @@
 #define AIRSPACEPOLYGON_HPP
 
 #include "AbstractAirspace.hpp"
+#include "Geo/PolygonBandIndex.hpp"
+
 #include <vector>
 
 #ifdef DO_PRINT
@@ -32,6 +34,13 @@
 
 /** General polygon form airspace */
 class AirspacePolygon final : public AbstractAirspace {
+  /**
+   * Speeds up Inside() and Intersects() for large polygons.  It is
+   * built by the constructor, because the border never changes
+   * afterwards (only its projection does).
+   */
+  PolygonBandIndex band_index;
+
 public:
   /**
    * Constructor.  For testing, pts vector is a cloud of points,
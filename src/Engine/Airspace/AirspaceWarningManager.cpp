@@ -28,11 +28,18 @@
 #include "AirspaceAircraftPerformance.hpp"
 #include "Task/Stats/TaskStats.hpp"
 #include "Predicate/AirspacePredicateAircraftInside.hpp"
+#include "Geo/Flat/FlatRay.hpp"
 
 #define CRUISE_FILTER_FACT fixed(0.5)
 
+/**
+ * Minimum distance (m) the aircraft may fly before the airspace
+ * candidate set needs to be refreshed.
+ */
+#define CANDIDATE_BUFFER fixed(10000)
+
 AirspaceWarningManager::AirspaceWarningManager(const Airspaces &_airspaces)
-  :airspaces(_airspaces), serial(0)
+  :airspaces(_airspaces), serial(0), candidates_valid(false)
 {
   /* force filter initialisation in the first SetConfig() call */
   config.warning_time = -1;
@@ -65,6 +72,9 @@ AirspaceWarningManager::Reset(const AircraftState &state)
   warnings.clear();
   cruise_filter.Reset(state);
   circling_filter.Reset(state);
+
+  candidates.clear();
+  candidates_valid = false;
 }
 
 void 
@@ -134,6 +144,17 @@ AirspaceWarningManager::Update(const AircraftState& state,
   for (auto &w : warnings)
     w.SaveState();
 
+  /* all predictions are limited by the warning time; the speed is
+     only an estimate, queries reaching further than this fall back to
+     searching the airspace tree */
+  fixed speed = state.ground_speed;
+  if (glide_polar.IsValid())
+    speed = std::max(speed, glide_polar.GetVMax());
+  const fixed prediction_time =
+    std::max(fixed(config.warning_time),
+             std::max(prediction_time_glide, prediction_time_filter));
+  UpdateCandidates(state.location, prediction_time * speed);
+
   // check from strongest to weakest alerts
   UpdateInside(state, glide_polar);
   UpdateGlide(state, glide_polar);
@@ -159,6 +180,82 @@ AirspaceWarningManager::Update(const AircraftState& state,
   return changed;
 }
 
+void
+AirspaceWarningManager::UpdateCandidates(const GeoPoint &location,
+                                         fixed range)
+{
+  const FlatProjection &projection = GetProjection();
+  const Airspace corridor(location, projection, range);
+
+  if (candidates_valid && candidate_serial == airspaces.GetSerial() &&
+      candidate_box.Contains(corridor))
+    return;
+
+  candidate_box = Airspace(location, projection,
+                           range + std::max(range, CANDIDATE_BUFFER));
+  candidates = airspaces.FindOverlapping(candidate_box);
+  candidate_serial = airspaces.GetSerial();
+  candidates_valid = true;
+}
+
+void
+AirspaceWarningManager::VisitIntersecting(const GeoPoint &location,
+                                          const GeoPoint &end,
+                                          AirspaceIntersectionVisitor &visitor) const
+{
+  const FlatProjection &projection = GetProjection();
+  const Airspace bb_target(location.Middle(end), projection,
+                           location.Distance(end) / 2);
+
+  if (!candidates_valid || !candidate_box.Contains(bb_target)) {
+    airspaces.VisitIntersecting(location, end, visitor);
+    return;
+  }
+
+  const FlatRay ray(projection.ProjectInteger(location),
+                    projection.ProjectInteger(end));
+
+  for (const auto &as : candidates)
+    if (as.Overlaps(bb_target) && as.Intersects(ray) &&
+        visitor.SetIntersections(as.Intersects(location, end, projection)))
+      visitor.Visit(as);
+}
+
+void
+AirspaceWarningManager::VisitInside(const GeoPoint &location,
+                                    AirspaceVisitor &visitor) const
+{
+  const Airspace bb_target(location, GetProjection());
+
+  if (!candidates_valid || !candidate_box.Contains(bb_target)) {
+    airspaces.VisitInside(location, visitor);
+    return;
+  }
+
+  for (const auto &as : candidates)
+    if (as.Overlaps(bb_target) && as.IsInside(location))
+      visitor.Visit(as);
+}
+
+AirspacesInterface::AirspaceVector
+AirspaceWarningManager::FindInside(const AircraftState &state) const
+{
+  AirspacePredicateAircraftInside condition(state);
+
+  const Airspace bb_target(state.location, GetProjection());
+
+  if (!candidates_valid || !candidate_box.Contains(bb_target))
+    return airspaces.FindInside(state, condition);
+
+  AirspacesInterface::AirspaceVector results;
+  for (const auto &as : candidates)
+    if (as.Overlaps(bb_target) && condition(as.GetAirspace()) &&
+        as.IsInside(state))
+      results.push_back(as);
+
+  return results;
+}
+
 /**
  * Class used temporarily to check intersections with warning system
  */
@@ -300,10 +397,10 @@ AirspaceWarningManager::UpdatePredicted(const AircraftState& state,
                                              warning_state, max_time_limit,
                                              ceiling);
 
-  airspaces.VisitIntersecting(state.location, location_predicted, visitor);
+  VisitIntersecting(state.location, location_predicted, visitor);
 
   visitor.SetMode(true);
-  airspaces.VisitInside(state.location, visitor);
+  VisitInside(state.location, visitor);
 
   return visitor.Found();
 }
@@ -392,9 +489,7 @@ AirspaceWarningManager::UpdateInside(const AircraftState& state,
 
   bool found = false;
 
-  AirspacePredicateAircraftInside condition(state);
-
-  Airspaces::AirspaceVector results = airspaces.FindInside(state, condition);
+  Airspaces::AirspaceVector results = FindInside(state);
   for (const auto &i : results) {
     const AbstractAirspace &airspace = i.GetAirspace();
 
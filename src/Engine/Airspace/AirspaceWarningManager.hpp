@@ -24,7 +24,10 @@
 
 #include "AirspaceWarning.hpp"
 #include "AirspaceWarningConfig.hpp"
+#include "AirspacesInterface.hpp"
 #include "Util/AircraftStateFilter.hpp"
+#include "Util/Serial.hpp"
+#include "Geo/Flat/FlatBoundingBox.hpp"
 #include "Compiler.h"
 
 #include <list>
@@ -34,6 +37,8 @@ class GlidePolar;
 class Airspaces;
 class FlatProjection;
 class AirspaceAircraftPerformance;
+class AirspaceVisitor;
+class AirspaceIntersectionVisitor;
 
 /**
  * Class to detect and track airspace warnings
@@ -66,6 +71,27 @@ class AirspaceWarningManager {
    */
   unsigned serial;
 
+  /**
+   * Airspaces whose bounding box overlaps #candidate_box.  All
+   * queries of one Update() call which fit into that box run their
+   * precise tests on this small set instead of searching the whole
+   * airspace tree.  It is refreshed when the aircraft's prediction
+   * corridor leaves the box or when the airspace database changes.
+   */
+  AirspacesInterface::AirspaceVector candidates;
+
+  /**
+   * The area covered by #candidates, in the airspace projection.
+   */
+  FlatBoundingBox candidate_box;
+
+  /**
+   * The airspace database serial #candidates was collected at.
+   */
+  Serial candidate_serial;
+
+  bool candidates_valid;
+
 public:
   typedef AirspaceWarningList::const_iterator const_iterator;
 
@@ -260,6 +286,35 @@ public:
   bool IsActive(const AbstractAirspace &airspace) const;
 
 private:
+  /**
+   * Make sure #candidates covers all airspaces which may be found
+   * within the given range of the aircraft.
+   *
+   * @param location Location of the aircraft
+   * @param range Expected maximum distance of the predicted positions (m)
+   */
+  void UpdateCandidates(const GeoPoint &location, fixed range);
+
+  /**
+   * Like Airspaces::VisitIntersecting(), but searches #candidates if
+   * they cover the vector.
+   */
+  void VisitIntersecting(const GeoPoint &location, const GeoPoint &end,
+                         AirspaceIntersectionVisitor &visitor) const;
+
+  /**
+   * Like Airspaces::VisitInside(), but searches #candidates if they
+   * cover the location.
+   */
+  void VisitInside(const GeoPoint &location, AirspaceVisitor &visitor) const;
+
+  /**
+   * Like Airspaces::FindInside(), but searches #candidates if they
+   * cover the aircraft location.
+   */
+  gcc_pure
+  AirspacesInterface::AirspaceVector FindInside(const AircraftState &state) const;
+
   bool UpdateTask(const AircraftState &state, const GlidePolar &glide_polar,
                   const TaskStats &task_stats);
   bool UpdateFilter(const AircraftState& state, const bool circling);
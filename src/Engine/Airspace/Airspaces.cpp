@@ -29,7 +29,7 @@
 #include "Geo/Flat/FlatRay.hpp"
 #include "Geo/Flat/TaskProjection.hpp"
 
-#include <functional>
+#include <algorithm>
 
 #ifdef INSTRUMENT_TASK
 extern unsigned n_queries;
@@ -61,10 +61,9 @@ Airspaces::VisitWithinRange(const GeoPoint &location, fixed range,
     // nothing to do
     return;
 
-  Airspace bb_target(location, task_projection);
-  int projected_range = task_projection.ProjectRangeInteger(location, range);
+  const Airspace bb_target(location, task_projection, range);
   AirspacePredicateVisitorAdapter adapter(predicate, visitor);
-  airspace_tree.visit_within_range(bb_target, -projected_range, adapter);
+  airspace_tree.VisitOverlapping(bb_target, adapter);
 
 #ifdef INSTRUMENT_TASK
   n_queries++;
@@ -102,10 +101,9 @@ Airspaces::VisitIntersecting(const GeoPoint &loc, const GeoPoint &end,
     return;
 
   const GeoPoint c = loc.Middle(end);
-  Airspace bb_target(c, task_projection);
-  int projected_range = task_projection.ProjectRangeInteger(c, loc.Distance(end) / 2);
+  const Airspace bb_target(c, task_projection, loc.Distance(end) / 2);
   IntersectingAirspaceVisitorAdapter adapter(loc, end, task_projection, visitor);
-  airspace_tree.visit_within_range(bb_target, -projected_range, adapter);
+  airspace_tree.VisitOverlapping(bb_target, adapter);
 
 #ifdef INSTRUMENT_TASK
   n_queries++;
@@ -117,38 +115,43 @@ Airspaces::VisitIntersecting(const GeoPoint &loc, const GeoPoint &end,
 const Airspaces::AirspaceVector
 Airspaces::ScanRange(const GeoPoint &location, fixed range,
                      const AirspacePredicate &condition) const
+{
+  AirspaceVector res;
+  ScanRange(location, range, condition, res);
+  return res;
+}
+
+void
+Airspaces::ScanRange(const GeoPoint &location, fixed range,
+                     const AirspacePredicate &condition,
+                     AirspaceVector &res) const
 {
   if (IsEmpty())
     // nothing to do
-    return AirspaceVector();
+    return;
 
-  Airspace bb_target(location, task_projection);
-  int projected_range = task_projection.ProjectRangeInteger(location, range);
+  const Airspace bb_target(location, task_projection);
+  const Airspace range_target(location, task_projection, range);
 
 #ifdef INSTRUMENT_TASK
   n_queries++;
 #endif
 
-  AirspaceVector res;
-
-  std::function<void(const Airspace &)> visitor =
-    [&location, range, &condition, &bb_target, &res](const Airspace &v){
+  airspace_tree.VisitOverlapping(range_target,
+                                 [&location, range, &condition, &bb_target,
+                                  &res](const Airspace &v){
     if (condition(v.GetAirspace()) &&
         fixed(v.Distance(bb_target)) <= range &&
         (v.IsInside(location) || positive(range)))
       res.push_back(v);
-  };
-
-  airspace_tree.visit_within_range(bb_target, -projected_range, visitor);
-
-  return res;
+  });
 }
 
 const Airspaces::AirspaceVector
 Airspaces::FindInside(const AircraftState &state,
                       const AirspacePredicate &condition) const
 {
-  Airspace bb_target(state.location, task_projection);
+  const Airspace bb_target(state.location, task_projection);
 
   AirspaceVector vectors;
 
@@ -156,8 +159,8 @@ Airspaces::FindInside(const AircraftState &state,
   n_queries++;
 #endif
 
-  std::function<void(const Airspace &)> visitor =
-    [&state, &condition, &vectors](const Airspace &v){
+  airspace_tree.VisitOverlapping(bb_target,
+                                 [&state, &condition, &vectors](const Airspace &v){
 
 #ifdef INSTRUMENT_TASK
     count_intersections++;
@@ -166,9 +169,23 @@ Airspaces::FindInside(const AircraftState &state,
     if (condition(v.GetAirspace()) &&
         v.IsInside(state))
       vectors.push_back(v);
-  };
+  });
 
-  airspace_tree.visit_within_range(bb_target, 0, visitor);
+  return vectors;
+}
+
+const Airspaces::AirspaceVector
+Airspaces::FindOverlapping(const FlatBoundingBox &box) const
+{
+  AirspaceVector vectors;
+
+#ifdef INSTRUMENT_TASK
+  n_queries++;
+#endif
+
+  airspace_tree.VisitOverlapping(box, [&vectors](const Airspace &v){
+    vectors.push_back(v);
+  });
 
   return vectors;
 }
@@ -189,12 +206,15 @@ Airspaces::Optimise()
   }
 
   if (!tmp_as.empty()) {
+    AirspaceVector items(airspace_tree.begin(), airspace_tree.end());
+    items.reserve(items.size() + tmp_as.size());
+
     while (!tmp_as.empty()) {
-      Airspace as(*tmp_as.front(), task_projection);
-      airspace_tree.insert(as);
+      items.emplace_back(*tmp_as.front(), task_projection);
       tmp_as.pop_front();
     }
-    airspace_tree.optimise();
+
+    airspace_tree.Load(std::move(items));
   }
 
   ++serial;
@@ -247,6 +267,8 @@ Airspaces::Clear()
 
   // then delete the tree
   airspace_tree.clear();
+
+  ++serial;
 }
 
 unsigned
@@ -332,24 +354,21 @@ Airspaces::SynchroniseInRange(const Airspaces &master,
 
   // anything left in the self list are items that were not in the query,
   // so delete them --- including the clearances!
-  for (auto v = contents_self.begin(); v != contents_self.end();) {
-    gcc_unused bool found = false;
-    for (auto t = airspace_tree.begin(); t != airspace_tree.end(); ) {
-      if (&t->GetAirspace() == &v->GetAirspace()) {
-        AirspaceTree::const_iterator new_t = t;
-        ++new_t;
-        airspace_tree.erase_exact(*t);
-        t = new_t;
-        found = true;
-      } else {
-        ++t;
-      }
-    }
-    assert(found);
-    v->ClearClearance();
-    v = contents_self.erase(v);
+  if (!contents_self.empty()) {
+    AirspaceVector keep;
+    keep.reserve(airspace_tree.size());
+    for (const auto &t : airspace_tree)
+      if (std::find(contents_self.begin(), contents_self.end(),
+                    t) == contents_self.end())
+        keep.push_back(t);
+
+    for (const auto &v : contents_self)
+      v.ClearClearance();
+
+    airspace_tree.Load(std::move(keep));
     changed = true;
   }
+
   if (changed)
     Optimise();
   return changed;
@@ -362,13 +381,10 @@ Airspaces::VisitInside(const GeoPoint &loc, AirspaceVisitor &visitor) const
     // nothing to do
     return;
 
-  Airspace bb_target(loc, task_projection);
+  const Airspace bb_target(loc, task_projection);
 
-  std::function<void(const Airspace &)> visitor2 =
-    [&loc, &visitor](const Airspace &v){
+  airspace_tree.VisitOverlapping(bb_target, [&loc, &visitor](const Airspace &v){
     if (v.IsInside(loc))
       visitor.Visit(v);
-  };
-
-  airspace_tree.visit_within_range(bb_target, 0, visitor2);
+  });
 }
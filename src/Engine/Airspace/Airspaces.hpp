@@ -38,28 +38,26 @@ class AirspaceVisitor;
 class AirspaceIntersectionVisitor;
 
 /**
- * Container for airspaces using kd-tree representation internally for
- * fast geospatial lookups.
+ * Container for airspaces using a packed R-tree representation
+ * internally for fast geospatial lookups.
  *
- * Complexity analysis (with kdtree):
+ * Complexity analysis (with R-tree):
  *
- *    Find within range (k points found):
- *     O(n^(3/4) + k)
+ *    Find within range (k airspaces found):
+ *     O(log(n) + k) for small ranges
  *
  *    Find intersecting:
- *     O(n^(3/4) + k)
+ *     O(log(n) + k) for short vectors
  *
- *    Find nearest:
- *     O(log(n))
- *
- *  Without kd-tree:
+ *  Without R-tree:
  *
  *    Find within range:
  *     O(n)
  *    Find intersecting:
  *     O(n)
- *    Find nearest:
- *     O(n)
+ *
+ * The tree is immutable; Optimise() rebuilds it after airspaces have
+ * been added or removed.
  */
 
 class Airspaces : public AirspacesInterface {
@@ -116,8 +114,8 @@ public:
   void Add(AbstractAirspace *asp);
 
   /**
-   * Re-organise the internal airspace tree after inserting/deleting.
-   * Should be called after inserting/deleting airspaces prior to performing
+   * Rebuild the internal airspace tree after inserting/deleting.
+   * Must be called after inserting/deleting airspaces prior to performing
    * any searches, but can be done once after a batch insert/delete.
    */
   void Optimise();
@@ -213,6 +211,16 @@ public:
                                  const AirspacePredicate &condition =
                                        AirspacePredicate::always_true) const;
 
+  /**
+   * Like ScanRange(), but appends the matches to a vector supplied by
+   * the caller, which allows reusing its allocation.
+   *
+   * @param result vector the matching airspaces are appended to
+   */
+  void ScanRange(const GeoPoint &location, fixed range,
+                 const AirspacePredicate &condition,
+                 AirspaceVector &result) const;
+
   /**
    * Find airspaces the aircraft is inside (taking altitude into account)
    *
@@ -226,6 +234,18 @@ public:
                                   const AirspacePredicate &condition =
                                         AirspacePredicate::always_true) const;
 
+  /**
+   * Find airspaces whose bounding box overlaps the given box, without
+   * any precise test.  This is meant for callers which cache a coarse
+   * candidate set for repeated queries in a small area.
+   *
+   * @param box bounding box in the projection of this object
+   *
+   * @return airspaces overlapping the box, in tree order
+   */
+  gcc_pure
+  const AirspaceVector FindOverlapping(const FlatBoundingBox &box) const;
+
   /**
    * Access first airspace in store, for use in iterators.
    *
@@ -22,6 +22,7 @@
 
 #include "ContestManager.hpp"
 #include "Trace/Trace.hpp"
+#include "Thread/Parallel.hpp"
 
 ContestManager::ContestManager(const Contest _contest,
                                const Trace &trace_full,
@@ -40,7 +41,8 @@ ContestManager::ContestManager(const Contest _contest,
    dhv_xc_free(trace_full, true),
    dhv_xc_triangle(trace_triangle, predict_triangle, true),
    sis_at(trace_full),
-   net_coupe(trace_full)
+   net_coupe(trace_full),
+   max_threads(1)
 {
   Reset();
 }
@@ -117,6 +119,30 @@ RunContest(AbstractContest &_contest,
   return true;
 }
 
+/**
+ * Run two solvers which do not depend on each other, concurrently if
+ * more than one thread is allowed.  They share only the (read-only)
+ * source traces.
+ *
+ * @return true if at least one of them has found a new solution
+ */
+static bool
+RunContestPair(AbstractContest &a,
+               ContestResult &result_a, ContestTraceVector &solution_a,
+               AbstractContest &b,
+               ContestResult &result_b, ContestTraceVector &solution_b,
+               bool exhaustive, unsigned max_threads)
+{
+  bool retval[2];
+  ParallelFor(2, max_threads, [&](unsigned i){
+      retval[i] = i == 0
+        ? RunContest(a, result_a, solution_a, exhaustive)
+        : RunContest(b, result_b, solution_b, exhaustive);
+    });
+
+  return retval[0] || retval[1];
+}
+
 bool
 ContestManager::UpdateIdle(bool exhaustive)
 {
@@ -152,11 +178,9 @@ ContestManager::UpdateIdle(bool exhaustive)
     break;
 
   case Contest::OLC_PLUS:
-    retval = RunContest(olc_classic, stats.result[0],
-                        stats.solution[0], exhaustive);
-
-    retval |= RunContest(olc_fai, stats.result[1],
-                         stats.solution[1], exhaustive);
+    retval = RunContestPair(olc_classic, stats.result[0], stats.solution[0],
+                            olc_fai, stats.result[1], stats.solution[1],
+                            exhaustive, max_threads);
 
     if (retval) {
       olc_plus.Feed(stats.result[0], stats.solution[0],
@@ -174,17 +198,15 @@ ContestManager::UpdateIdle(bool exhaustive)
     break;
 
   case Contest::XCONTEST:
-    retval = RunContest(xcontest_free, stats.result[0],
-                        stats.solution[0], exhaustive);
-    retval |= RunContest(xcontest_triangle, stats.result[1],
-                         stats.solution[1], exhaustive);
+    retval = RunContestPair(xcontest_free, stats.result[0], stats.solution[0],
+                            xcontest_triangle, stats.result[1], stats.solution[1],
+                            exhaustive, max_threads);
     break;
 
   case Contest::DHV_XC:
-    retval = RunContest(dhv_xc_free, stats.result[0],
-                        stats.solution[0], exhaustive);
-    retval |= RunContest(dhv_xc_triangle, stats.result[1],
-                         stats.solution[1], exhaustive);
+    retval = RunContestPair(dhv_xc_free, stats.result[0], stats.solution[0],
+                            dhv_xc_triangle, stats.result[1], stats.solution[1],
+                            exhaustive, max_threads);
     break;
 
   case Contest::SIS_AT:
@@ -220,6 +242,28 @@ ContestManager::Reset()
   net_coupe.Reset();
 }
 
+size_t
+ContestManager::GetMemoryUsage() const
+{
+  return olc_sprint.GetMemoryUsage() + olc_fai.GetMemoryUsage() +
+    olc_classic.GetMemoryUsage() + olc_league.GetMemoryUsage() +
+    olc_plus.GetMemoryUsage() + dmst_quad.GetMemoryUsage() +
+    xcontest_free.GetMemoryUsage() + xcontest_triangle.GetMemoryUsage() +
+    dhv_xc_free.GetMemoryUsage() + dhv_xc_triangle.GetMemoryUsage() +
+    sis_at.GetMemoryUsage() + net_coupe.GetMemoryUsage();
+}
+
+unsigned
+ContestManager::GetIterations() const
+{
+  return olc_sprint.GetIterations() + olc_fai.GetIterations() +
+    olc_classic.GetIterations() + olc_league.GetIterations() +
+    olc_plus.GetIterations() + dmst_quad.GetIterations() +
+    xcontest_free.GetIterations() + xcontest_triangle.GetIterations() +
+    dhv_xc_free.GetIterations() + dhv_xc_triangle.GetIterations() +
+    sis_at.GetIterations() + net_coupe.GetIterations();
+}
+
 /*
 
 - SearchPointVector find self intersections (for OLC-FAI)
@@ -62,6 +62,12 @@ class ContestManager
   OLCSISAT sis_at;
   NetCoupe net_coupe;
 
+  /**
+   * The maximum number of threads which may be used by
+   * UpdateIdle().  See SetMaxThreads().
+   */
+  unsigned max_threads;
+
 public:
   /**
    * Base constructor.
@@ -122,11 +128,38 @@ public:
     return SolveExhaustive();
   }
 
+  /**
+   * Allow up to the given number of threads.  Independent
+   * sub-solvers of the selected contest (e.g. OLC Classic and OLC
+   * FAI for OLC Plus) are then solved concurrently, and the triangle
+   * solvers use the threads for the exhaustive search.
+   */
+  void SetMaxThreads(unsigned _max_threads) {
+    max_threads = _max_threads;
+    olc_fai.SetMaxThreads(_max_threads);
+    xcontest_triangle.SetMaxThreads(_max_threads);
+    dhv_xc_triangle.SetMaxThreads(_max_threads);
+  }
+
   /**
    * Reset the task (as if never flown)
    */
   void Reset();
 
+  /**
+   * Returns the number of bytes allocated by all solvers, see
+   * AbstractContest::GetMemoryUsage().
+   */
+  gcc_pure
+  size_t GetMemoryUsage() const;
+
+  /**
+   * Returns the number of search steps of all solvers, see
+   * AbstractContest::GetIterations().
+   */
+  gcc_pure
+  unsigned GetIterations() const;
+
   const ContestStatistics &GetStats() const {
     return stats;
   }
@@ -36,10 +36,17 @@ struct ContestResult
   /** Time (s) of optimised OLC path */
   fixed time;
 
+  /**
+   * Was this path proven to be the optimum of the (thinned) trace
+   * by a completed exact search?
+   */
+  bool optimal;
+
   void Reset() {
     score = fixed(0);
     distance = fixed(0);
     time = fixed(0);
+    optimal = false;
   }
 
   bool IsDefined() const {
@@ -30,6 +30,7 @@
 #include "PathSolvers/SolverResult.hpp"
 
 #include <assert.h>
+#include <stddef.h>
 
 class TracePoint;
 
@@ -101,6 +102,26 @@ public:
    */
   virtual SolverResult Solve(bool exhaustive) = 0;
 
+  /**
+   * Returns the number of bytes allocated by the search.  This
+   * memory is reused by subsequent searches, so this is also the
+   * peak usage.
+   */
+  gcc_pure
+  virtual size_t GetMemoryUsage() const {
+    return 0;
+  }
+
+  /**
+   * Returns the number of search steps (node expansions) performed
+   * since the last Reset().  This is meant for benchmarks; the
+   * meaning of one step depends on the solver.
+   */
+  gcc_pure
+  virtual unsigned GetIterations() const {
+    return 0;
+  }
+
 protected:
   /**
    * Perform check on whether score needs to be
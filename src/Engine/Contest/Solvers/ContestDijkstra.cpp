@@ -41,7 +41,9 @@ ContestDijkstra::ContestDijkstra(const Trace &_trace,
    NavDijkstra(n_legs + 1),
    TraceManager(_trace),
    continuous(_continuous),
-   incremental(false)
+   incremental(false),
+   use_bounds(false),
+   solution_optimal(false)
 {
   assert(num_stages <= MAX_STAGES);
 
@@ -121,7 +123,12 @@ ContestDijkstra::Solve(bool exhaustive)
     dijkstra.Clear();
     dijkstra.Reserve(CONTEST_QUEUE_SIZE);
 
+    use_bounds = !(incremental && continuous);
+    search_optimal = !incremental;
+
     StartSearch();
+    if (use_bounds)
+      UpdateBounds();
     AddStartEdges();
     if (dijkstra.IsEmpty())
       return SolverResult::FAILED;
@@ -129,7 +136,7 @@ ContestDijkstra::Solve(bool exhaustive)
 
   SolverResult result = DistanceGeneral(exhaustive ? 0 - 1 : 25);
   if (result != SolverResult::INCOMPLETE) {
-    if (incremental && continuous)
+    if (incremental && continuous && !use_bounds)
       /* enable the incremental solver, which considers the existing
          Dijkstra edge map */
       finished = true;
@@ -150,6 +157,7 @@ ContestDijkstra::Reset()
   dijkstra.Clear();
   ClearTrace();
   finished = false;
+  n_steps = 0;
 
   AbstractContest::Reset();
 }
@@ -169,6 +177,8 @@ ContestDijkstra::SaveSolution()
          : TraceManager::GetPoint(n_points - 1))
       : TraceManager::GetPoint(NavDijkstra::solution[i]);
 
+  solution_optimal = search_optimal;
+
   return AbstractContest::SaveSolution();
 }
 
@@ -180,6 +190,7 @@ ContestDijkstra::CalculateResult(const ContestTraceVector &solution) const
   ContestResult result;
   result.time = fixed(solution[num_stages - 1].DeltaTime(solution[0]));
   result.distance = result.score = fixed(0);
+  result.optimal = solution_optimal;
 
   GeoPoint previous = solution[0].GetLocation();
   for (unsigned i = 1; i < num_stages; ++i) {
@@ -202,6 +213,65 @@ ContestDijkstra::CalculateResult() const
   return CalculateResult(solution);
 }
 
+void
+ContestDijkstra::UpdateBounds()
+{
+  assert(num_stages <= MAX_STAGES);
+  assert(n_points > 0);
+
+  const unsigned n_legs = num_stages - 1;
+  bounds.assign(n_legs * n_points, 0);
+
+  /* the predicted point may be the finish of any solution */
+  bounds_predicted = predicted.IsDefined();
+
+  /* dynamic programming from the end of the trace: the bound of a
+     point is the best leg to any later point plus that point's bound
+     for the next stage */
+  for (unsigned i = n_points; i-- > 0;) {
+    const TracePoint &origin = TraceManager::GetPoint(i);
+    unsigned *const b = &bounds[i];
+
+    if (bounds_predicted)
+      b[(n_legs - 1) * n_points] = stage_weights[n_legs - 1] *
+        origin.FlatDistanceTo(predicted);
+
+    for (unsigned j = i; j < n_points; ++j) {
+      const unsigned d = origin.FlatDistanceTo(TraceManager::GetPoint(j));
+      const unsigned *const next = &bounds[j];
+
+      for (unsigned stage = 0; stage < n_legs; ++stage) {
+        const unsigned value = stage_weights[stage] * d +
+          (stage + 1 < n_legs ? next[(stage + 1) * n_points] : 0);
+        unsigned &bound = b[stage * n_points];
+        if (value > bound)
+          bound = value;
+      }
+    }
+  }
+}
+
+unsigned
+ContestDijkstra::GetHeuristic(const ScanTaskPoint node) const
+{
+  if (!use_bounds || IsFinal(node) ||
+      predicted.IsDefined() != bounds_predicted)
+    return 0;
+
+  const unsigned stage = node.GetStageNumber();
+  assert(node.GetPointIndex() < n_points);
+  assert((stage + 1) * n_points <= bounds.size());
+
+  /* the Dijkstra cost of each leg is DIJKSTRA_MINMAX_OFFSET minus
+     its weighted distance; see Link() */
+  const unsigned distance = bounds[stage * n_points + node.GetPointIndex()];
+  const unsigned offset = (num_stages - 1 - stage) * DIJKSTRA_MINMAX_OFFSET;
+
+  return distance < offset
+    ? offset - distance
+    : 0;
+}
+
 void
 ContestDijkstra::AddStartEdges()
 {
@@ -30,6 +30,8 @@ Copyright_License {
 #include "Trace/Vector.hpp"
 #include "TraceManager.hpp"
 
+#include <vector>
+
 #include <assert.h>
 
 class Trace;
@@ -68,6 +70,38 @@ class ContestDijkstra : public AbstractContest, protected NavDijkstra, public Tr
    */
   ContestTraceVector solution;
 
+  /**
+   * For each stage and trace point, an upper bound for the weighted
+   * distance which can still be covered from there, indexed by
+   * "stage * n_points + point".  See UpdateBounds().
+   */
+  std::vector<unsigned> bounds;
+
+  /**
+   * Does the current search use #bounds, i.e. is it an A* search
+   * instead of a plain Dijkstra search?  This is disabled for the
+   * continuous incremental search, because AddIncrementalEdges()
+   * needs all nodes of the previous search to be expanded.
+   */
+  bool use_bounds;
+
+  /**
+   * Was #predicted defined when #bounds were calculated?  If that
+   * changes during the search, the bounds are not used anymore.
+   */
+  bool bounds_predicted;
+
+  /**
+   * Does the current search consider all start and finish
+   * candidates, i.e. will its solution be the proven optimum?
+   */
+  bool search_optimal;
+
+  /**
+   * Is #solution the proven optimum of the trace it was found on?
+   */
+  bool solution_optimal;
+
 protected:
   /**
    * The index of the first finish candidate.  During incremental
@@ -144,10 +178,31 @@ protected:
 
   bool Link(const ScanTaskPoint node, const ScanTaskPoint parent,
             unsigned value) {
-    return NavDijkstra::Link(node, parent, DIJKSTRA_MINMAX_OFFSET - value);
+    return NavDijkstra::Link(node, parent, DIJKSTRA_MINMAX_OFFSET - value,
+                             GetHeuristic(node));
+  }
+
+  void LinkStart(const ScanTaskPoint node) {
+    NavDijkstra::LinkStart(node, 0, GetHeuristic(node));
   }
 
 private:
+  /**
+   * Calculate #bounds for the current trace.  This solves the
+   * contest without the altitude rules, which is much cheaper than
+   * the Dijkstra search, and is an admissible estimate for it.
+   */
+  void UpdateBounds();
+
+  /**
+   * Returns a lower bound for the Dijkstra cost from the given node
+   * to any final node, derived from #bounds.  The estimate is
+   * consistent, so the first final node popped is still the
+   * optimum, but nodes which cannot lead to it are never expanded.
+   */
+  gcc_pure
+  unsigned GetHeuristic(ScanTaskPoint node) const;
+
   bool SaveSolution();
 
 protected:
@@ -171,6 +226,17 @@ public:
   SolverResult Solve(bool exhaustive) override;
   void Reset() override;
 
+  gcc_pure
+  size_t GetMemoryUsage() const override {
+    return dijkstra.GetMemoryUsage() +
+      bounds.capacity() * sizeof(bounds.front());
+  }
+
+  gcc_pure
+  unsigned GetIterations() const override {
+    return n_steps;
+  }
+
 protected:
   /* protected virtual methods from AbstractContest */
   ContestResult CalculateResult() const override;
@@ -101,5 +101,6 @@ OLCLeague::CalculateResult() const
   for (unsigned i = 0; i < 4; ++i)
     result.distance += solution[i].DistanceTo(solution[i + 1].GetLocation());
   result.score = ApplyShiftedHandicap(result.distance / 2500);
+  result.optimal = false;
   return result;
 }
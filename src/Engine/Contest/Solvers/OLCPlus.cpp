@@ -57,5 +57,6 @@ OLCPlus::CalculateResult() const
   ContestResult result = result_classic;
   result.score = ApplyHandicap((result_classic.distance +
                                 fixed(0.3) * result_fai.distance) / 1000);
+  result.optimal = result_classic.optimal && result_fai.optimal;
   return result;
 }
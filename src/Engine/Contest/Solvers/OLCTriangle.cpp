@@ -23,7 +23,7 @@
 #include "OLCTriangle.hpp"
 #include "Cast.hpp"
 #include "Trace/Trace.hpp"
-#include "Util/QuadTree.hpp"
+#include "Thread/Parallel.hpp"
 
 #include <limits>
 
@@ -57,6 +57,12 @@
  */
 static constexpr fixed max_distance(1000);
 
+/**
+ * The number of candidate sets which are solved concurrently by
+ * RunParallelBranchAndBound(), distributed over all closing pairs.
+ */
+static constexpr unsigned PARALLEL_SEEDS = 32;
+
 OLCTriangle::OLCTriangle(const Trace &_trace,
                          const bool _is_fai, bool _predict,
                          const unsigned _finish_alt_diff)
@@ -66,7 +72,9 @@ OLCTriangle::OLCTriangle(const Trace &_trace,
    is_closed(false),
    is_complete(false),
    max_iterations(1e6),
-   max_tree_size(5e5)
+   max_tree_size(5e5),
+   max_threads(1),
+   n_iterations(0), peak_tree_size(0)
 {
 }
 
@@ -83,6 +91,9 @@ OLCTriangle::Reset()
 
   closing_pairs.Clear();
   ClearTrace();
+  range_bounds.Clear();
+  n_iterations = 0;
+  peak_tree_size = 0;
 
   ResetBranchAndBound();
   AbstractContest::Reset();
@@ -109,17 +120,41 @@ CalcLegDistance(const ContestTraceVector &solution, const unsigned index)
   return p_start.Distance(p_dest);
 }
 
+bool
+OLCTriangle::PatchTrace()
+{
+  Trace::Changes changes;
+  if (!UpdateTracePatch(changes))
+    return false;
+
+  for (const unsigned i : solution_index)
+    if (changes.new_index[i] == Trace::Changes::REMOVED)
+      return false;
+
+  for (unsigned &i : solution_index)
+    i = changes.new_index[i];
+
+  return true;
+}
+
 void
 OLCTriangle::UpdateTrace(bool force)
 {
   if (IsMasterAppended()) return; /* unmodified */
 
   if (force || IsMasterUpdated(false)) {
-    UpdateTraceFull();
+    /* keep the solution if possible; the prediction moves the
+       finish point, so it cannot be kept in predictive mode */
+    if (best_d > 0 && !predict) {
+      if (!PatchTrace())
+        best_d = 0;
+    } else {
+      UpdateTraceFull();
+      best_d = 0;
+    }
 
     is_complete = false;
-
-    best_d = 0;
+    range_bounds.Build(trace, n_points);
 
     closing_pairs.Clear();
     is_closed = FindClosingPairs(0);
@@ -128,6 +163,7 @@ OLCTriangle::UpdateTrace(bool force)
     const unsigned old_size = n_points;
     if (UpdateTraceTail()) {
       is_complete = false;
+      range_bounds.Build(trace, n_points);
       is_closed = FindClosingPairs(old_size);
     }
   }
@@ -218,11 +254,26 @@ OLCTriangle::SolveTriangle(bool exhaustive)
 
     ClosingPairs close_look;
 
+    /* in parallel mode, all pairs are solved at once; the results
+       are then evaluated in the same order as in sequential mode */
+    const bool parallel = max_threads > 1;
+    std::vector<Triangle> parallel_results;
+    if (parallel) {
+      ResetBranchAndBound();
+      parallel_results =
+        RunParallelBranchAndBound({relaxed_pairs.closing_pairs.begin(),
+                                   relaxed_pairs.closing_pairs.end()},
+                                  best_d);
+    }
+
+    unsigned pair_index = 0;
     for (const auto relaxed_pair : relaxed_pairs.closing_pairs) {
 
       std::tuple<unsigned, unsigned, unsigned, unsigned> triangle;
 
-      triangle = RunBranchAndBound(relaxed_pair.first, relaxed_pair.second, best_d, exhaustive);
+      triangle = parallel
+        ? parallel_results[pair_index++]
+        : RunBranchAndBound(relaxed_pair.first, relaxed_pair.second, best_d, exhaustive);
 
       if (std::get<3>(triangle) > best_d) {
         // solution is better than best_d
@@ -250,12 +301,21 @@ OLCTriangle::SolveTriangle(bool exhaustive)
       }
     }
 
+    if (parallel)
+      parallel_results =
+        RunParallelBranchAndBound({close_look.closing_pairs.begin(),
+                                   close_look.closing_pairs.end()},
+                                  best_d);
+
+    pair_index = 0;
     for (const auto &close_look_pair : close_look.closing_pairs) {
       std::tuple<unsigned, unsigned, unsigned, unsigned> triangle;
 
-      triangle = RunBranchAndBound(close_look_pair.first,
-                                   close_look_pair.second,
-                                   best_d, exhaustive);
+      triangle = parallel
+        ? parallel_results[pair_index++]
+        : RunBranchAndBound(close_look_pair.first,
+                            close_look_pair.second,
+                            best_d, exhaustive);
 
       if (std::get<3>(triangle) > best_d) {
         // solution is better than best_d
@@ -294,20 +354,84 @@ OLCTriangle::SolveTriangle(bool exhaustive)
   }
 
   if (best_d > 0) {
-    solution.resize(5);
-
-    solution[0] = TraceManager::GetPoint(start);
-    solution[1] = TraceManager::GetPoint(tp1);
-    solution[2] = TraceManager::GetPoint(tp2);
-    solution[3] = TraceManager::GetPoint(tp3);
-    solution[4] = TraceManager::GetPoint(finish);
+    if (finish > 0) {
+      /* a better triangle was found; otherwise, the previous
+         solution (see PatchTrace()) is still the best one */
+      solution_index[0] = start;
+      solution_index[1] = tp1;
+      solution_index[2] = tp2;
+      solution_index[3] = tp3;
+      solution_index[4] = finish;
+
+      solution.resize(5);
+      for (unsigned i = 0; i < 5; ++i)
+        solution[i] = TraceManager::GetPoint(solution_index[i]);
+    }
 
     is_complete = true;
   }
 }
 
 
-std::tuple<unsigned, unsigned, unsigned, unsigned>
+/**
+ * Raise the shared value (e.g. the bound) to the given value, unless
+ * another worker has already stored something larger.
+ */
+static void
+AtomicMaximum(std::atomic<unsigned> &shared, unsigned value)
+{
+  unsigned current = shared.load(std::memory_order_relaxed);
+  while (current < value &&
+         !shared.compare_exchange_weak(current, value,
+                                       std::memory_order_relaxed))
+    ;
+}
+
+static OLCTriangle::Triangle
+SortTriangle(const OLCTriangle::Triangle &triangle)
+{
+  unsigned tp1 = std::get<0>(triangle),
+           tp2 = std::get<1>(triangle),
+           tp3 = std::get<2>(triangle);
+
+  if (tp1 > tp2) std::swap(tp1, tp2);
+  if (tp2 > tp3) std::swap(tp2, tp3);
+  if (tp1 > tp2) std::swap(tp1, tp2);
+
+  return OLCTriangle::Triangle(tp1, tp2, tp3, std::get<3>(triangle));
+}
+
+unsigned
+OLCTriangle::GetLargeTriangleCheck(unsigned from) const
+{
+  // note: this is _not_ the breakepoint between small and large triangles,
+  // but a slightly lower value used for relaxed large triangle checking.
+  return trace_master.ProjectRange(GetPoint(from).GetLocation(),
+                                   fixed(500000)) * 0.99;
+}
+
+bool
+OLCTriangle::IsBetterTie(const Triangle &a, const Triangle &b) const
+{
+  const auto distance = [this](const Triangle &t){
+    const GeoPoint p1 = GetPoint(std::get<0>(t)).GetLocation();
+    const GeoPoint p2 = GetPoint(std::get<1>(t)).GetLocation();
+    const GeoPoint p3 = GetPoint(std::get<2>(t)).GetLocation();
+    return p1.Distance(p2) + p2.Distance(p3) + p3.Distance(p1);
+  };
+
+  const fixed distance_a = distance(a), distance_b = distance(b);
+  if (distance_a != distance_b)
+    return distance_a > distance_b;
+
+  const Triangle sorted_a = SortTriangle(a), sorted_b = SortTriangle(b);
+  return std::tie(std::get<0>(sorted_a), std::get<1>(sorted_a),
+                  std::get<2>(sorted_a)) <
+    std::tie(std::get<0>(sorted_b), std::get<1>(sorted_b),
+             std::get<2>(sorted_b));
+}
+
+OLCTriangle::Triangle
 OLCTriangle::RunBranchAndBound(unsigned from, unsigned to, unsigned worst_d, bool exhaustive)
 {
   /* Some general information about the branch and bound method can be found here:
@@ -324,19 +448,9 @@ OLCTriangle::RunBranchAndBound(unsigned from, unsigned to, unsigned worst_d, boo
     trace_master.ProjectRange(GetPoint(from).GetLocation(), fixed(fastskiprange));
 
   if (fastskiprange_flat < worst_d)
-    return std::tuple<unsigned, unsigned, unsigned, unsigned>(0, 0, 0, 0);
-
-  bool integral_feasible = false;
-  unsigned best_d = 0,
-           tp1 = 0,
-           tp2 = 0,
-           tp3 = 0;
-  unsigned iterations = 0;
+    return Triangle(0, 0, 0, 0);
 
-  // note: this is _not_ the breakepoint between small and large triangles,
-  // but a slightly lower value used for relaxed large triangle checking.
-  const unsigned large_triangle_check =
-    trace_master.ProjectRange(GetPoint(from).GetLocation(), fixed(500000)) * 0.99;
+  const unsigned large_triangle_check = GetLargeTriangleCheck(from);
 
   if (!running) {
     // initiate algorithm. otherwise continue unfinished run
@@ -354,7 +468,32 @@ OLCTriangle::RunBranchAndBound(unsigned from, unsigned to, unsigned worst_d, boo
   if (!exhaustive && predict)
     max_iterations = tick_iterations;
 
-  while (!branch_and_bound.empty()) {
+  const Triangle triangle =
+    SolveCandidateTree(branch_and_bound, worst_d, large_triangle_check,
+                       max_tree_size, nullptr, false);
+
+  if (branch_and_bound.empty())
+    running = false;
+
+  return SortTriangle(triangle);
+}
+
+OLCTriangle::Triangle
+OLCTriangle::SolveCandidateTree(CandidateTree &tree, unsigned worst_d,
+                                unsigned large_triangle_check,
+                                unsigned tree_size_limit,
+                                std::atomic<unsigned> *shared_bound,
+                                bool best_first)
+{
+  unsigned best_d = 0,
+           best_d_min = 0,
+           tp1 = 0,
+           tp2 = 0,
+           tp3 = 0;
+  unsigned iterations = 0;
+  size_t max_size = tree.size();
+
+  while (!tree.empty()) {
     /* now loop over the tree, branching each found candidate set, adding the branch if it's feasible.
      * remove all candidate sets with d_max smaller than d_min of the largest integral candidate set
      * always work on the node with largest d_min
@@ -363,14 +502,19 @@ OLCTriangle::RunBranchAndBound(unsigned from, unsigned to, unsigned worst_d, boo
     iterations++;
 
     // break loop if max_iterations or max_tree_size exceeded
-    if (iterations > max_iterations || branch_and_bound.size() > max_tree_size)
+    if (iterations > max_iterations || tree.size() > tree_size_limit)
       break;
 
+    // prune with the best distance found by the other workers
+    if (shared_bound != nullptr)
+      worst_d = std::max(worst_d,
+                         shared_bound->load(std::memory_order_relaxed));
+
     // first clean up tree, removeing all nodes with d_max < worst_d
-    branch_and_bound.erase(branch_and_bound.begin(), branch_and_bound.lower_bound(worst_d));
+    tree.erase(tree.begin(), tree.lower_bound(worst_d));
 
     // we might have cleaned up the whole tree. nothing to do then...
-    if (branch_and_bound.empty())
+    if (tree.empty())
       break;
 
     /* get node to work on.
@@ -378,114 +522,228 @@ OLCTriangle::RunBranchAndBound(unsigned from, unsigned to, unsigned worst_d, boo
      * this is a mixed depht-first/breadth-first approach, the latter
      * beeing faster, but the first a lot more memory efficient.
      */
-    std::multimap<unsigned, CandidateSet>::iterator node;
+    CandidateTree::iterator node;
 
-    if (branch_and_bound.size() > n_points * 4 && iterations % 16 != 0) {
-      node = branch_and_bound.upper_bound(branch_and_bound.rbegin()->first / 2);
-      if (node == branch_and_bound.end()) --node;
+    if (!best_first && tree.size() > n_points * 4 && iterations % 16 != 0) {
+      node = tree.upper_bound(tree.rbegin()->first / 2);
+      if (node == tree.end()) --node;
     } else {
-      node = --branch_and_bound.end();
+      node = --tree.end();
     }
 
     if (node->second.df_min >= worst_d &&
         node->second.IsIntegral(this, is_fai, large_triangle_check)) {
       // node is integral feasible -> a possible solution
 
-      worst_d = node->second.df_min;
+      const Triangle candidate(node->second.tp1.index_min,
+                               node->second.tp2.index_min,
+                               node->second.tp3.index_min,
+                               node->first);
 
-      tp1 = node->second.tp1.index_min;
-      tp2 = node->second.tp2.index_min;
-      tp3 = node->second.tp3.index_min;
-      best_d = node->first;
+      if (best_d == 0 || node->second.df_min > best_d_min ||
+          IsBetterTie(candidate, Triangle(tp1, tp2, tp3, best_d))) {
+        worst_d = best_d_min = node->second.df_min;
 
-      integral_feasible = true;
+        std::tie(tp1, tp2, tp3, best_d) = candidate;
+
+        if (shared_bound != nullptr)
+          AtomicMaximum(*shared_bound, worst_d);
+      }
 
     } else {
       // split largest bounding box of node and create child nodes
+      CandidateSet left, right;
+      if (SplitCandidateSet(node->second, left, right)) {
+        // add the new candidate set only if it it's feasible and has d_min >= worst_d
+        if (left.df_max >= worst_d &&
+            left.IsFeasible(is_fai, large_triangle_check)) {
+          tree.insert(std::pair<unsigned, CandidateSet>(left.df_max, left));
+        }
 
-      const unsigned tp1_diag = node->second.tp1.GetDiagnoal();
-      const unsigned tp2_diag = node->second.tp2.GetDiagnoal();
-      const unsigned tp3_diag = node->second.tp3.GetDiagnoal();
+        if (right.df_max >= worst_d &&
+            right.IsFeasible(is_fai, large_triangle_check)) {
+          tree.insert(std::pair<unsigned, CandidateSet>(right.df_max, right));
+        }
 
-      const unsigned max_diag = std::max({tp1_diag, tp2_diag, tp3_diag});
+        max_size = std::max(max_size, tree.size());
+      }
+    }
 
-      CandidateSet left, right;
-      bool add = false;
+    // remove current node
+    tree.erase(node);
+  }
+
+  n_iterations.fetch_add(iterations, std::memory_order_relaxed);
+  AtomicMaximum(peak_tree_size, max_size);
+
+  return Triangle(tp1, tp2, tp3, best_d);
+}
 
-      if (tp1_diag == max_diag && node->second.tp1.GetSize() != 1) {
-        // split tp1 range
-        const unsigned split = (node->second.tp1.index_min + node->second.tp1.index_max) / 2;
+bool
+OLCTriangle::SplitCandidateSet(const CandidateSet &node,
+                               CandidateSet &left, CandidateSet &right)
+{
+  const unsigned tp1_diag = node.tp1.GetDiagnoal();
+  const unsigned tp2_diag = node.tp2.GetDiagnoal();
+  const unsigned tp3_diag = node.tp3.GetDiagnoal();
 
-        if (split <= node->second.tp2.index_max) {
-          add = true;
+  const unsigned max_diag = std::max({tp1_diag, tp2_diag, tp3_diag});
 
-          left = CandidateSet(TurnPointRange(this, node->second.tp1.index_min, split),
-                              node->second.tp2, node->second.tp3);
+  if (tp1_diag == max_diag && node.tp1.GetSize() != 1) {
+    // split tp1 range
+    const unsigned split = (node.tp1.index_min + node.tp1.index_max) / 2;
 
-          right = CandidateSet(TurnPointRange(this, split, node->second.tp1.index_max),
-                               node->second.tp2, node->second.tp3);
-        }
-      } else if (tp2_diag == max_diag && node->second.tp2.GetSize() != 1) {
-        // split tp2 range
-        const unsigned split = (node->second.tp2.index_min + node->second.tp2.index_max) / 2;
+    if (split > node.tp2.index_max)
+      return false;
 
-        if (split <= node->second.tp3.index_max && split >= node->second.tp1.index_min) {
-          add = true;
+    left = CandidateSet(TurnPointRange(this, node.tp1.index_min, split),
+                        node.tp2, node.tp3);
 
-          left = CandidateSet(node->second.tp1,
-                              TurnPointRange(this, node->second.tp2.index_min, split),
-                              node->second.tp3);
+    right = CandidateSet(TurnPointRange(this, split, node.tp1.index_max),
+                         node.tp2, node.tp3);
+    return true;
+  } else if (tp2_diag == max_diag && node.tp2.GetSize() != 1) {
+    // split tp2 range
+    const unsigned split = (node.tp2.index_min + node.tp2.index_max) / 2;
 
-          right = CandidateSet(node->second.tp1,
-                               TurnPointRange(this, split, node->second.tp2.index_max),
-                               node->second.tp3);
-        }
-      } else if (node->second.tp3.GetSize() != 1) {
-        // split tp3 range
-        const unsigned split = (node->second.tp3.index_min + node->second.tp3.index_max) / 2;
+    if (split > node.tp3.index_max || split < node.tp1.index_min)
+      return false;
 
-        if (split >= node->second.tp2.index_min) {
-          add = true;
+    left = CandidateSet(node.tp1,
+                        TurnPointRange(this, node.tp2.index_min, split),
+                        node.tp3);
 
-          left = CandidateSet(node->second.tp1, node->second.tp2,
-                              TurnPointRange(this, node->second.tp3.index_min, split));
+    right = CandidateSet(node.tp1,
+                         TurnPointRange(this, split, node.tp2.index_max),
+                         node.tp3);
+    return true;
+  } else if (node.tp3.GetSize() != 1) {
+    // split tp3 range
+    const unsigned split = (node.tp3.index_min + node.tp3.index_max) / 2;
+
+    if (split < node.tp2.index_min)
+      return false;
+
+    left = CandidateSet(node.tp1, node.tp2,
+                        TurnPointRange(this, node.tp3.index_min, split));
+
+    right = CandidateSet(node.tp1, node.tp2,
+                         TurnPointRange(this, split, node.tp3.index_max));
+    return true;
+  }
+
+  return false;
+}
 
-          right = CandidateSet(node->second.tp1, node->second.tp2,
-                               TurnPointRange(this, split, node->second.tp3.index_max));
+std::vector<OLCTriangle::Triangle>
+OLCTriangle::RunParallelBranchAndBound(const std::vector<ClosingPair> &pairs,
+                                       unsigned worst_d)
+{
+  struct Seed {
+    unsigned pair;
+    unsigned large_triangle_check;
+    CandidateSet candidates;
+  };
+
+  /* split each pair's root candidate set a few times, so there is
+     enough work for all threads even if there is only one pair; the
+     number of seeds does not depend on #max_threads, so ties are
+     resolved the same way for any number of threads */
+  const unsigned seeds_per_pair =
+    std::max(PARALLEL_SEEDS / std::max(unsigned(pairs.size()), 1u), 1u);
+
+  std::vector<Seed> seeds;
+  for (unsigned i = 0; i < pairs.size(); ++i) {
+    const unsigned from = pairs[i].first, to = pairs[i].second;
+
+    // Assume a maximum speed of 100 m/s, see RunBranchAndBound()
+    const unsigned fastskiprange = GetPoint(to).DeltaTime(GetPoint(from)) * 100;
+    if (trace_master.ProjectRange(GetPoint(from).GetLocation(),
+                                  fixed(fastskiprange)) < worst_d)
+      continue;
+
+    const unsigned large_triangle_check = GetLargeTriangleCheck(from);
+
+    std::vector<CandidateSet> frontier;
+    const CandidateSet root(this, from, to + 1);
+    if (root.IsFeasible(is_fai, large_triangle_check) &&
+        root.df_max >= worst_d)
+      frontier.push_back(root);
+
+    /* breadth-first expansion; the order of the seeds is
+       deterministic */
+    bool expanded = true;
+    while (expanded && !frontier.empty() &&
+           frontier.size() < seeds_per_pair) {
+      expanded = false;
+
+      std::vector<CandidateSet> next;
+      for (const auto &c : frontier) {
+        CandidateSet left, right;
+        if (c.IsIntegral(this, is_fai, large_triangle_check) ||
+            !SplitCandidateSet(c, left, right)) {
+          next.push_back(c);
+          continue;
         }
-      }
 
-      if (add) {
-        // add the new candidate set only if it it's feasible and has d_min >= worst_d
+        expanded = true;
+
         if (left.df_max >= worst_d &&
-            left.IsFeasible(is_fai, large_triangle_check)) {
-          branch_and_bound.insert(std::pair<unsigned, CandidateSet>(left.df_max, left));
-        }
+            left.IsFeasible(is_fai, large_triangle_check))
+          next.push_back(left);
 
         if (right.df_max >= worst_d &&
-            right.IsFeasible(is_fai, large_triangle_check)) {
-          branch_and_bound.insert(std::pair<unsigned, CandidateSet>(right.df_max, right));
-        }
+            right.IsFeasible(is_fai, large_triangle_check))
+          next.push_back(right);
       }
+
+      frontier.swap(next);
     }
 
-    // remove current node
-    branch_and_bound.erase(node);
+    for (const auto &c : frontier)
+      seeds.push_back({i, large_triangle_check, c});
   }
 
+  /* one bound per pair: SolveTriangle() may reject the best
+     triangle of a relaxed pair, so it must not prune the search in
+     other pairs */
+  std::vector<std::atomic<unsigned>> bounds(pairs.size());
+  for (auto &i : bounds)
+    i.store(worst_d, std::memory_order_relaxed);
+
+  /* the tree size limit applies to all concurrent workers together */
+  const unsigned n_workers =
+    std::max(std::min(max_threads, unsigned(seeds.size())), 1u);
+  const unsigned tree_size_limit = std::max(max_tree_size / n_workers, 1u);
+
+  std::vector<Triangle> seed_results(seeds.size(), Triangle(0, 0, 0, 0));
+
+  ParallelFor(seeds.size(), max_threads, [&](unsigned i){
+      CandidateTree tree;
+      tree.insert(std::make_pair(seeds[i].candidates.df_max,
+                                 seeds[i].candidates));
+      seed_results[i] = SolveCandidateTree(tree, worst_d,
+                                           seeds[i].large_triangle_check,
+                                           tree_size_limit,
+                                           &bounds[seeds[i].pair], true);
+    });
+
+  /* merge in pair and seed order, like the sequential loop; ties
+     are resolved like in SolveCandidateTree() */
+  std::vector<Triangle> results(pairs.size(), Triangle(0, 0, 0, 0));
+  for (unsigned i = 0; i < seeds.size(); ++i) {
+    Triangle &result = results[seeds[i].pair];
+    const unsigned d = std::get<3>(seed_results[i]);
+    if (d > std::get<3>(result) ||
+        (d > 0 && d == std::get<3>(result) &&
+         IsBetterTie(seed_results[i], result)))
+      result = seed_results[i];
+  }
 
-  if (branch_and_bound.empty())
-    running = false;
-
-  if (integral_feasible) {
-    if (tp1 > tp2) std::swap(tp1, tp2);
-    if (tp2 > tp3) std::swap(tp2, tp3);
-    if (tp1 > tp2) std::swap(tp1, tp2);
+  for (auto &i : results)
+    i = SortTriangle(i);
 
-    return std::tuple<unsigned, unsigned, unsigned, unsigned>(tp1, tp2, tp3, best_d);
-  } else {
-    return std::tuple<unsigned, unsigned, unsigned, unsigned>(0, 0, 0, 0);
-  }
+  return results;
 }
 
 ContestResult
@@ -499,6 +757,7 @@ OLCTriangle::CalculateResult() const
     ? CalcLegDistance(solution, 0) + CalcLegDistance(solution, 1) + CalcLegDistance(solution, 2)
     : fixed(0);
   result.score = ApplyHandicap(result.distance * fixed(0.001));
+  result.optimal = false;
   return result;
 }
 
@@ -521,76 +780,57 @@ OLCTriangle::FindClosingPairs(unsigned old_size)
     return closing_pairs.Insert(ClosingPair(0, n_points-1));
   }
 
-  struct TracePointNode {
-    const TracePoint *point;
-    unsigned index;
-  };
-
-  struct TracePointNodeAccessor {
-    gcc_pure
-    int GetX(const TracePointNode &node) const {
-      return node.point->GetFlatLocation().longitude;
-    }
+  if (n_points == 0)
+    return false;
 
-    gcc_pure
-    int GetY(const TracePointNode &node) const {
-      return node.point->GetFlatLocation().latitude;
-    }
-  };
-
-  QuadTree<TracePointNode, TracePointNodeAccessor> search_point_tree;
-
-  for (unsigned i = old_size; i < n_points; ++i) {
-    TracePointNode node;
-    node.point = &GetPoint(i);
-    node.index = i;
-
-    search_point_tree.insert(node);
-  }
-
-  search_point_tree.Optimise();
+  /* the search range varies only slightly with the latitude; use
+     the one of the first point as the grid's cell size */
+  TracePointGrid grid;
+  grid.Build(trace, n_points,
+             trace_master.ProjectRange(GetPoint(0).GetLocation(),
+                                       max_distance));
 
   bool new_pair = false;
 
-  for (unsigned i = old_size; i < n_points; ++i) {
-    TracePointNode point;
-    point.point = &GetPoint(i);
-    point.index = i;
-
-    const SearchPoint start = *point.point;
+  /* every closing pair is contained in the one formed by its finish
+     point and the earliest start point near it, so it's enough to
+     look up the earliest start point of each new finish point; the
+     start point may be an old one */
+  for (unsigned i = std::max(old_size, 3u); i < n_points; ++i) {
+    const TracePoint &point = GetPoint(i);
+    const SearchPoint start = point;
     const unsigned max_range = trace_master.ProjectRange(start.GetLocation(), max_distance);
     const unsigned half_max_range_sq = max_range * max_range / 2;
+    const unsigned max_range_sq = max_range * max_range;
 
-    const int min_altitude = GetMinimumFinishAltitude(*point.point);
-    const int max_altitude = GetMaximumStartAltitude(*point.point);
+    const int max_altitude = GetMaximumStartAltitude(point);
 
-    unsigned last = 0, first = i;
+    unsigned first = i;
 
     const auto visitor = [this, i, start,
-                          half_max_range_sq,
-                          min_altitude, max_altitude,
-                          &first, &last]
-      (const TracePointNode &node) {
-      const auto &dest = *node.point;
-
-      if (node.index + 2 < i &&
-          dest.GetIntegerAltitude() <= max_altitude &&
-          IsInRange(start, dest, half_max_range_sq, max_distance)) {
-        // point i is last point
-        first = std::min(node.index, first);
-        last = i;
-      } else if (node.index > i + 2 &&
-                 dest.GetIntegerAltitude() >= min_altitude &&
-                 IsInRange(start, dest, half_max_range_sq, max_distance)) {
-        // point i is first point
-        first = i;
-        last = std::max(node.index, last);
+                          half_max_range_sq, max_range_sq,
+                          max_altitude, &first]
+      (const unsigned *begin, const unsigned *end) {
+      /* the indices are ascending; stop at the first match, and
+         don't bother with this cell if it cannot improve the
+         result */
+      for (const unsigned *j = begin; j != end && *j + 2 < i &&
+             *j < first; ++j) {
+        const auto &dest = GetPoint(*j);
+
+        if (dest.GetIntegerAltitude() <= max_altitude &&
+            dest.GetFlatLocation().DistanceSquared(start.GetFlatLocation()) <= max_range_sq &&
+            IsInRange(start, dest, half_max_range_sq, max_distance)) {
+          first = *j;
+          break;
+        }
       }
     };
 
-    search_point_tree.VisitWithinRange(point, max_range, visitor);
+    grid.VisitCells(FlatBoundingBox(start.GetFlatLocation(), max_range),
+                    visitor);
 
-    if (last != 0 && closing_pairs.Insert(ClosingPair(first, last)))
+    if (first < i && closing_pairs.Insert(ClosingPair(first, i)))
       new_pair = true;
   }
 
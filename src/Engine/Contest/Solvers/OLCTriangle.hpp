@@ -25,9 +25,13 @@
 
 #include "AbstractContest.hpp"
 #include "TraceManager.hpp"
+#include "TraceIndex.hpp"
 #include "Trace/Point.hpp"
 
 #include <map>
+#include <vector>
+#include <atomic>
+#include <tuple>
 #include <cstdlib>
 
 /**
@@ -45,6 +49,12 @@ protected:
   /* Contains the best flat distance found so far */
   unsigned best_d;
 
+  /**
+   * The trace indexes of #solution (start, three turn points,
+   * finish).  Only valid if #best_d is non-zero.
+   */
+  unsigned solution_index[5];
+
 private:
   /**
    * Assume the the pilot will reach the start point?  This is useful
@@ -91,6 +101,12 @@ private:
   unsigned max_iterations,
            max_tree_size;
 
+  /**
+   * The maximum number of threads used by the exhaustive search.  1
+   * disables the parallel mode.
+   */
+  unsigned max_threads;
+
   typedef std::pair<unsigned, unsigned> ClosingPair;
 
   struct ClosingPairs {
@@ -140,6 +156,12 @@ private:
 
   ClosingPairs closing_pairs;
 
+  /**
+   * Bounding boxes of index ranges of the current trace copy, used
+   * to build the #TurnPointRange objects.
+   */
+  TraceRangeBounds range_bounds;
+
   /**
    * A bounding box around a range of trace points.
    */
@@ -153,7 +175,7 @@ private:
       lon_min(0), lon_max(0),
       lat_min(0), lat_max(0) {}
 
-    TurnPointRange(OLCTriangle *parent, unsigned min, unsigned max) {
+    TurnPointRange(const OLCTriangle *parent, unsigned min, unsigned max) {
       Update(parent, min, max);
     }
 
@@ -184,18 +206,13 @@ private:
     }
 
     // updates the bounding box by a given point range
-    void Update(OLCTriangle *parent, unsigned &_min, unsigned &_max) {
-      lon_min = parent->GetPoint(_min).GetFlatLocation().longitude;
-      lon_max = parent->GetPoint(_min).GetFlatLocation().longitude;
-      lat_min = parent->GetPoint(_min).GetFlatLocation().latitude;
-      lat_max = parent->GetPoint(_min).GetFlatLocation().latitude;
-
-      for (unsigned i = _min + 1; i < _max; ++i) {
-        lon_min = std::min(lon_min, parent->GetPoint(i).GetFlatLocation().longitude);
-        lon_max = std::max(lon_max, parent->GetPoint(i).GetFlatLocation().longitude);
-        lat_min = std::min(lat_min, parent->GetPoint(i).GetFlatLocation().latitude);
-        lat_max = std::max(lat_max, parent->GetPoint(i).GetFlatLocation().latitude);
-      }
+    void Update(const OLCTriangle *parent, unsigned _min, unsigned _max) {
+      const FlatBoundingBox bounds = parent->range_bounds.Get(_min, _max);
+
+      lon_min = bounds.GetLowerLeft().longitude;
+      lon_max = bounds.GetUpperRight().longitude;
+      lat_min = bounds.GetLowerLeft().latitude;
+      lat_max = bounds.GetUpperRight().latitude;
 
       index_min = _min;
       index_max = _max;
@@ -360,9 +377,24 @@ private:
     }
   };
 
-  std::multimap<unsigned, CandidateSet> branch_and_bound;
+  typedef std::multimap<unsigned, CandidateSet> CandidateTree;
+
+  CandidateTree branch_and_bound;
+
+  /**
+   * Statistics for GetIterations() and GetMemoryUsage(), updated by
+   * all workers of SolveCandidateTree() since the last Reset().
+   */
+  std::atomic<unsigned> n_iterations, peak_tree_size;
 
 public:
+  /**
+   * A triangle found by the branch and bound search: the three turn
+   * point indices and the (flat) distance.  All zero if nothing was
+   * found.
+   */
+  typedef std::tuple<unsigned, unsigned, unsigned, unsigned> Triangle;
+
   OLCTriangle(const Trace &_trace,
               bool is_fai,
               bool predict,
@@ -376,8 +408,80 @@ protected:
   bool FindClosingPairs(unsigned old_size);
   void SolveTriangle(bool exhaustive);
 
-  std::tuple<unsigned, unsigned, unsigned, unsigned>
-  RunBranchAndBound(unsigned from, unsigned to, unsigned best_d, bool exhaustive);
+  Triangle RunBranchAndBound(unsigned from, unsigned to, unsigned best_d,
+                             bool exhaustive);
+
+  /**
+   * Run the branch and bound search for each of the given closing
+   * pairs, distributing the candidate sets over up to #max_threads
+   * threads.  The workers of one pair share the best distance found
+   * in that pair, so each of them can prune its own tree.
+   *
+   * Each result is the best triangle of its pair which is not
+   * shorter than @p worst_d, just like RunBranchAndBound() returns it
+   * for the sequential search.  It does not depend on thread
+   * scheduling or on the number of threads, unless a worker hits
+   * #max_iterations or its share of #max_tree_size.
+   *
+   * @return one (sorted) triangle per pair
+   */
+  std::vector<Triangle>
+  RunParallelBranchAndBound(const std::vector<ClosingPair> &pairs,
+                            unsigned worst_d);
+
+  /**
+   * Explore the given tree until it is empty or a limit is reached.
+   *
+   * @param tree_size_limit stop when the tree grows larger than this
+   * @param shared_bound the best distance found by all workers of
+   * this closing pair; may be nullptr in sequential mode
+   * @param best_first always work on the node with the largest d_max
+   * instead of the memory saving mixed strategy; used in parallel
+   * mode, where it makes the result independent of #shared_bound
+   * timing
+   * @return the best triangle (unsorted) or all zero
+   */
+  Triangle SolveCandidateTree(CandidateTree &tree, unsigned worst_d,
+                              unsigned large_triangle_check,
+                              unsigned tree_size_limit,
+                              std::atomic<unsigned> *shared_bound,
+                              bool best_first);
+
+  /**
+   * Split the largest turn point range of the given candidate set.
+   *
+   * @return false if the candidate set cannot be split
+   */
+  bool SplitCandidateSet(const CandidateSet &node,
+                         CandidateSet &left, CandidateSet &right);
+
+  /**
+   * Returns the threshold for the relaxed large triangle check for
+   * triangles starting at the given point.
+   */
+  gcc_pure
+  unsigned GetLargeTriangleCheck(unsigned from) const;
+
+  /**
+   * Decide between two triangles with the same flat distance: prefer
+   * the one which is longer on the earth's surface, then the one
+   * with the lower turn point indices.  This makes the result
+   * independent of the order in which the search visits them, and
+   * thus of the number of threads.
+   *
+   * @return true if the first one is better
+   */
+  gcc_pure
+  bool IsBetterTie(const Triangle &a, const Triangle &b) const;
+
+  /**
+   * Obtain a new trace copy, and keep the current solution if all of
+   * its points have survived.  Its distance is then a good bound for
+   * the new search.
+   *
+   * @return true if the solution was kept
+   */
+  bool PatchTrace();
 
   void UpdateTrace(bool force) override;
   void ResetBranchAndBound();
@@ -391,10 +495,40 @@ public:
     max_tree_size = _max_tree_size;
   };
 
+  /**
+   * Allow the exhaustive search to use up to the given number of
+   * threads.  The threads share the tree size limit (see
+   * SetMaxTreeSize()), so the peak memory usage does not grow with
+   * the number of threads.
+   */
+  void SetMaxThreads(unsigned _max_threads) {
+    max_threads = _max_threads;
+  }
+
   /* virtual methods from AbstractContest */
   void Reset() override;
   SolverResult Solve(bool exhaustive) override;
 
+  /**
+   * Approximated by the largest candidate tree seen so far, not
+   * counting the container overhead.
+   */
+  gcc_pure
+  size_t GetMemoryUsage() const override {
+    return range_bounds.GetMemoryUsage() +
+      peak_tree_size.load(std::memory_order_relaxed) *
+      sizeof(CandidateTree::value_type);
+  }
+
+  /**
+   * Returns the number of candidate sets taken from the tree by
+   * SolveCandidateTree().
+   */
+  gcc_pure
+  unsigned GetIterations() const override {
+    return n_iterations.load(std::memory_order_relaxed);
+  }
+
 protected:
   /* virtual methods from AbstractContest */
   bool UpdateScore() override;
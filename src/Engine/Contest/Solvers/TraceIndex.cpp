@@ -0,0 +1,108 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "TraceIndex.hpp"
+#include "Trace/Point.hpp"
+#include "Trace/Vector.hpp"
+
+#include <stdint.h>
+
+void
+TraceRangeBounds::Build(const TracePointerVector &trace, unsigned n)
+{
+  assert(n <= trace.size());
+
+  n_points = n;
+  if (n == 0) {
+    table.clear();
+    return;
+  }
+
+  const unsigned n_levels = Log2(n) + 1;
+  table.resize(n_levels * n);
+
+  for (unsigned i = 0; i < n; ++i)
+    table[i] = FlatBoundingBox(trace[i]->GetFlatLocation());
+
+  for (unsigned level = 1; level < n_levels; ++level) {
+    const FlatBoundingBox *src = table.data() + (level - 1) * n;
+    FlatBoundingBox *dest = table.data() + level * n;
+    const unsigned half = 1u << (level - 1);
+
+    for (unsigned i = 0, end = n - (1u << level); i <= end; ++i) {
+      dest[i] = src[i];
+      dest[i].Merge(src[i + half]);
+    }
+  }
+}
+
+void
+TracePointGrid::Build(const TracePointerVector &trace, unsigned n,
+                      unsigned min_cell_size)
+{
+  assert(n <= trace.size());
+
+  indices.resize(n);
+  if (n == 0) {
+    width = height = 0;
+    cell_start.clear();
+    return;
+  }
+
+  FlatBoundingBox bounds(trace[0]->GetFlatLocation());
+  for (unsigned i = 1; i < n; ++i)
+    bounds.Expand(trace[i]->GetFlatLocation());
+
+  origin = bounds.GetLowerLeft();
+  const unsigned span_x = bounds.GetUpperRight().longitude - origin.longitude;
+  const unsigned span_y = bounds.GetUpperRight().latitude - origin.latitude;
+
+  /* limit the number of cells to a few per point, so sparse traces
+     don't waste memory on empty cells */
+  const uint64_t max_cells = uint64_t(n) * 4 + 16;
+  cell_size = std::max(min_cell_size, 1u);
+  while (uint64_t(span_x / cell_size + 1) * (span_y / cell_size + 1) > max_cells)
+    cell_size *= 2;
+
+  width = span_x / cell_size + 1;
+  height = span_y / cell_size + 1;
+
+  /* counting sort by cell; this keeps the indices of each cell in
+     ascending order */
+  cell_start.assign(width * height + 1, 0);
+
+  for (unsigned i = 0; i < n; ++i) {
+    const FlatGeoPoint &p = trace[i]->GetFlatLocation();
+    ++cell_start[GetCell(p.latitude - origin.latitude) * width +
+                 GetCell(p.longitude - origin.longitude) + 1];
+  }
+
+  for (unsigned i = 1, end = cell_start.size(); i < end; ++i)
+    cell_start[i] += cell_start[i - 1];
+
+  std::vector<unsigned> position(cell_start.begin(), cell_start.end() - 1);
+  for (unsigned i = 0; i < n; ++i) {
+    const FlatGeoPoint &p = trace[i]->GetFlatLocation();
+    indices[position[GetCell(p.latitude - origin.latitude) * width +
+                     GetCell(p.longitude - origin.longitude)]++] = i;
+  }
+}
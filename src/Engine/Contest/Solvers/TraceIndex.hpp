@@ -0,0 +1,162 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_CONTEST_TRACE_INDEX_HPP
+#define XCSOAR_CONTEST_TRACE_INDEX_HPP
+
+#include "Geo/Flat/FlatBoundingBox.hpp"
+#include "Compiler.h"
+
+#include <vector>
+
+#include <assert.h>
+
+class TracePointerVector;
+
+/**
+ * A sparse table of bounding boxes over the flat locations of a
+ * trace snapshot.  Level k stores the bounding box of each block of
+ * 2^k consecutive points, so the bounding box of any index range is
+ * the union of two (overlapping) blocks and can be looked up in
+ * constant time.
+ */
+class TraceRangeBounds {
+  unsigned n_points;
+
+  /**
+   * Level k starts at k * #n_points; only its first
+   * (#n_points - 2^k + 1) elements are used.
+   */
+  std::vector<FlatBoundingBox> table;
+
+public:
+  TraceRangeBounds():n_points(0) {}
+
+  void Clear() {
+    n_points = 0;
+    table.clear();
+  }
+
+  /**
+   * Returns the number of bytes allocated by the table.
+   */
+  gcc_pure
+  size_t GetMemoryUsage() const {
+    return table.capacity() * sizeof(table.front());
+  }
+
+  /**
+   * Build the table over the first n points of the given trace.
+   */
+  void Build(const TracePointerVector &trace, unsigned n);
+
+  /**
+   * Returns the bounding box of the points [min, max).  The range
+   * must not be empty.
+   */
+  gcc_pure
+  FlatBoundingBox Get(unsigned min, unsigned max) const {
+    assert(min < max);
+    assert(max <= n_points);
+
+    const unsigned level = Log2(max - min);
+    const FlatBoundingBox *row = table.data() + level * n_points;
+
+    FlatBoundingBox result = row[min];
+    result.Merge(row[max - (1u << level)]);
+    return result;
+  }
+
+private:
+  static constexpr unsigned Log2(unsigned x) {
+    return 31 - __builtin_clz(x);
+  }
+};
+
+/**
+ * A uniform grid over the flat locations of a trace snapshot, used
+ * to find all points near a location without comparing against the
+ * whole trace.  The point indices of each cell are stored in
+ * ascending order.
+ */
+class TracePointGrid {
+  FlatGeoPoint origin;
+  unsigned cell_size;
+  unsigned width, height;
+
+  /**
+   * The position of each cell's first element in #indices, plus one
+   * terminating element.
+   */
+  std::vector<unsigned> cell_start;
+
+  std::vector<unsigned> indices;
+
+public:
+  TracePointGrid():cell_size(1), width(0), height(0) {}
+
+  /**
+   * Build the grid over the first n points of the given trace.
+   * Cells are at least min_cell_size wide; they are enlarged if the
+   * trace is so large that there would be many more cells than
+   * points.
+   */
+  void Build(const TracePointerVector &trace, unsigned n,
+             unsigned min_cell_size);
+
+  /**
+   * Invoke the visitor for each cell overlapping the given box, with
+   * the range of point indices [begin, end) stored in it.  The caller
+   * has to do the exact distance check.
+   */
+  template<typename V>
+  void VisitCells(const FlatBoundingBox &box, V &&visitor) const {
+    const FlatGeoPoint &ll = box.GetLowerLeft();
+    const FlatGeoPoint &ur = box.GetUpperRight();
+
+    if (width == 0 ||
+        ur.longitude < origin.longitude || ur.latitude < origin.latitude)
+      return;
+
+    const unsigned x_min = GetCell(ll.longitude - origin.longitude);
+    const unsigned y_min = GetCell(ll.latitude - origin.latitude);
+    const unsigned x_max = std::min(GetCell(ur.longitude - origin.longitude),
+                                    width - 1);
+    const unsigned y_max = std::min(GetCell(ur.latitude - origin.latitude),
+                                    height - 1);
+
+    for (unsigned y = y_min; y <= y_max; ++y) {
+      const unsigned *row = cell_start.data() + y * width;
+      for (unsigned x = x_min; x <= x_max; ++x)
+        if (row[x] != row[x + 1])
+          visitor(indices.data() + row[x], indices.data() + row[x + 1]);
+    }
+  }
+
+private:
+  gcc_pure
+  unsigned GetCell(int offset) const {
+    return offset > 0 ? unsigned(offset) / cell_size : 0;
+  }
+};
+
+#endif
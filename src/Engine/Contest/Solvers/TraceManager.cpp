@@ -97,6 +97,7 @@ TraceManager::ClearTrace()
   append_serial = modify_serial = Serial();
   trace_dirty = true;
   trace.clear();
+  trace_ids.clear();
   n_points = 0;
   predicted = TracePoint::Invalid();
 }
@@ -106,6 +107,7 @@ TraceManager::UpdateTraceFull()
 {
   trace.reserve(trace_master.GetMaxSize());
   trace_master.GetPoints(trace);
+  trace_master.GetPointIds(trace_ids);
   n_points = trace.size();
 
   if (n_points > 0 && predicted.IsDefined())
@@ -115,6 +117,15 @@ TraceManager::UpdateTraceFull()
   modify_serial = trace_master.GetModifySerial();
 }
 
+bool
+TraceManager::UpdateTracePatch(Trace::Changes &changes)
+{
+  trace_master.GetChanges(trace_ids, changes);
+  UpdateTraceFull();
+
+  return changes.n_removed < changes.new_index.size();
+}
+
 bool
 TraceManager::UpdateTraceTail()
 {
@@ -128,6 +139,9 @@ TraceManager::UpdateTraceTail()
     /* no new points */
     return false;
 
+  for (unsigned i = trace_ids.size(); i < trace.size(); ++i)
+    trace_ids.push_back(trace_master.GetPointId(trace[i]));
+
   n_points = trace.size();
 
   if (n_points > 0 && predicted.IsDefined())
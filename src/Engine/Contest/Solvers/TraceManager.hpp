@@ -56,6 +56,11 @@ protected:
    */
   TracePointerVector trace;
 
+  /**
+   * The Trace::GetPointId() of each element of #trace.
+   */
+  std::vector<unsigned> trace_ids;
+
   /** Number of points in current trace set */
   unsigned n_points;
 
@@ -91,6 +96,15 @@ protected:
    */
   void UpdateTraceFull();
 
+  /**
+   * Obtain a new #Trace copy, and determine where the points of the
+   * previous copy have gone.  Solvers may use this to patch their
+   * state instead of starting from scratch.
+   *
+   * @return false if no point of the previous copy has survived
+   */
+  bool UpdateTracePatch(Trace::Changes &changes);
+
   /**
    * Copy points that were added to the end of the master Trace.
    *
@@ -56,16 +56,23 @@ private:
   {
     unsigned edge_value;
 
+    /**
+     * The queue rank: #edge_value plus the heuristic estimate passed
+     * to Link().  Without a heuristic, this is a plain Dijkstra
+     * search; with an admissible one, it becomes A*.
+     */
+    unsigned rank;
+
     edge_iterator iterator;
 
-    Value(unsigned _edge_value, edge_iterator _iterator)
-      :edge_value(_edge_value), iterator(_iterator) {}
+    Value(unsigned _edge_value, unsigned _rank, edge_iterator _iterator)
+      :edge_value(_edge_value), rank(_rank), iterator(_iterator) {}
   };
 
   struct Rank : public std::binary_function<Value, Value, bool> {
     gcc_pure
     bool operator()(const Value &x, const Value &y) const {
-      return x.edge_value > y.edge_value;
+      return x.rank > y.rank;
     }
   };
 
@@ -166,10 +173,14 @@ public:
    * @param n Destination node to add
    * @param pn Predecessor of destination node
    * @param e Edge distance
+   * @param heuristic a lower bound for the remaining cost from the
+   * destination node to the goal; it only affects the order in which
+   * nodes are popped
    * @return false if this link was worse than an existing one
    */
-  bool Link(const Node node, const Node parent, unsigned edge_value) {
-    return Push(node, parent, current_value + edge_value);
+  bool Link(const Node node, const Node parent, unsigned edge_value,
+            unsigned heuristic=0) {
+    return Push(node, parent, current_value + edge_value, heuristic);
   }
 
   /**
@@ -208,8 +219,18 @@ public:
     // Clear the search queue
     q.clear();
 
-    for (const auto &i : edges)
-      q.push(Value(i.second.value, i));
+    for (auto i = edges.begin(), end = edges.end(); i != end; ++i)
+      q.push(Value(i->second.value, i->second.value, i));
+  }
+
+  /**
+   * Returns the number of bytes allocated by the edge map and the
+   * queue.  Their memory is kept by Clear() for the next search, so
+   * this is also the peak usage.
+   */
+  gcc_pure
+  size_t GetMemoryUsage() const {
+    return edges.GetMemoryUsage() + q.capacity() * sizeof(Value);
   }
 
 private:
@@ -219,9 +240,11 @@ private:
    * @param n Destination node to add
    * @param pn Previous node
    * @param e Edge distance (previous to this)
+   * @param heuristic see Link()
    * @return false if this link was worse than an existing one
    */
-  bool Push(const Node node, const Node parent, unsigned edge_value = 0) {
+  bool Push(const Node node, const Node parent, unsigned edge_value = 0,
+            unsigned heuristic = 0) {
     // Try to find the given node n in the EdgeMap
     edge_iterator it = edges.find(node);
     if (it == edges.end())
@@ -238,7 +261,7 @@ private:
       // -> Don't use this new leg
       return false;
 
-    q.push(Value(edge_value, it));
+    q.push(Value(edge_value, edge_value + heuristic, it));
     return true;
   }
 };
@@ -25,11 +25,11 @@ Copyright_License {
 #define NAV_DIJKSTRA_HPP
 
 #include "Dijkstra.hpp"
+#include "ReusableHashMap.hpp"
 #include "ScanTaskPoint.hpp"
 #include "SolverResult.hpp"
 #include "Compiler.h"
 
-#include <unordered_map>
 #include <assert.h>
 
 /**
@@ -57,9 +57,11 @@ protected:
       }
     };
 
+    /* the edge map is reused for all searches, to avoid heap
+       allocations in each Solve() call */
     template<typename Value>
-    struct Bind : public std::unordered_map<ScanTaskPoint, Value,
-                                            Hash, Equal> {
+    struct Bind : public ReusableHashMap<ScanTaskPoint, Value,
+                                         Hash, Equal> {
     };
   };
 
@@ -75,6 +77,12 @@ protected:
    */
   unsigned solution[MAX_STAGES];
 
+  /**
+   * The number of nodes which were taken from the queue by
+   * DistanceGeneral().  This is never reset by this class.
+   */
+  unsigned n_steps;
+
 protected:
   /**
    * Constructor
@@ -84,6 +92,7 @@ protected:
    * @return Initialised object
    */
   NavDijkstra(const unsigned _num_stages)
+    :n_steps(0)
   {
     SetStageCount(_num_stages);
   }
@@ -140,12 +149,13 @@ protected:
   }
 
   bool Link(const ScanTaskPoint node, const ScanTaskPoint parent,
-            unsigned value) {
-    return dijkstra.Link(node, parent, value);
+            unsigned value, unsigned heuristic=0) {
+    return dijkstra.Link(node, parent, value, heuristic);
   }
 
-  void LinkStart(const ScanTaskPoint node, unsigned value=0) {
-    Link(node, node, value);
+  void LinkStart(const ScanTaskPoint node, unsigned value=0,
+                 unsigned heuristic=0) {
+    Link(node, node, value, heuristic);
   }
 
   /**
@@ -159,6 +169,7 @@ protected:
   SolverResult DistanceGeneral(unsigned max_steps = 0 - 1) {
     while (!dijkstra.IsEmpty()) {
       const ScanTaskPoint destination = dijkstra.Pop();
+      ++n_steps;
 
       if (IsFinal(destination)) {
         FindSolution(destination);
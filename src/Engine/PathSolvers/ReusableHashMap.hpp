@@ -0,0 +1,267 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_REUSABLE_HASH_MAP_HPP
+#define XCSOAR_REUSABLE_HASH_MAP_HPP
+
+#include "Compiler.h"
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <iterator>
+#include <functional>
+#include <cstddef>
+
+#include <stdint.h>
+
+#include <assert.h>
+
+/**
+ * A hash map which keeps its memory when it is cleared, so it can be
+ * reused for many searches without allocating; clear() is O(1).
+ *
+ * The elements are stored contiguously in insertion order, and the
+ * index uses open addressing.  Elements cannot be erased.  Iterators
+ * remain valid when elements are inserted (pointers and references
+ * don't), until clear() is called.
+ *
+ * Key and T must be trivially copyable.
+ */
+template<typename Key, typename T, typename Hash,
+         typename Equal=std::equal_to<Key>>
+class ReusableHashMap {
+public:
+  typedef std::pair<Key, T> value_type;
+  typedef std::size_t size_type;
+
+private:
+  struct Slot {
+    /**
+     * The #generation in which this slot was written.  If it is
+     * different, then the slot is empty.  0 means "never".
+     */
+    unsigned generation;
+
+    /**
+     * The index in #elements.
+     */
+    unsigned index;
+  };
+
+  std::vector<value_type> elements;
+
+  /**
+   * The hash index.  Its size is zero or a power of two, and it is
+   * at most half full.
+   */
+  std::vector<Slot> slots;
+
+  unsigned generation;
+
+  Hash hash;
+  Equal equal;
+
+  template<typename M, typename V>
+  class IteratorBase {
+    friend class ReusableHashMap;
+    template<typename M2, typename V2> friend class IteratorBase;
+
+    M *map;
+    unsigned index;
+
+    IteratorBase(M *_map, unsigned _index):map(_map), index(_index) {}
+
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef std::ptrdiff_t difference_type;
+    typedef V value_type;
+    typedef V *pointer;
+    typedef V &reference;
+
+    IteratorBase() = default;
+
+    /**
+     * Convert an iterator to a const_iterator.
+     */
+    template<typename M2, typename V2>
+    IteratorBase(const IteratorBase<M2, V2> &other)
+      :map(other.map), index(other.index) {}
+
+    V &operator*() const {
+      return map->elements[index];
+    }
+
+    V *operator->() const {
+      return &map->elements[index];
+    }
+
+    IteratorBase &operator++() {
+      ++index;
+      return *this;
+    }
+
+    bool operator==(const IteratorBase &other) const {
+      return index == other.index;
+    }
+
+    bool operator!=(const IteratorBase &other) const {
+      return index != other.index;
+    }
+  };
+
+public:
+  typedef IteratorBase<ReusableHashMap, value_type> iterator;
+  typedef IteratorBase<const ReusableHashMap, const value_type> const_iterator;
+
+  ReusableHashMap():generation(1) {}
+
+  bool empty() const {
+    return elements.empty();
+  }
+
+  size_type size() const {
+    return elements.size();
+  }
+
+  iterator begin() {
+    return iterator(this, 0);
+  }
+
+  iterator end() {
+    return iterator(this, elements.size());
+  }
+
+  const_iterator begin() const {
+    return const_iterator(this, 0);
+  }
+
+  const_iterator end() const {
+    return const_iterator(this, elements.size());
+  }
+
+  /**
+   * Remove all elements, but keep the allocated memory.
+   */
+  void clear() {
+    elements.clear();
+
+    if (++generation == 0) {
+      /* wraparound: really clear the index (once every 2^32 calls) */
+      std::fill(slots.begin(), slots.end(), Slot{0, 0});
+      generation = 1;
+    }
+  }
+
+  iterator find(const Key &key) {
+    return iterator(this, Find(key));
+  }
+
+  gcc_pure
+  const_iterator find(const Key &key) const {
+    return const_iterator(this, Find(key));
+  }
+
+  /**
+   * Insert an element, unless the key exists already.
+   *
+   * @return an iterator to the element with this key, and whether it
+   * was inserted
+   */
+  std::pair<iterator, bool> insert(const value_type &value) {
+    if ((elements.size() + 1) * 2 > slots.size())
+      Rehash(std::max<size_type>(slots.size() * 2, 64));
+
+    const size_type mask = slots.size() - 1;
+    for (size_type i = GetHome(value.first) & mask;; i = (i + 1) & mask) {
+      Slot &slot = slots[i];
+      if (slot.generation != generation) {
+        slot.generation = generation;
+        slot.index = elements.size();
+        elements.push_back(value);
+        return std::make_pair(iterator(this, slot.index), true);
+      }
+
+      if (equal(elements[slot.index].first, value.first))
+        return std::make_pair(iterator(this, slot.index), false);
+    }
+  }
+
+  /**
+   * Returns the number of bytes allocated by this object.  Since
+   * memory is never freed, this is also the peak usage.
+   */
+  gcc_pure
+  size_type GetMemoryUsage() const {
+    return elements.capacity() * sizeof(value_type) +
+      slots.capacity() * sizeof(Slot);
+  }
+
+private:
+  /**
+   * Scramble the hash value, because the index only uses its lower
+   * bits.
+   */
+  gcc_pure
+  size_type GetHome(const Key &key) const {
+    uint32_t h = hash(key);
+    h ^= h >> 16;
+    h *= 0x45d9f3b;
+    h ^= h >> 16;
+    return h;
+  }
+
+  gcc_pure
+  unsigned Find(const Key &key) const {
+    if (slots.empty())
+      return elements.size();
+
+    const size_type mask = slots.size() - 1;
+    for (size_type i = GetHome(key) & mask;; i = (i + 1) & mask) {
+      const Slot &slot = slots[i];
+      if (slot.generation != generation)
+        return elements.size();
+
+      if (equal(elements[slot.index].first, key))
+        return slot.index;
+    }
+  }
+
+  void Rehash(size_type new_size) {
+    assert((new_size & (new_size - 1)) == 0);
+    assert(new_size > elements.size() * 2);
+
+    slots.assign(new_size, Slot{0, 0});
+
+    const size_type mask = new_size - 1;
+    for (unsigned index = 0; index < elements.size(); ++index) {
+      size_type i = GetHome(elements[index].first) & mask;
+      while (slots[i].generation == generation)
+        i = (i + 1) & mask;
+
+      slots[i] = Slot{generation, index};
+    }
+  }
+};
+
+#endif
@@ -27,6 +27,8 @@
 #include "Airspace/Predicate/AirspacePredicateHeightRange.hpp"
 #include "Geo/Flat/FlatRay.hpp"
 
+#include <algorithm>
+
 // Airspace query helpers
 
 /**
@@ -102,7 +104,20 @@ AirspaceRoute::FirstIntersecting(const RouteLink &e) const
   const GeoPoint origin(projection.Unproject(e.first));
   const GeoPoint dest(projection.Unproject(e.second));
   AIV visitor(e, projection, rpolars_route);
-  m_airspaces.VisitIntersecting(origin, dest, visitor);
+
+  if (use_view) {
+    const FlatProjection &proj = GetAirspaceProjection();
+    const Airspace bb_target(origin.Middle(dest), proj,
+                             origin.Distance(dest) / 2);
+    const FlatRay ray(proj.ProjectInteger(origin), proj.ProjectInteger(dest));
+
+    for (const auto &as : view)
+      if (as.Overlaps(bb_target) && as.Intersects(ray) &&
+          visitor.SetIntersections(as.Intersects(origin, dest, proj)))
+        visitor.Visit(as.GetAirspace());
+  } else
+    m_airspaces.VisitIntersecting(origin, dest, visitor);
+
   const AIV::AIVResult res(visitor.GetNearest());
   ++count_airspace;
   return RouteAirspaceIntersection(res.first, res.second);
@@ -112,7 +127,17 @@ const AbstractAirspace *
 AirspaceRoute::InsideOthers(const AGeoPoint &origin) const
 {
   AirspaceInsideOtherVisitor visitor;
-  m_airspaces.VisitWithinRange(origin, fixed(1), visitor);
+
+  if (use_view) {
+    const Airspace bb_target(origin, GetAirspaceProjection(), fixed(1));
+
+    AirspaceVisitor &v = visitor;
+    for (const auto &as : view)
+      if (as.Overlaps(bb_target))
+        v.Visit(as);
+  } else
+    m_airspaces.VisitWithinRange(origin, fixed(1), visitor);
+
   ++count_airspace;
   return visitor.GetFound();
 }
@@ -191,10 +216,26 @@ AirspaceRoute::GetBackupPairs(const SearchPointVector &spv,
 unsigned
 AirspaceRoute::AirspaceSize() const
 {
-  return m_airspaces.GetSize();
+  return use_view ? view.size() : m_airspaces.GetSize();
 }
 
-AirspaceRoute::AirspaceRoute():m_airspaces(false)
+bool
+AirspaceRoute::IsAirspaceEmpty() const
+{
+  return use_view ? view.empty() : m_airspaces.IsEmpty();
+}
+
+const FlatProjection &
+AirspaceRoute::GetAirspaceProjection() const
+{
+  if (!use_view)
+    return m_airspaces.GetProjection();
+
+  return master != nullptr ? master->GetProjection() : projection;
+}
+
+AirspaceRoute::AirspaceRoute(bool _use_view)
+  :m_airspaces(false), use_view(_use_view), master(nullptr)
 {
   Reset();
 }
@@ -203,6 +244,7 @@ AirspaceRoute::~AirspaceRoute()
 {
   // clean up, we dont need the clearances any more
   m_airspaces.ClearClearances();
+  ClearView();
 }
 
 void
@@ -211,6 +253,58 @@ AirspaceRoute::Reset()
   RoutePlanner::Reset();
   m_airspaces.ClearClearances();
   m_airspaces.Clear();
+  ClearView();
+}
+
+void
+AirspaceRoute::ClearView()
+{
+  /* the envelopes are only valid as long as the master has not been
+     modified; after that, the clearances are freed by whoever
+     modified it */
+  if (master != nullptr && master->GetSerial() == master_serial)
+    for (const auto &i : view)
+      i.ClearClearance();
+
+  view.clear();
+  master = nullptr;
+}
+
+bool
+AirspaceRoute::SynchroniseView(const Airspaces &_master,
+                               const AirspacePredicate &condition,
+                               const GeoPoint &location, fixed range)
+{
+  if (&_master != master || _master.GetSerial() != master_serial) {
+    /* the old envelopes may refer to deleted airspaces; forget them
+       without touching them */
+    view.clear();
+    master = &_master;
+    master_serial = _master.GetSerial();
+  }
+
+  std::swap(view, previous_view);
+  view.clear();
+  _master.ScanRange(location, range, condition, view);
+  view.erase(std::remove_if(view.begin(), view.end(), [](const Airspace &a){
+        return !a.GetAirspace().IsActive();
+      }), view.end());
+
+  if (view == previous_view)
+    return false;
+
+  /* free the clearance polygons of the airspaces which are not
+     needed anymore; both vectors are in master tree order */
+  auto i = view.begin();
+  for (const auto &old : previous_view) {
+    auto found = std::find(i, view.end(), old);
+    if (found == view.end())
+      old.ClearClearance();
+    else
+      i = std::next(found);
+  }
+
+  return true;
 }
 
 void
@@ -229,10 +323,13 @@ AirspaceRoute::Synchronise(const Airspaces &master,
 
   AndAirspacePredicate condition(h_condition, _condition);
 
-  if (m_airspaces.SynchroniseInRange(master, origin.Middle(destination),
-                                     Half(origin.Distance(destination)),
-                                     condition)) {
-    if (!m_airspaces.IsEmpty())
+  const GeoPoint location = origin.Middle(destination);
+  const fixed range = Half(origin.Distance(destination));
+
+  if (use_view
+      ? SynchroniseView(master, condition, location, range)
+      : m_airspaces.SynchroniseInRange(master, location, range, condition)) {
+    if (!IsAirspaceEmpty())
       dirty = true;
   }
 }
@@ -242,7 +339,7 @@ AirspaceRoute::AddNearbyAirspace(const RouteAirspaceIntersection &inx,
                                  const RouteLink &e)
 {
   const SearchPointVector &fat =
-    inx.airspace->GetClearance(m_airspaces.GetProjection());
+    inx.airspace->GetClearance(GetAirspaceProjection());
   const ClearingPair p = GetPairs(fat, e.first, e.second);
   const ClearingPair pb = GetBackupPairs(fat, e.first, inx.point);
 
@@ -308,10 +405,10 @@ AirspaceRoute::CheckClearance(const RouteLink &e, RoutePoint &inp) const
 void
 AirspaceRoute::OnSolve(const AGeoPoint &origin, const AGeoPoint &destination)
 {
-  if (m_airspaces.IsEmpty()) {
+  if (IsAirspaceEmpty()) {
     projection.SetCenter(origin);
   } else {
-    projection = m_airspaces.GetProjection();
+    projection = GetAirspaceProjection();
   }
 }
 
@@ -25,10 +25,40 @@
 
 #include "RoutePlanner.hpp"
 #include "Airspace/Airspaces.hpp"
+#include "Util/Serial.hpp"
 
 class AirspaceRoute : public RoutePlanner {
   Airspaces m_airspaces;
 
+  /**
+   * If true, Synchronise() does not copy the matching airspaces into
+   * #m_airspaces, but only records their envelopes in #view.  The
+   * master store is not modified between Airspaces::Optimise() calls,
+   * so this avoids rebuilding a tree each time the route range or
+   * altitude band moves.
+   */
+  const bool use_view;
+
+  /**
+   * The master store #view refers to; nullptr if the view is empty.
+   * The caller must hold the lock protecting the master while
+   * Synchronise() and Solve() run.
+   */
+  const Airspaces *master;
+
+  /**
+   * The serial of #master when #view was filled; the view is stale
+   * when it differs.
+   */
+  Serial master_serial;
+
+  /**
+   * Envelopes of the master airspaces matching the last
+   * Synchronise() call.  #previous_view is only kept to reuse its
+   * allocation.
+   */
+  Airspaces::AirspaceVector view, previous_view;
+
   struct RouteAirspaceIntersection {
     const AbstractAirspace *airspace;
 
@@ -47,7 +77,11 @@ class AirspaceRoute : public RoutePlanner {
 public:
   friend class PrintHelper;
 
-  AirspaceRoute();
+  /**
+   * @param use_view use a filtered view of the master store instead
+   * of a private copy of the matching airspaces
+   */
+  AirspaceRoute(bool use_view=false);
   virtual ~AirspaceRoute();
 
   void Synchronise(const Airspaces &master, const AirspacePredicate &condition,
@@ -63,10 +97,21 @@ protected:
   void OnSolve(const AGeoPoint &origin, const AGeoPoint &destination) override;
 
   bool IsTrivial() const override {
-    return m_airspaces.IsEmpty() && RoutePlanner::IsTrivial();
+    return IsAirspaceEmpty() && RoutePlanner::IsTrivial();
   }
 
 private:
+  gcc_pure
+  bool IsAirspaceEmpty() const;
+
+  gcc_pure
+  const FlatProjection &GetAirspaceProjection() const;
+
+  bool SynchroniseView(const Airspaces &master, const AirspacePredicate &condition,
+                       const GeoPoint &location, fixed range);
+
+  void ClearView();
+
   bool CheckClearance(const RouteLink &e, RoutePoint &inp) const override;
   void AddNearby(const RouteLink &e) override;
   bool CheckSecondary(const RouteLink &e) override;
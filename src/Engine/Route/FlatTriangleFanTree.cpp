@@ -156,8 +156,12 @@ FlatTriangleFanTree::FillReach(const AFlatGeoPoint &origin, const int index_low,
   assert(vs.empty());
   vs.reserve(index_high - index_low + 1);
   AddPoint(origin);
+
+  FlatGeoPoint intercepts[ROUTEPOLAR_POINTS + 1];
+  parms.reach_intercepts(index_low, index_high, ao, intercepts);
+
   for (int index = index_low; index < index_high; ++index) {
-    const FlatGeoPoint x = parms.reach_intercept(index, ao);
+    const FlatGeoPoint &x = intercepts[index - index_low];
     /* hao: if reach_intercept() did not find anything reasonable it returns
      *      a FlatGeoPoint that is almost the same as origin, but differs
      *      +/- 1 due to conversion errors. The resulting polygon can have
@@ -52,6 +52,12 @@ struct ReachFanParms {
   FlatGeoPoint reach_intercept(const int index, const AGeoPoint& ao) const {
     return rpolars.ReachIntercept(index, ao, terrain, projection);
   }
+
+  void reach_intercepts(const int index_low, const int index_high,
+                        const AGeoPoint& ao, FlatGeoPoint *results) const {
+    rpolars.ReachIntercepts(index_low, index_high, ao, terrain, projection,
+                            results);
+  }
 };
 
 
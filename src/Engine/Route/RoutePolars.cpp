@@ -26,6 +26,10 @@
 #include "Geo/Flat/FlatProjection.hpp"
 #include "Terrain/RasterMap.hpp"
 
+#include <algorithm>
+
+#include <assert.h>
+
 #define MC_CEILING_PENALTY_FACTOR 5.0
 
 GeoPoint
@@ -256,3 +260,31 @@ RoutePolars::ReachIntercept(const int index, const AGeoPoint& origin,
     map->Intersection(m_origin, (short)altitude, (short)altitude, dest) : dest;
   return proj.ProjectInteger(p);
 }
+
+void
+RoutePolars::ReachIntercepts(const int index_low, const int index_high,
+                             const AGeoPoint &origin, const RasterMap *map,
+                             const FlatProjection &proj,
+                             FlatGeoPoint *results) const
+{
+  assert(index_high >= index_low);
+  assert(index_high - index_low <= ROUTEPOLAR_POINTS + 1);
+
+  const bool valid = map && map->IsDefined();
+  const RoughAltitude altitude = origin.altitude - GetSafetyHeight();
+  const AGeoPoint m_origin((GeoPoint)origin, altitude);
+  const unsigned n = index_high - index_low;
+
+  GeoPoint dests[ROUTEPOLAR_POINTS + 1], p[ROUTEPOLAR_POINTS + 1];
+  for (unsigned i = 0; i < n; ++i)
+    dests[i] = MSLIntercept(index_low + i, m_origin, proj);
+
+  if (valid)
+    map->Intersection(m_origin, (short)altitude, (short)altitude,
+                      dests, p, n);
+  else
+    std::copy_n(dests, n, p);
+
+  for (unsigned i = 0; i < n; ++i)
+    results[i] = proj.ProjectInteger(p[i]);
+}
@@ -236,6 +236,17 @@ public:
                               const RasterMap* map,
                               const FlatProjection &proj) const;
 
+  /**
+   * Calculate ReachIntercept() for all indices in the range
+   * [index_low, index_high), using the batch terrain intersection
+   * method.
+   *
+   * @param results an array with index_high-index_low elements
+   */
+  void ReachIntercepts(int index_low, int index_high, const AGeoPoint &p,
+                       const RasterMap *map, const FlatProjection &proj,
+                       FlatGeoPoint *results) const;
+
 private:
   GeoPoint MSLIntercept(const int index, const AGeoPoint &p,
                         const FlatProjection &proj) const;
@@ -23,17 +23,19 @@ Copyright_License {
 
 #include "Trace.hpp"
 #include "Vector.hpp"
-#include "Util/GlobalSliceAllocator.hpp"
 
 #include <algorithm>
 
 Trace::Trace(const unsigned _no_thin_time, const unsigned max_time,
              const unsigned max_size)
-  :cached_size(0),
+  :points(2 * max_size), deltas(2 * max_size), heap(max_size),
+   heap_size(0),
+   head(0), tail(0), next_id(0),
    max_time(max_time),
    no_thin_time(_no_thin_time),
    max_size(max_size),
-   opt_size((3 * max_size) / 4)
+   opt_size((3 * max_size) / 4),
+   average_delta_time(0), average_delta_distance(0)
 {
   assert(max_size >= 4);
 }
@@ -41,18 +43,10 @@ Trace::Trace(const unsigned _no_thin_time, const unsigned max_time,
 void
 Trace::clear()
 {
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.size());
-
   average_delta_distance = 0;
   average_delta_time = 0;
 
-  delta_list.clear();
-  chronological_list.clear_and_dispose(MakeDisposer());
-  cached_size = 0;
-
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.size());
+  head = tail = 0;
 
   ++modify_serial;
   ++append_serial;
@@ -71,102 +65,220 @@ Trace::GetRecentTime(const unsigned t) const
   return 0;
 }
 
+bool
+Trace::DeltaRank(const HeapItem &a, const HeapItem &b)
+{
+  // distance is king
+  if (a.elim_distance < b.elim_distance)
+    return true;
+
+  if (a.elim_distance > b.elim_distance)
+    return false;
+
+  // distance is equal, so go by time error
+  if (a.elim_time < b.elim_time)
+    return true;
+
+  if (a.elim_time > b.elim_time)
+    return false;
+
+  // all else fails, go by age
+  return a.index < b.index;
+}
+
 void
-Trace::UpdateDelta(TraceDelta &td)
+Trace::HeapSwap(unsigned a, unsigned b)
 {
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.size());
+  std::swap(heap[a], heap[b]);
+  deltas[heap[a].index].heap_index = a;
+  deltas[heap[b].index].heap_index = b;
+}
 
-  if (&td == &chronological_list.front() ||
-      &td == &chronological_list.back())
-    return;
+void
+Trace::HeapSiftUp(unsigned i)
+{
+  while (i > 0) {
+    const unsigned parent = (i - 1) / 2;
+    if (!DeltaRank(heap[i], heap[parent]))
+      break;
 
-  const auto ci = chronological_list.iterator_to(td);
-  const TraceDelta &previous = *std::prev(ci);
-  const TraceDelta &next = *std::next(ci);
+    HeapSwap(i, parent);
+    i = parent;
+  }
+}
+
+void
+Trace::HeapSiftDown(unsigned i)
+{
+  while (true) {
+    unsigned best = i;
+    const unsigned left = 2 * i + 1, right = left + 1;
+    if (left < heap_size && DeltaRank(heap[left], heap[best]))
+      best = left;
+    if (right < heap_size && DeltaRank(heap[right], heap[best]))
+      best = right;
+
+    if (best == i)
+      break;
 
-  delta_list.erase(delta_list.iterator_to(td));
-  td.Update(previous.point, next.point);
-  delta_list.insert(td);
+    HeapSwap(i, best);
+    i = best;
+  }
+}
+
+unsigned
+Trace::HeapPop()
+{
+  assert(heap_size > 0);
+
+  const unsigned top = heap[0].index;
+  deltas[top].heap_index = NOT_IN_HEAP;
+
+  if (--heap_size > 0) {
+    heap[0] = heap[heap_size];
+    deltas[heap[0].index].heap_index = 0;
+    HeapSiftDown(0);
+  }
+
+  return top;
 }
 
 void
-Trace::EraseInside(DeltaList::iterator it)
+Trace::UpdateDelta(unsigned i)
 {
-  assert(cached_size > 0);
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.size());
-  assert(it != delta_list.end());
+  if (i == head || i == tail - 1)
+    return;
+
+  TraceDelta &td = deltas[i];
 
-  const TraceDelta &td = *it;
+  /* the delta_distance of a non-edge point is the distance to its
+     predecessor, which is this one */
+  const unsigned next_distance = td.next == tail - 1
+    ? points[i].FlatDistanceTo(points[td.next])
+    : deltas[td.next].delta_distance;
+
+  td.Update(points[td.prev], points[i], points[td.next], next_distance);
+
+  if (td.heap_index != NOT_IN_HEAP) {
+    HeapItem &item = heap[td.heap_index];
+    item.elim_distance = td.elim_distance;
+    item.elim_time = td.elim_time;
+
+    HeapSiftUp(td.heap_index);
+    HeapSiftDown(td.heap_index);
+  }
+}
+
+void
+Trace::EraseInside(unsigned i)
+{
+  const TraceDelta &td = deltas[i];
   assert(!td.IsEdge());
+  assert(td.heap_index == NOT_IN_HEAP);
 
-  const auto ci = chronological_list.iterator_to(td);
-  TraceDelta &previous = const_cast<TraceDelta &>(*std::prev(ci));
-  TraceDelta &next = const_cast<TraceDelta &>(*std::next(ci));
+  const unsigned previous = td.prev, next = td.next;
+  deltas[previous].next = next;
+  deltas[next].prev = previous;
 
-  // now delete the item
-  chronological_list.erase(chronological_list.iterator_to(td));
-  delta_list.erase_and_dispose(it, MakeDisposer());
-  --cached_size;
+  // and update the deltas; the next one first, because the previous
+  // one needs its new delta_distance
+  if (next != tail - 1)
+    deltas[next].delta_distance =
+      points[next].FlatDistanceTo(points[previous]);
 
-  // and update the deltas
-  UpdateDelta(previous);
   UpdateDelta(next);
+  UpdateDelta(previous);
 }
 
 bool
 Trace::EraseDelta(const unsigned target_size, const unsigned recent)
 {
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.size());
-
-  if (size() <= 2)
+  if (size() <= 2 || size() <= target_size)
     return false;
 
-  bool modified = false;
-
   const unsigned recent_time = GetRecentTime(recent);
 
-  auto candidate = delta_list.begin();
-  while (size() > target_size) {
-    const TraceDelta &td = *candidate;
-    if (!td.IsEdge() && td.point.GetTime() < recent_time) {
-      EraseInside(candidate);
-      candidate = delta_list.begin(); // find new top
-      modified = true;
-    } else {
-      ++candidate;
-      // suppressed removal, skip it.
+  /* link the points and collect the candidates; edges and recent
+     points are never erased, so they stay out of the heap */
+  heap_size = 0;
+  for (unsigned i = head; i < tail; ++i) {
+    TraceDelta &td = deltas[i];
+    td.prev = i - 1;
+    td.next = i + 1;
+
+    if (!td.IsEdge() && points[i].GetTime() < recent_time) {
+      td.heap_index = heap_size;
+      HeapItem &item = heap[heap_size++];
+      item.elim_distance = td.elim_distance;
+      item.elim_time = td.elim_time;
+      item.index = i;
+    } else
+      td.heap_index = NOT_IN_HEAP;
+  }
+
+  for (unsigned i = heap_size / 2; i-- > 0;)
+    HeapSiftDown(i);
+
+  if (heap_size == 0)
+    return false;
+
+  unsigned remaining = size();
+  while (remaining > target_size && heap_size > 0) {
+    EraseInside(HeapPop());
+    --remaining;
+  }
+
+  /* move the survivors to the beginning of the arrays, following
+     the links */
+  unsigned dest = 0;
+  for (unsigned i = head; i != tail; i = deltas[i].next) {
+    if (i != dest) {
+      points[dest] = points[i];
+      deltas[dest] = deltas[i];
     }
+
+    ++dest;
   }
 
-  return modified;
+  assert(dest == remaining);
+
+  head = 0;
+  tail = dest;
+  return true;
+}
+
+void
+Trace::Compact()
+{
+  if (head == 0)
+    return;
+
+  std::copy(points.begin() + head, points.begin() + tail, points.begin());
+  std::copy(deltas.begin() + head, deltas.begin() + tail, deltas.begin());
+  tail -= head;
+  head = 0;
 }
 
 bool
 Trace::EraseEarlierThan(const unsigned p_time)
 {
-  if (p_time == 0 || empty() || GetFront().point.GetTime() >= p_time)
+  if (p_time == 0 || empty() || front().GetTime() >= p_time)
     // there will be nothing to remove
     return false;
 
   do {
-    auto ci = chronological_list.begin();
-    TraceDelta &td = *ci;
-    chronological_list.erase(ci);
-
-    auto i = delta_list.find(td);
-    assert(i != delta_list.end());
-    delta_list.erase_and_dispose(i, MakeDisposer());
-
-    --cached_size;
-  } while (!empty() && GetFront().point.GetTime() < p_time);
+    ++head;
+  } while (!empty() && front().GetTime() < p_time);
 
-  // need to set deltas for first point, only one of these
-  // will occur (have to search for this point)
+  // need to set deltas for first point
   if (!empty())
-    EraseStart(GetFront());
+    deltas[head].SetEdge();
+
+  /* reclaim the space at the front before push_back() runs out of
+     room; this is a good time, because the modify serial is
+     incremented anyway */
+  if (head >= max_size)
+    Compact();
 
   ++modify_serial;
   ++append_serial;
@@ -179,48 +291,22 @@ Trace::EraseLaterThan(const unsigned min_time)
   assert(min_time > 0);
   assert(!empty());
 
-  while (!empty() && GetBack().point.GetTime() > min_time) {
-    TraceDelta &td = GetBack();
-
-    chronological_list.erase(chronological_list.iterator_to(td));
-
-    auto i = delta_list.find(td);
-    assert(i != delta_list.end());
-    delta_list.erase_and_dispose(i, MakeDisposer());
+  while (!empty() && back().GetTime() > min_time)
+    --tail;
 
-    --cached_size;
-  }
-
-  /* need to set deltas for first point, only one of these will occur
-     (have to search for this point) */
+  /* need to set deltas for last point */
   if (!empty())
-    EraseStart(GetBack());
-}
-
-/**
- * Update start node (and neighbour) after min time pruning
- */
-void
-Trace::EraseStart(TraceDelta &td)
-{
-  delta_list.erase(delta_list.iterator_to(td));
-
-  td.elim_distance = null_delta;
-  td.elim_time = null_time;
-
-  delta_list.insert(td);
+    deltas[tail - 1].SetEdge();
 }
 
 void
 Trace::push_back(const TracePoint &point)
 {
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.size());
-
   if (empty()) {
     // first point determines origin for flat projection
     task_projection.Reset(point.GetLocation());
     task_projection.Update();
+    head = tail = 0;
   } else if (point.GetTime() < back().GetTime()) {
     // gone back in time
 
@@ -243,18 +329,20 @@ Trace::push_back(const TracePoint &point)
     Thin();
 
   assert(size() < max_size);
+  assert(tail < points.size());
 
-  TraceDelta *td = allocator.allocate(1);
-  allocator.construct(td, point);
-  td->point.Project(task_projection);
-
-  delta_list.insert(*td);
-  chronological_list.push_back(*td);
+  const unsigned i = tail++;
+  points[i] = point;
+  points[i].Project(task_projection);
 
-  ++cached_size;
+  TraceDelta &td = deltas[i];
+  td.SetEdge();
+  td.delta_distance = 0;
+  td.id = next_id++;
 
-  if (td != &chronological_list.front())
-    UpdateDelta(*std::prev(chronological_list.iterator_to(*td)));
+  if (i > head + 1)
+    /* the previous point is not an edge anymore */
+    deltas[i - 1].Update(points[i - 2], points[i - 1], points[i]);
 
   ++append_serial;
 }
@@ -266,10 +354,9 @@ Trace::CalcAverageDeltaDistance(const unsigned no_thin) const
   unsigned acc = 0;
   unsigned counter = 0;
 
-  const auto end = chronological_list.end();
-  for (auto it = chronological_list.begin();
-       it != end && it->point.GetTime() < r; ++it, ++counter)
-    acc += it->delta_distance;
+  for (unsigned i = head; i < tail && points[i].GetTime() < r;
+       ++i, ++counter)
+    acc += deltas[i].delta_distance;
 
   if (counter)
     return acc / counter;
@@ -281,22 +368,21 @@ unsigned
 Trace::CalcAverageDeltaTime(const unsigned no_thin) const
 {
   unsigned r = GetRecentTime(no_thin);
-  unsigned counter = 0;
 
   /* find the last item before the "r" timestamp */
-  const auto end = chronological_list.end();
-  ChronologicalList::const_iterator it;
-  for (it = chronological_list.begin(); it != end && it->point.GetTime() < r; ++it)
-    ++counter;
+  unsigned i = head;
+  while (i < tail && points[i].GetTime() < r)
+    ++i;
 
+  unsigned counter = i - head;
   if (counter < 2)
     return 0;
 
-  --it;
+  --i;
   --counter;
 
   unsigned start_time = front().GetTime();
-  unsigned end_time = it->point.GetTime();
+  unsigned end_time = points[i].GetTime();
   return (end_time - start_time) / counter;
 }
 
@@ -337,8 +423,6 @@ Trace::Thin2()
 void
 Trace::Thin()
 {
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.size());
   assert(size() == max_size);
 
   Thin2();
@@ -355,57 +439,16 @@ Trace::Thin()
 void
 Trace::GetPoints(TracePointVector& iov) const
 {
-  iov.clear();
-  iov.reserve(size());
-  std::copy(begin(), end(), std::back_inserter(iov));
+  iov.assign(begin(), end());
 }
 
-template<typename I>
-class PointerIterator {
-  I i;
-
-public:
-  typedef typename I::iterator_category iterator_category;
-  typedef typename I::pointer value_type;
-  typedef typename I::pointer *pointer;
-  typedef value_type &reference;
-  typedef typename I::difference_type difference_type;
-
-  PointerIterator() = default;
-  explicit PointerIterator(I _i):i(_i) {}
-  PointerIterator<I> &operator=(const PointerIterator<I> &other) = default;
-
-  PointerIterator<I> &operator--() {
-    --i;
-    return *this;
-  }
-
-  PointerIterator<I> &operator++() {
-    ++i;
-    return *this;
-  }
-
-  typename I::pointer operator*() {
-    return &*i;
-  }
-
-  bool operator==(const PointerIterator<I> &other) const {
-    return i == other.i;
-  }
-
-  bool operator!=(const PointerIterator<I> &other) const {
-    return i != other.i;
-  }
-};
-
 void
 Trace::GetPoints(TracePointerVector &v) const
 {
   v.clear();
   v.reserve(size());
-  std::copy(PointerIterator<decltype(begin())>(begin()),
-            PointerIterator<decltype(end())>(end()),
-            std::back_inserter(v));
+  for (const TracePoint &point : *this)
+    v.push_back(&point);
 }
 
 bool
@@ -418,20 +461,58 @@ Trace::SyncPoints(TracePointerVector &v) const
     return false;
 
   v.reserve(size());
+  for (auto i = end() - (size() - v.size()), e = end(); i != e; ++i)
+    v.push_back(i);
 
-  PointerIterator<decltype(end())> e(end());
-  std::copy(std::prev(e, size() - v.size()), e,
-            std::back_inserter(v));
   assert(v.size() == size());
   return true;
 }
 
+void
+Trace::GetPointIds(std::vector<unsigned> &ids) const
+{
+  ids.clear();
+  ids.reserve(size());
+  for (unsigned i = head; i < tail; ++i)
+    ids.push_back(deltas[i].id);
+}
+
+void
+Trace::GetChanges(const std::vector<unsigned> &ids, Changes &changes) const
+{
+  changes.new_index.resize(ids.size());
+  changes.n_removed = 0;
+
+  /* both id lists are sorted, so a merge finds the survivors */
+  unsigned i = head;
+  for (unsigned j = 0; j < ids.size(); ++j) {
+    while (i < tail && deltas[i].id < ids[j])
+      ++i;
+
+    if (i < tail && deltas[i].id == ids[j]) {
+      changes.new_index[j] = i - head;
+      ++i;
+    } else {
+      changes.new_index[j] = Changes::REMOVED;
+      ++changes.n_removed;
+    }
+  }
+
+  /* the points after the newest point of the copy are new */
+  i = head;
+  if (!ids.empty())
+    while (i < tail && deltas[i].id <= ids.back())
+      ++i;
+
+  changes.first_appended = i - head;
+}
+
 void
 Trace::GetPoints(TracePointVector &v, unsigned min_time,
                  const GeoPoint &location, fixed min_distance) const
 {
   /* skip the trace points that are before min_time */
-  Trace::const_iterator i = begin(), end = this->end();
+  const_iterator i = begin(), end = this->end();
   unsigned skipped = 0;
   while (true) {
     if (i == end)
@@ -452,7 +533,12 @@ Trace::GetPoints(TracePointVector &v, unsigned min_time,
   const unsigned range = ProjectRange(location, min_distance);
   const unsigned sq_range = range * range;
   do {
-    v.push_back(*i);
-    i.NextSquareRange(sq_range, end);
+    const TracePoint &previous = *i;
+    v.push_back(previous);
+
+    /* skip points which are closer than the resolution */
+    do {
+      ++i;
+    } while (i != end && i->FlatSquareDistanceTo(previous) < sq_range);
   } while (i != end);
 }
@@ -26,15 +26,13 @@ Copyright_License {
 
 #include "Point.hpp"
 #include "Util/NonCopyable.hpp"
-#include "Util/SliceAllocator.hpp"
+#include "Util/AllocatedArray.hpp"
 #include "Util/Serial.hpp"
 #include "Geo/Flat/TaskProjection.hpp"
 #include "Compiler.h"
 
-#include <boost/intrusive/list.hpp>
-#include <boost/intrusive/set.hpp>
-
 #include <algorithm>
+#include <vector>
 
 #include <assert.h>
 #include <stdlib.h>
@@ -51,71 +49,43 @@ class TracePointerVector;
  * the candidate point removed.  In this version, time differences is also a
  * secondary factor, such that thinning attempts to remove points such that,
  * for equal distance ranking, smaller time step details are removed first.
+ *
+ * The points are stored in one contiguous array in chronological
+ * order, so iterating and copying is cheap.  Their thinning metrics
+ * live in a parallel array, and are ranked with an indexed heap only
+ * while thinning.  Pointers to stored points remain valid until the
+ * #Serial returned by GetModifySerial() changes.
  */
 class Trace : private NonCopyable
 {
-  struct TraceDelta
-    : boost::intrusive::set_base_hook<boost::intrusive::link_mode<boost::intrusive::normal_link>>,
-      boost::intrusive::list_base_hook<boost::intrusive::link_mode<boost::intrusive::normal_link>> {
+  /**
+   * The thinning metrics of one point, stored at the same index as
+   * the point.
+   */
+  struct TraceDelta {
+    unsigned elim_time;
+    unsigned elim_distance;
+    unsigned delta_distance;
 
     /**
-     * Function used to points for sorting by deltas.
-     * Ranking is primarily by distance delta; for equal distances, rank by
-     * time delta.
-     * This is like a modified Douglas-Peuker algorithm
+     * The chronological neighbours.  Only valid during EraseDelta().
      */
-    gcc_pure
-    static bool DeltaRank(const TraceDelta &x, const TraceDelta &y) {
-      // distance is king
-      if (x.elim_distance < y.elim_distance)
-        return true;
-
-      if (x.elim_distance > y.elim_distance)
-        return false;
-
-      // distance is equal, so go by time error
-      if (x.elim_time < y.elim_time)
-        return true;
-
-      if (x.elim_time > y.elim_time)
-        return false;
-
-      // all else fails, go by age
-      if (x.point.IsOlderThan(y.point))
-        return true;
-
-      if (x.point.IsNewerThan(y.point))
-        return false;
-
-      return false;
-    }
-
-    struct DeltaRankOp {
-      gcc_pure
-      bool operator()(const TraceDelta &s1, const TraceDelta &s2) const {
-        return DeltaRank(s1, s2);
-      }
-    };
+    unsigned prev, next;
 
-    TracePoint point;
+    /**
+     * The position in Trace::heap, or #NOT_IN_HEAP.  Only valid
+     * during EraseDelta().
+     */
+    unsigned heap_index;
 
-    unsigned elim_time;
-    unsigned elim_distance;
-    unsigned delta_distance;
+    /**
+     * See Trace::GetPointId().
+     */
+    unsigned id;
 
-    explicit TraceDelta(const TracePoint &p)
-      :point(p),
-       elim_time(null_time), elim_distance(null_delta),
-       delta_distance(0) {}
-
-    TraceDelta(const TracePoint &p_last, const TracePoint &p,
-               const TracePoint &p_next)
-      :point(p),
-       elim_time(TimeMetric(p_last, p, p_next)),
-       elim_distance(DistanceMetric(p_last, p, p_next)),
-       delta_distance(p.FlatDistanceTo(p_last))
-    {
-      assert(elim_distance != null_delta);
+    void SetEdge() {
+      elim_time = null_time;
+      elim_distance = null_delta;
     }
 
     /**
@@ -125,10 +95,22 @@ class Trace : private NonCopyable
       return elim_time == null_time;
     }
 
-    void Update(const TracePoint &p_last, const TracePoint &p_next) {
-      elim_time = TimeMetric(p_last, point, p_next);
-      elim_distance = DistanceMetric(p_last, point, p_next);
-      delta_distance = point.FlatDistanceTo(p_last);
+    void Update(const TracePoint &p_last, const TracePoint &p,
+                const TracePoint &p_next) {
+      delta_distance = p.FlatDistanceTo(p_last);
+      Update(p_last, p, p_next, p.FlatDistanceTo(p_next));
+    }
+
+    /**
+     * Like Update(), but reuse #delta_distance, which must be up to
+     * date, and the given distance to the next point.  This saves
+     * most of the distance calculations while thinning.
+     */
+    void Update(const TracePoint &p_last, const TracePoint &p,
+                const TracePoint &p_next, unsigned next_distance) {
+      elim_time = TimeMetric(p_last, p, p_next);
+      elim_distance = DistanceMetric(delta_distance, next_distance,
+                                     p_last.FlatDistanceTo(p_next));
     }
 
     /**
@@ -136,17 +118,18 @@ class Trace : private NonCopyable
      * if this node is removed.  This metric provides for Douglas-Peuker
      * thinning.
      *
-     * @param last Point previous in time to this node
-     * @param node This node
-     * @param next Point succeeding this node
+     * @param last_distance Distance from the previous point to this node
+     * @param next_distance Distance from this node to the next point
+     * @param skip_distance Distance from the previous to the next
+     * point
      *
      * @return Distance error if this node is thinned
      */
-    static unsigned DistanceMetric(const TracePoint &last,
-                                   const TracePoint &node,
-                                   const TracePoint &next) {
-      const int d_this = last.FlatDistanceTo(node) + node.FlatDistanceTo(next);
-      const int d_rem = last.FlatDistanceTo(next);
+    static unsigned DistanceMetric(unsigned last_distance,
+                                   unsigned next_distance,
+                                   unsigned skip_distance) {
+      const int d_this = last_distance + next_distance;
+      const int d_rem = skip_distance;
       return abs(d_this - d_rem);
     }
 
@@ -168,20 +151,46 @@ class Trace : private NonCopyable
     }
   };
 
-  /* using multiset, not because we need multiple values (we don't),
-     but to avoid set's overhead for duplicate elimination */
-  typedef boost::intrusive::multiset<TraceDelta,
-                                     boost::intrusive::compare<TraceDelta::DeltaRankOp>,
-                                     boost::intrusive::constant_time_size<false>> DeltaList;
+  /**
+   * The points, in chronological order.  The range [head, tail) is
+   * occupied.  The array has room for twice #max_size points, so
+   * points erased at the front can be reclaimed lazily.
+   */
+  AllocatedArray<TracePoint> points;
 
-  typedef boost::intrusive::list<TraceDelta,
-                                 boost::intrusive::constant_time_size<false>> ChronologicalList;
+  /**
+   * The thinning metrics for each element of #points.
+   */
+  AllocatedArray<TraceDelta> deltas;
 
-  SliceAllocator<TraceDelta, 128u> allocator;
+  /**
+   * An element of #heap.  It carries a copy of the ranking metrics,
+   * so comparisons don't need to look up #deltas.
+   */
+  struct HeapItem {
+    unsigned elim_distance;
+    unsigned elim_time;
 
-  DeltaList delta_list;
-  ChronologicalList chronological_list;
-  unsigned cached_size;
+    /**
+     * The index into #points.  Points are stored in chronological
+     * order, so the lower index is the older point.
+     */
+    unsigned index;
+  };
+
+  /**
+   * A binary heap of points, ordered by DeltaRank().  Only used
+   * during EraseDelta().  It has room for #max_size elements.
+   */
+  AllocatedArray<HeapItem> heap;
+  unsigned heap_size;
+
+  unsigned head, tail;
+
+  /**
+   * The id which will be assigned to the next point.
+   */
+  unsigned next_id;
 
   TaskProjection task_projection;
 
@@ -195,26 +204,34 @@ class Trace : private NonCopyable
 
   Serial append_serial, modify_serial;
 
-  template<typename Alloc>
-  struct Disposer {
-    Alloc &alloc;
+public:
+  typedef const TracePoint *const_iterator;
 
-    void operator()(typename Alloc::pointer td) {
-      alloc.destroy(td);
-      alloc.deallocate(td, 1);
-    }
-  };
+  /**
+   * Describes how the points of a #Trace have changed since a copy
+   * was obtained, see GetChanges().  Points which were replaced
+   * after a time warp appear as removed and appended.
+   */
+  struct Changes {
+    static constexpr unsigned REMOVED = 0 - 1;
 
-  template<typename Alloc>
-  static Disposer<Alloc> MakeDisposer(Alloc &alloc) {
-    return {alloc};
-  }
+    /**
+     * The current index of each point of the copy, or #REMOVED.
+     */
+    std::vector<unsigned> new_index;
 
-  Disposer<decltype(allocator)> MakeDisposer() {
-    return MakeDisposer(allocator);
-  }
+    /**
+     * The index of the first point which was not in the copy.  All
+     * points after it are new, too.
+     */
+    unsigned first_appended;
+
+    /**
+     * The number of points of the copy which are gone.
+     */
+    unsigned n_removed;
+  };
 
-public:
   /**
    * Constructor.  Task projection is updated after first call to append().
    *
@@ -227,10 +244,6 @@ public:
                  const unsigned max_time = null_time,
                  const unsigned max_size = 1000);
 
-  ~Trace() {
-    clear();
-  }
-
 protected:
   /**
    * Find recent time after which points should not be culled
@@ -244,25 +257,37 @@ protected:
   unsigned GetRecentTime(const unsigned t) const;
 
   /**
-   * Update delta values for specified item in the delta list and the
-   * tree.  This repositions the item after into its sorted position.
-   *
-   * @param it Item to update
-   * @param tree Tree containing leaf
-   *
-   * @return Iterator to updated item
+   * Function used to points for sorting by deltas.
+   * Ranking is primarily by distance delta; for equal distances, rank by
+   * time delta.
+   * This is like a modified Douglas-Peuker algorithm
    */
-  void UpdateDelta(TraceDelta &td);
+  gcc_pure
+  static bool DeltaRank(const HeapItem &a, const HeapItem &b);
+
+  void HeapSwap(unsigned a, unsigned b);
+  void HeapSiftUp(unsigned i);
+  void HeapSiftDown(unsigned i);
 
   /**
-   * Erase a non-edge item from delta list and tree, updating
-   * deltas in the process.  This Invalidates the calling iterator.
-   *
-   * @param it Item to erase
-   * @param tree Tree to remove from
+   * Remove the top of the heap.
    *
+   * @return the index of the point which was removed from the heap
+   */
+  unsigned HeapPop();
+
+  /**
+   * Update delta values for the specified non-edge item after one of
+   * its neighbours has been erased, and reposition it in the heap.
+   * Its #TraceDelta::delta_distance must be up to date.
+   */
+  void UpdateDelta(unsigned i);
+
+  /**
+   * Erase a non-edge item, updating the deltas of its neighbours.
+   * Must be called during EraseDelta() only.
    */
-  void EraseInside(DeltaList::iterator it);
+  void EraseInside(unsigned i);
 
   /**
    * Erase elements based on delta metric until the size is
@@ -273,7 +298,6 @@ protected:
    * fail to set the target size.
    *
    * @param target_size Size of desired list.
-   * @param tree Tree to remove from
    * @param recent Time window for which to not remove points
    *
    * @return True if items were erased
@@ -282,11 +306,10 @@ protected:
                   const unsigned recent = 0);
 
   /**
-   * Erase elements older than specified time from delta and tree,
+   * Erase elements older than specified time,
    * and update earliest item to become the new start
    *
    * @param p_time Time to remove
-   * @param tree Tree to remove from
    *
    * @return True if items were erased
    */
@@ -299,9 +322,10 @@ protected:
   void EraseLaterThan(const unsigned min_time);
 
   /**
-   * Update start node (and neighbour) after min time pruning
+   * Move the remaining points to the beginning of the arrays.  This
+   * invalidates pointers.
    */
-  void EraseStart(TraceDelta &td_start);
+  void Compact();
 
 public:
   /**
@@ -336,7 +360,7 @@ public:
    * @return Number of traces in tree
    */
   unsigned size() const {
-    return cached_size;
+    return tail - head;
   }
 
   /**
@@ -345,7 +369,7 @@ public:
    * @return True if no traces stored
    */
   bool empty() const {
-    return cached_size == 0;
+    return tail == head;
   }
 
   /**
@@ -390,6 +414,29 @@ public:
    */
   bool SyncPoints(TracePointerVector &v) const;
 
+  /**
+   * Returns the id of the given point.  Each point gets a unique id
+   * when it is appended, and the ids increase along the trace.
+   * Unlike pointers and indexes, ids survive thinning and clearing.
+   */
+  gcc_pure
+  unsigned GetPointId(const_iterator i) const {
+    assert(i >= begin() && i < end());
+
+    return deltas[i - points.begin()].id;
+  }
+
+  /**
+   * Retrieve the ids of all points, sorted by time.
+   */
+  void GetPointIds(std::vector<unsigned> &ids) const;
+
+  /**
+   * Compare a copy of this trace, identified by the ids of its points
+   * (see GetPointIds()), with the current contents.
+   */
+  void GetChanges(const std::vector<unsigned> &ids, Changes &changes) const;
+
   /**
    * Fill the vector with trace points, not before #min_time, minimum
    * resolution #min_distance.
@@ -400,13 +447,13 @@ public:
   const TracePoint &front() const {
     assert(!empty());
 
-    return chronological_list.front().point;
+    return points[head];
   }
 
   const TracePoint &back() const {
     assert(!empty());
 
-    return chronological_list.back().point;
+    return points[tail - 1];
   }
 
 private:
@@ -433,18 +480,6 @@ private:
    */
   void Thin();
 
-  TraceDelta &GetFront() {
-    assert(!empty());
-
-    return chronological_list.front();
-  }
-
-  TraceDelta &GetBack() {
-    assert(!empty());
-
-    return chronological_list.back();
-  }
-
   gcc_pure
   unsigned CalcAverageDeltaDistance(const unsigned no_thin) const;
 
@@ -452,6 +487,7 @@ private:
   unsigned CalcAverageDeltaTime(const unsigned no_thin) const;
 
   static constexpr unsigned null_delta = 0 - 1;
+  static constexpr unsigned NOT_IN_HEAP = 0 - 1;
 
 public:
   static constexpr unsigned null_time = 0 - 1;
@@ -465,53 +501,12 @@ public:
   }
 
 public:
-  class const_iterator : public ChronologicalList::const_iterator {
-    friend class Trace;
-
-    const_iterator(ChronologicalList::const_iterator &&_iterator)
-      :ChronologicalList::const_iterator(std::move(_iterator)) {}
-
-  public:
-    using ChronologicalList::const_iterator::iterator_category;
-    using ChronologicalList::const_iterator::difference_type;
-    typedef const TracePoint value_type;
-    typedef const TracePoint *pointer;
-    typedef const TracePoint &reference;
-
-    const_iterator() = default;
-
-    const TracePoint &operator*() const {
-      const TraceDelta &td = ChronologicalList::const_iterator::operator*();
-      return td.point;
-    }
-
-    const TracePoint *operator->() const {
-      const TraceDelta &td = ChronologicalList::const_iterator::operator*();
-      return &td.point;
-    }
-
-    const_iterator &NextSquareRange(unsigned sq_resolution,
-                                    const const_iterator &end) {
-      const TracePoint &previous = **this;
-      while (true) {
-        ++*this;
-
-        if (*this == end)
-          return *this;
-
-        const TraceDelta &td = (const TraceDelta &)**this;
-        if (td.point.FlatSquareDistanceTo(previous) >= sq_resolution)
-          return *this;
-      }
-    }
-  };
-
   const_iterator begin() const {
-    return chronological_list.begin();
+    return points.begin() + head;
   }
 
   const_iterator end() const {
-    return chronological_list.end();
+    return points.begin() + tail;
   }
 
   const TaskProjection &GetProjection() const {
@@ -58,6 +58,42 @@ isLeft( const FlatGeoPoint &P0, const FlatGeoPoint &P1, const FlatGeoPoint &P2 )
   return 0;
 }
 
+// Winding(): the contribution of the edge P0-P1 to the winding
+//    number of P2
+
+inline static int
+Winding(const GeoPoint &P0, const GeoPoint &P1, const GeoPoint &P2)
+{
+  // edge from current to next
+  if (P0.latitude <= P2.latitude) {
+    // start y <= P.latitude
+
+    if (P1.latitude > P2.latitude)
+      // an upward crossing
+      if (isLeft(P0, P1, P2) > 0)
+        // P left of edge
+        // have a valid up intersect
+        return 1;
+  } else {
+    // start y > P.latitude (no test needed)
+
+    if (P1.latitude <= P2.latitude)
+      // a downward crossing
+      if (isLeft(P0, P1, P2) < 0)
+        // P right of edge
+        // have a valid down intersect
+        return -1;
+  }
+
+  return 0;
+}
+
+int
+PolygonWinding(const GeoPoint &p, const GeoPoint &a, const GeoPoint &b)
+{
+  return Winding(a, b, p);
+}
+
 //===================================================================
 
 // PolygonInterior(): winding number interior test for a point in a polygon
@@ -77,28 +113,9 @@ PolygonInterior(const GeoPoint &P,
 
   // loop through all edges of the polygon
   for (auto i = begin, next = std::next(i); next != end;
-       i = next, next = std::next(i)) {
-    // edge from current to next
-    if (i->GetLocation().latitude <= P.latitude) {
-      // start y <= P.latitude
+       i = next, next = std::next(i))
+    wn += Winding(i->GetLocation(), next->GetLocation(), P);
 
-      if (next->GetLocation().latitude > P.latitude)
-        // an upward crossing
-        if (isLeft(i->GetLocation(), next->GetLocation(), P) > 0)
-          // P left of edge
-          // have a valid up intersect
-          ++wn;
-    } else {
-      // start y > P.latitude (no test needed)
-
-      if (next->GetLocation().latitude <= P.latitude)
-        // a downward crossing
-        if (isLeft(i->GetLocation(), next->GetLocation(), P) < 0)
-          // P right of edge
-          // have a valid down intersect
-          --wn;
-    }
-  }
   return wn != 0;
 }
 
@@ -43,4 +43,13 @@ PolygonInterior(const FlatGeoPoint &p,
                 SearchPointVector::const_iterator begin,
                 SearchPointVector::const_iterator end);
 
+/**
+ * Returns the contribution of the edge from a to b to the winding
+ * number of p, as calculated by PolygonInterior(): 1 for an upward
+ * crossing with p on its left, -1 for a downward crossing with p on
+ * its right, 0 otherwise.
+ */
+gcc_pure int
+PolygonWinding(const GeoPoint &p, const GeoPoint &a, const GeoPoint &b);
+
 #endif
@@ -129,3 +129,12 @@ FlatBoundingBox::IsInside(const FlatGeoPoint& loc) const
 
   return true;
 }
+
+bool
+FlatBoundingBox::Contains(const FlatBoundingBox &other) const
+{
+  return other.bb_ll.longitude >= bb_ll.longitude &&
+    other.bb_ur.longitude <= bb_ur.longitude &&
+    other.bb_ll.latitude >= bb_ll.latitude &&
+    other.bb_ur.latitude <= bb_ur.latitude;
+}
@@ -94,6 +94,16 @@ public:
   gcc_pure
   bool IsInside(const FlatGeoPoint& loc) const;
 
+  /**
+   * Test whether another bounding box lies completely inside this one
+   *
+   * @param other Box to test
+   *
+   * @return true if other is enclosed by this bounding box
+   */
+  gcc_pure
+  bool Contains(const FlatBoundingBox &other) const;
+
   /**
    * Test ray-box intersection
    *
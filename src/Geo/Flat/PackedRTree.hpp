@@ -0,0 +1,294 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+ */
+
+#ifndef XCSOAR_PACKED_RTREE_HPP
+#define XCSOAR_PACKED_RTREE_HPP
+
+#include "FlatBoundingBox.hpp"
+#include "Compiler.h"
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+
+#include <assert.h>
+#include <stdint.h>
+
+/**
+ * An immutable R-tree which is bulk-loaded from a list of objects
+ * derived from #FlatBoundingBox.  The objects are sorted along a
+ * Hilbert curve, and each node covers #NODE_SIZE consecutive entries
+ * of the level below, so the whole tree lives in two contiguous
+ * arrays and a query does not allocate memory.
+ *
+ * To modify the tree, copy its contents and Load() it again.
+ */
+template<typename T>
+class PackedRTree {
+public:
+  static constexpr unsigned NODE_SIZE = 16;
+
+  typedef typename std::vector<T>::const_iterator const_iterator;
+
+private:
+  /**
+   * Enough levels for any number of objects which fits into an
+   * "unsigned".
+   */
+  static constexpr unsigned MAX_LEVELS = 8;
+
+  /**
+   * The objects in Hilbert order; these are the leaves.
+   */
+  std::vector<T> items;
+
+  /**
+   * The bounding boxes of all inner nodes, the lowest level first.
+   * The root is the last element.
+   */
+  std::vector<FlatBoundingBox> nodes;
+
+  /**
+   * The number of inner node levels; 0 if the tree is empty.
+   */
+  unsigned n_levels;
+
+  /**
+   * Level k (1 <= k <= #n_levels) occupies the range
+   * [level_begin[k - 1], level_begin[k]) of #nodes.
+   */
+  unsigned level_begin[MAX_LEVELS + 1];
+
+public:
+  PackedRTree():n_levels(0) {}
+
+  gcc_pure
+  bool empty() const {
+    return items.empty();
+  }
+
+  gcc_pure
+  size_t size() const {
+    return items.size();
+  }
+
+  const_iterator begin() const {
+    return items.begin();
+  }
+
+  const_iterator end() const {
+    return items.end();
+  }
+
+  void clear() {
+    items.clear();
+    nodes.clear();
+    n_levels = 0;
+  }
+
+  /**
+   * Replace the contents of this tree with the given objects and
+   * build the index.
+   */
+  void Load(std::vector<T> &&_items) {
+    items.clear();
+    nodes.clear();
+    n_levels = 0;
+
+    if (_items.empty())
+      return;
+
+    SortHilbert(_items);
+
+    /* each pass builds one level over the level below, until only
+       the root is left */
+    unsigned n = items.size();
+    level_begin[0] = 0;
+    do {
+      assert(n_levels < MAX_LEVELS);
+
+      const unsigned n_nodes = (n + NODE_SIZE - 1) / NODE_SIZE;
+      for (unsigned i = 0; i < n_nodes; ++i) {
+        const unsigned first = i * NODE_SIZE;
+        const unsigned last = std::min(first + NODE_SIZE, n);
+
+        FlatBoundingBox box = GetChildBox(n_levels, first);
+        for (unsigned j = first + 1; j < last; ++j)
+          box.Merge(GetChildBox(n_levels, j));
+
+        nodes.push_back(box);
+      }
+
+      level_begin[++n_levels] = nodes.size();
+      n = n_nodes;
+    } while (n > 1);
+  }
+
+  /**
+   * Invoke the visitor on all objects whose bounding box overlaps
+   * the given one (touching counts as overlapping).
+   */
+  template<typename V>
+  void VisitOverlapping(const FlatBoundingBox &box, V &&visitor) const {
+    if (n_levels == 0)
+      return;
+
+    struct StackItem {
+      unsigned level, index;
+    };
+
+    /* each level pushes at most NODE_SIZE nodes, and one of them is
+       popped before the next level is pushed */
+    StackItem stack[MAX_LEVELS * NODE_SIZE];
+    unsigned stack_size = 0;
+
+    if (!nodes.back().Overlaps(box))
+      return;
+
+    stack[stack_size++] = { n_levels, 0 };
+
+    while (stack_size > 0) {
+      const StackItem item = stack[--stack_size];
+      const unsigned child_level = item.level - 1;
+      const unsigned first = item.index * NODE_SIZE;
+      const unsigned last = std::min(first + NODE_SIZE,
+                                     GetLevelSize(child_level));
+
+      if (child_level == 0) {
+        for (unsigned i = first; i < last; ++i)
+          if (items[i].Overlaps(box))
+            visitor(items[i]);
+      } else {
+        /* push in reverse order to visit the children in order */
+        for (unsigned i = last; i-- > first;) {
+          if (GetNode(child_level, i).Overlaps(box)) {
+            assert(stack_size < MAX_LEVELS * NODE_SIZE);
+            stack[stack_size++] = { child_level, i };
+          }
+        }
+      }
+    }
+  }
+
+  /**
+   * Returns the number of bytes allocated by this object.
+   */
+  gcc_pure
+  size_t GetMemoryUsage() const {
+    return items.capacity() * sizeof(T) +
+      nodes.capacity() * sizeof(FlatBoundingBox);
+  }
+
+private:
+  gcc_pure
+  unsigned GetLevelSize(unsigned level) const {
+    return level == 0
+      ? items.size()
+      : level_begin[level] - level_begin[level - 1];
+  }
+
+  gcc_pure
+  const FlatBoundingBox &GetNode(unsigned level, unsigned index) const {
+    assert(level > 0 && level <= n_levels);
+
+    return nodes[level_begin[level - 1] + index];
+  }
+
+  gcc_pure
+  const FlatBoundingBox &GetChildBox(unsigned level, unsigned index) const {
+    if (level == 0)
+      return items[index];
+
+    return GetNode(level, index);
+  }
+
+  /**
+   * Calculate the position of a point on a Hilbert curve which fills
+   * a 2^16 x 2^16 grid.
+   */
+  gcc_const
+  static uint32_t HilbertIndex(unsigned x, unsigned y) {
+    constexpr unsigned n = 1u << 16;
+
+    uint32_t d = 0;
+    for (unsigned s = n / 2; s > 0; s /= 2) {
+      const unsigned rx = (x & s) > 0;
+      const unsigned ry = (y & s) > 0;
+      d += uint32_t(s) * s * ((3 * rx) ^ ry);
+
+      /* rotate the quadrant */
+      if (ry == 0) {
+        if (rx == 1) {
+          x = n - 1 - x;
+          y = n - 1 - y;
+        }
+
+        std::swap(x, y);
+      }
+    }
+
+    return d;
+  }
+
+  /**
+   * Move the objects to #items, sorted by the Hilbert index of
+   * their centers.
+   */
+  void SortHilbert(std::vector<T> &src) {
+    FlatBoundingBox bounds = src.front();
+    for (const auto &i : src)
+      bounds.Merge(i);
+
+    /* use 64 bit arithmetic; the flat coordinates may span more
+       than 2^31 */
+    const int64_t x0 = bounds.GetLowerLeft().longitude;
+    const int64_t y0 = bounds.GetLowerLeft().latitude;
+    const int64_t width = int64_t(bounds.GetUpperRight().longitude) - x0 + 1;
+    const int64_t height = int64_t(bounds.GetUpperRight().latitude) - y0 + 1;
+
+    std::vector<std::pair<uint32_t, unsigned>> keys;
+    keys.reserve(src.size());
+    for (unsigned i = 0; i < src.size(); ++i) {
+      const FlatBoundingBox &box = src[i];
+      /* twice the center, to avoid rounding */
+      const int64_t cx = int64_t(box.GetLowerLeft().longitude) +
+        box.GetUpperRight().longitude - 2 * x0;
+      const int64_t cy = int64_t(box.GetLowerLeft().latitude) +
+        box.GetUpperRight().latitude - 2 * y0;
+
+      keys.emplace_back(HilbertIndex(unsigned(cx * 32768 / width),
+                                     unsigned(cy * 32768 / height)),
+                        i);
+    }
+
+    /* the index breaks ties, which makes the order deterministic */
+    std::sort(keys.begin(), keys.end());
+
+    items.reserve(src.size());
+    for (const auto &key : keys)
+      items.push_back(std::move(src[key.second]));
+
+    src.clear();
+  }
+};
+
+#endif
@@ -0,0 +1,97 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+ */
+
+#include "PolygonBandIndex.hpp"
+#include "ConvexHull/PolygonInterior.hpp"
+
+void
+PolygonBandIndex::Build(const SearchPointVector &polygon)
+{
+  Clear();
+
+  if (polygon.size() < MIN_EDGES + 1)
+    return;
+
+  const unsigned n_edges = polygon.size() - 1;
+
+  latitude_min = latitude_max = polygon.front().GetLocation().latitude;
+  for (const auto &i : polygon) {
+    latitude_min = std::min(latitude_min, i.GetLocation().latitude);
+    latitude_max = std::max(latitude_max, i.GetLocation().latitude);
+  }
+
+  const unsigned n_bands = n_edges / EDGES_PER_BAND;
+  band_height = (latitude_max - latitude_min).Native() / n_bands;
+  if (!positive(band_height))
+    /* degenerate polygon */
+    return;
+
+  band_start.assign(n_bands + 1, 0);
+
+  /* count the edges per band, then fill the bands in edge order */
+
+  for (unsigned i = 0; i < n_edges; ++i) {
+    const Angle a = polygon[i].GetLocation().latitude;
+    const Angle b = polygon[i + 1].GetLocation().latitude;
+    const unsigned last = GetBand(std::max(a, b));
+    for (unsigned band = GetBand(std::min(a, b)); band <= last; ++band)
+      ++band_start[band + 1];
+  }
+
+  for (unsigned band = 0; band < n_bands; ++band)
+    band_start[band + 1] += band_start[band];
+
+  edges.resize(band_start.back());
+
+  std::vector<unsigned> fill(band_start.begin(), band_start.end() - 1);
+  for (unsigned i = 0; i < n_edges; ++i) {
+    const Angle a = polygon[i].GetLocation().latitude;
+    const Angle b = polygon[i + 1].GetLocation().latitude;
+    const unsigned last = GetBand(std::max(a, b));
+    for (unsigned band = GetBand(std::min(a, b)); band <= last; ++band)
+      edges[fill[band]++] = i;
+  }
+}
+
+bool
+PolygonBandIndex::IsInside(const SearchPointVector &polygon,
+                           const GeoPoint &p) const
+{
+  assert(IsDefined());
+
+  /* no edge can cross the latitude of a point outside of this
+     range */
+  if (p.latitude < latitude_min || p.latitude > latitude_max)
+    return false;
+
+  const unsigned band = GetBand(p.latitude);
+
+  int wn = 0;
+  for (unsigned j = band_start[band], end = band_start[band + 1];
+       j < end; ++j) {
+    const unsigned i = edges[j];
+    wn += PolygonWinding(p, polygon[i].GetLocation(),
+                         polygon[i + 1].GetLocation());
+  }
+
+  return wn != 0;
+}
@@ -0,0 +1,160 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+ */
+
+#ifndef XCSOAR_POLYGON_BAND_INDEX_HPP
+#define XCSOAR_POLYGON_BAND_INDEX_HPP
+
+#include "SearchPointVector.hpp"
+#include "Math/Angle.hpp"
+#include "Compiler.h"
+
+#include <vector>
+#include <algorithm>
+
+#include <assert.h>
+
+/**
+ * Splits the latitude range of a closed polygon into bands of equal
+ * height, and remembers which edges overlap each band.  Edge i is
+ * the edge from point i to point i+1.
+ *
+ * A point-in-polygon test only needs the edges which overlap the
+ * point's latitude, and a line can only cross edges which overlap
+ * its latitude range, so both are sub-linear for polygons with many
+ * points.
+ *
+ * The index does not keep a reference to the polygon; the caller
+ * passes it to each query, and must rebuild the index when it
+ * changes.  Queries are const and may run concurrently.
+ */
+class PolygonBandIndex {
+  /**
+   * Polygons with fewer edges are not indexed.
+   */
+  static constexpr unsigned MIN_EDGES = 32;
+
+  /**
+   * The average number of edges per band.
+   */
+  static constexpr unsigned EDGES_PER_BAND = 2;
+
+  Angle latitude_min, latitude_max;
+
+  /**
+   * The height of one band in radians.
+   */
+  fixed band_height;
+
+  /**
+   * Band b lists the edges [band_start[b], band_start[b+1]) of
+   * #edges, in ascending order.  Empty if the index is not defined.
+   */
+  std::vector<unsigned> band_start;
+  std::vector<unsigned> edges;
+
+public:
+  /**
+   * Build the index over the given closed polygon.  Small polygons
+   * are not indexed; IsDefined() returns false then.
+   */
+  void Build(const SearchPointVector &polygon);
+
+  void Clear() {
+    band_start.clear();
+    edges.clear();
+  }
+
+  bool IsDefined() const {
+    return !band_start.empty();
+  }
+
+  /**
+   * Equivalent to SearchPointVector::IsInside(), but only looks at
+   * the edges in the band of the given point.
+   */
+  gcc_pure
+  bool IsInside(const SearchPointVector &polygon, const GeoPoint &p) const;
+
+  /**
+   * Invoke the visitor with the index of each edge which overlaps
+   * the given latitude range, in ascending order per band.  Each
+   * edge is visited once.
+   */
+  template<typename V>
+  void VisitEdges(const SearchPointVector &polygon,
+                  Angle min, Angle max, V &&visitor) const {
+    assert(IsDefined());
+
+    if (max < latitude_min || min > latitude_max)
+      return;
+
+    const unsigned first = GetBand(min), last = GetBand(max);
+    for (unsigned b = first; b <= last; ++b) {
+      for (unsigned j = band_start[b], end = band_start[b + 1];
+           j < end; ++j) {
+        const unsigned i = edges[j];
+
+        /* an edge spanning several bands was already visited in
+           the band of its lower end */
+        if (b > first && GetBand(GetEdgeMinimum(polygon, i)) < b)
+          continue;
+
+        visitor(i);
+      }
+    }
+  }
+
+  /**
+   * Returns the number of bytes allocated by this object.
+   */
+  gcc_pure
+  size_t GetMemoryUsage() const {
+    return (band_start.capacity() + edges.capacity()) * sizeof(unsigned);
+  }
+
+private:
+  gcc_pure
+  unsigned GetBandCount() const {
+    return band_start.size() - 1;
+  }
+
+  /**
+   * Returns the band of the given latitude, clipped to the valid
+   * range.
+   */
+  gcc_pure
+  unsigned GetBand(Angle latitude) const {
+    const fixed offset = (latitude - latitude_min).Native() / band_height;
+    if (!positive(offset))
+      return 0;
+
+    return std::min(unsigned(offset), GetBandCount() - 1);
+  }
+
+  gcc_pure
+  static Angle GetEdgeMinimum(const SearchPointVector &polygon, unsigned i) {
+    return std::min(polygon[i].GetLocation().latitude,
+                    polygon[i + 1].GetLocation().latitude);
+  }
+};
+
+#endif
@@ -129,7 +129,7 @@ FileCache::~FileCache() {
   free(cache_path);
 }
 
-inline size_t
+size_t
 FileCache::PathBufferSize(const TCHAR *name) const
 {
   return cache_path_length + _tcslen(name) + 2;
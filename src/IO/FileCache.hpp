@@ -35,11 +35,18 @@ public:
   FileCache(const TCHAR *_cache_path);
   ~FileCache();
 
-protected:
+  /**
+   * Returns the size of the buffer (in characters) required for
+   * MakeCachePath().
+   */
   size_t PathBufferSize(const TCHAR *name) const;
+
+  /**
+   * Build the absolute path of the specified cache file, e.g. for
+   * mapping it into memory after Load() has verified it.
+   */
   const TCHAR *MakeCachePath(TCHAR *buffer, const TCHAR *name) const;
 
-public:
   void Flush(const TCHAR *name);
   FILE *Load(const TCHAR *name, const TCHAR *original_path);
 
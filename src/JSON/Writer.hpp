@@ -36,6 +36,13 @@ namespace JSON {
     writer.Write("null");
   }
 
+  /**
+   * Writer for a JSON boolean value.
+   */
+  static inline void WriteBool(TextWriter &writer, bool value) {
+    writer.Write(value ? "true" : "false");
+  }
+
   /**
    * Writer for a JSON integer value.
    */
@@ -28,6 +28,11 @@ Copyright_License {
 #include "Terrain/RasterWeatherCache.hpp"
 #include "Computer/GlideComputer.hpp"
 #include "Operation/Operation.hpp"
+#include "Task/ProtectedTaskManager.hpp"
+#include "Engine/Task/Ordered/OrderedTask.hpp"
+#include "Engine/Task/Ordered/Points/OrderedTaskPoint.hpp"
+#include "Geo/Math.hpp"
+#include "Util/StaticArray.hpp"
 
 #ifdef ENABLE_OPENGL
 #include "Screen/OpenGL/Scissor.hpp"
@@ -134,6 +139,75 @@ MapWindow::UpdateTopography(unsigned max_update)
     return 0;
 }
 
+/**
+ * How far ahead (in seconds) along the current track shall terrain be
+ * loaded?
+ */
+static constexpr unsigned TERRAIN_PREFETCH_TIME = 300;
+
+typedef StaticArray<GeoPoint, 32> TerrainPrefetchList;
+
+/**
+ * Add points with the given spacing on the straight line from #start
+ * to #end (excluding #start).
+ */
+static void
+AddTerrainPrefetchLeg(TerrainPrefetchList &list,
+                      const GeoPoint &start, const GeoPoint &end,
+                      fixed spacing)
+{
+  const fixed distance = start.Distance(end);
+  for (fixed d = spacing; d < distance && !list.full(); d += spacing)
+    list.append(start.IntermediatePoint(end, d));
+
+  if (!list.full())
+    list.append(end);
+}
+
+/**
+ * Predict where terrain will be needed soon: along the current track
+ * and along the remaining legs of the active task.
+ */
+static void
+PredictTerrainPrefetch(TerrainPrefetchList &list,
+                       const MoreData &basic, const DerivedInfo &calculated,
+                       const ProtectedTaskManager *task, fixed spacing)
+{
+  if (!basic.location_available || !positive(spacing))
+    return;
+
+  if (basic.track_available && basic.ground_speed_available &&
+      basic.ground_speed > fixed(10) && !calculated.circling) {
+    const fixed distance = basic.ground_speed * fixed(TERRAIN_PREFETCH_TIME);
+    for (fixed d = spacing; d <= distance && list.size() < list.capacity() / 2;
+         d += spacing)
+      list.append(FindLatitudeLongitude(basic.location, basic.track, d));
+  }
+
+  if (task == nullptr)
+    return;
+
+  ProtectedTaskManager::Lease task_manager(*task);
+  const TaskWaypoint *active = task_manager->GetActiveTaskPoint();
+  if (active == nullptr)
+    return;
+
+  GeoPoint previous = basic.location;
+  AddTerrainPrefetchLeg(list, previous, active->GetLocation(), spacing);
+  previous = active->GetLocation();
+
+  if (task_manager->GetMode() != TaskType::ORDERED)
+    return;
+
+  const OrderedTask &ordered = task_manager->GetOrderedTask();
+  for (unsigned i = task_manager->GetActiveTaskPointIndex() + 1;
+       i < ordered.TaskSize() && !list.full(); ++i) {
+    const GeoPoint &location = ordered.GetTaskPoint(i).GetLocation();
+    AddTerrainPrefetchLeg(list, previous, location, spacing);
+    previous = location;
+  }
+}
+
 bool
 MapWindow::UpdateTerrain()
 {
@@ -148,8 +222,12 @@ MapWindow::UpdateTerrain()
 
   // always service terrain even if it's not used by the map,
   // because it's used by other calculations
+  TerrainPrefetchList prefetch;
+  PredictTerrainPrefetch(prefetch, Basic(), Calculated(), task, radius);
+
   RasterTerrain::ExclusiveLease lease(*terrain);
-  lease->SetViewCenter(location, radius);
+  lease->SetViewCenter(location, radius,
+                       {prefetch.begin(), prefetch.size()});
   if (lease->IsDirty())
     terrain_radius = fixed(0);
   else {
@@ -0,0 +1,84 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "SolverThread.hpp"
+#include "Computer/GlideComputer.hpp"
+#include "Hardware/CPU.hpp"
+
+SolverThread::SolverThread(GlideComputer &_glide_computer)
+  :WorkerThread("SolverThread", 450, 100),
+   contest_stats_modified(false),
+   glide_computer(_glide_computer)
+{
+  contest_stats.Reset();
+}
+
+void
+SolverThread::Submit(const MoreData &_basic, const DerivedInfo &_calculated,
+                     const ComputerSettings &_settings_computer)
+{
+  {
+    ScopeLock protect(mutex);
+    basic = _basic;
+    calculated = _calculated;
+    settings_computer = _settings_computer;
+  }
+
+  Trigger();
+}
+
+bool
+SolverThread::ReadContestStatistics(ContestStatistics &dest)
+{
+  ScopeLock protect(mutex);
+  if (!contest_stats_modified)
+    return false;
+
+  dest = contest_stats;
+  contest_stats_modified = false;
+  return true;
+}
+
+void
+SolverThread::Tick()
+{
+#ifdef HAVE_CPU_FREQUENCY
+  const ScopeLockCPU cpu;
+#endif
+
+  {
+    ScopeLock protect(mutex);
+    solver_basic = basic;
+    solver_calculated = calculated;
+    solver_settings = settings_computer;
+  }
+
+  glide_computer.ProcessSolvers(solver_basic, solver_calculated,
+                                solver_settings);
+
+  {
+    ScopeLock protect(mutex);
+    contest_stats = solver_calculated.contest_stats;
+    contest_stats_modified = true;
+  }
+}
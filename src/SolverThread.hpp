@@ -0,0 +1,102 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_SOLVER_THREAD_HPP
+#define XCSOAR_SOLVER_THREAD_HPP
+
+#include "Thread/WorkerThread.hpp"
+#include "Thread/Mutex.hpp"
+#include "NMEA/MoreData.hpp"
+#include "NMEA/Derived.hpp"
+#include "Computer/Settings.hpp"
+
+class GlideComputer;
+
+/**
+ * The SolverThread runs the slow calculations of the #GlideComputer
+ * (contest solvers, task optimisation) on snapshots of the
+ * blackboard.  This way, a long solver run cannot delay the
+ * processing of the next GPS fix in the #CalculationThread.
+ */
+class SolverThread final : public WorkerThread {
+  /**
+   * This mutex protects the snapshot submitted by the
+   * #CalculationThread and the results.
+   */
+  mutable Mutex mutex;
+
+  MoreData basic;
+  DerivedInfo calculated;
+  ComputerSettings settings_computer;
+
+  /**
+   * Private copies of the snapshot, used by Tick() without holding
+   * the mutex.
+   */
+  MoreData solver_basic;
+  DerivedInfo solver_calculated;
+  ComputerSettings solver_settings;
+
+  /**
+   * The latest contest results, to be picked up by the
+   * #CalculationThread.
+   */
+  ContestStatistics contest_stats;
+
+  /**
+   * Was #contest_stats modified since the last
+   * ReadContestStatistics() call?
+   */
+  bool contest_stats_modified;
+
+  GlideComputer &glide_computer;
+
+public:
+  SolverThread(GlideComputer &_glide_computer);
+
+  bool Start(bool suspended=false) {
+    if (!WorkerThread::Start(suspended))
+      return false;
+
+    SetIdlePriority();
+    return true;
+  }
+
+  /**
+   * Submit a new snapshot of the blackboard and wake up the thread.
+   */
+  void Submit(const MoreData &basic, const DerivedInfo &calculated,
+              const ComputerSettings &settings_computer);
+
+  /**
+   * Copy the latest contest results.
+   *
+   * @return false if there are no new results since the last call
+   */
+  bool ReadContestStatistics(ContestStatistics &dest);
+
+protected:
+  void Tick() override;
+};
+
+#endif
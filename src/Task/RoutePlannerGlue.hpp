@@ -35,7 +35,7 @@ class RoutePlannerGlue {
   AirspaceRoute planner;
 
 public:
-  RoutePlannerGlue():terrain(nullptr) {}
+  RoutePlannerGlue():terrain(nullptr), planner(true) {}
 
   void SetTerrain(const RasterTerrain *terrain);
 
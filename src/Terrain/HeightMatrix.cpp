@@ -30,7 +30,11 @@ Copyright_License {
 #include "Projection/WindowProjection.hpp"
 #endif
 
+#include <algorithm>
+
 #include <assert.h>
+#include <stdlib.h>
+#include <string.h>
 
 void
 HeightMatrix::SetSize(size_t _size)
@@ -64,14 +68,45 @@ HeightMatrix::Fill(const RasterMap &map, const GeoBounds &bounds,
                    unsigned width, unsigned height, bool interpolate)
 {
   SetSize(width, height);
+  Fill(map, bounds, 0, 0, width, height, interpolate);
+}
+
+void
+HeightMatrix::Fill(const RasterMap &map, const GeoBounds &bounds,
+                   unsigned left, unsigned top,
+                   unsigned right, unsigned bottom, bool interpolate)
+{
+  assert(left < right && right <= width);
+  assert(top < bottom && bottom <= height);
+
+  /* RasterMap::ScanLine() needs at least two samples; rescanning one
+     more column is cheaper than a special case */
+  if (right - left < 2 && width >= 2) {
+    if (right >= 2)
+      left = right - 2;
+    else
+      right = left + 2;
+  }
+
+  /* the terrain pyramid level must not be coarser than the distance
+     between two rows */
+  const unsigned max_level =
+    map.GetScanLevel(GeoPoint(bounds.GetWest(), bounds.GetNorth()),
+                     GeoPoint(bounds.GetWest(), bounds.GetSouth()),
+                     height);
+
+  const Angle delta_x = bounds.GetWidth() / width;
+  const Angle west = bounds.GetWest() + delta_x * left;
+  const Angle east = bounds.GetWest() + delta_x * right;
+  const unsigned n = right - left;
 
   const Angle delta_y = bounds.GetHeight() / height;
-  Angle latitude = bounds.GetNorth();
-  for (short *p = data.begin(), *const end = p + width * height;
+  Angle latitude = bounds.GetNorth() - delta_y * top;
+  for (short *p = data.begin() + top * width + left,
+         *const end = data.begin() + bottom * width + left;
        p != end; p += width, latitude -= delta_y) {
-    map.ScanLine(GeoPoint(bounds.GetWest(), latitude),
-                 GeoPoint(bounds.GetEast(), latitude),
-                 p, width, interpolate);
+    map.ScanLine(GeoPoint(west, latitude), GeoPoint(east, latitude),
+                 p, n, interpolate, max_level);
   }
 }
 
@@ -87,13 +122,42 @@ HeightMatrix::Fill(const RasterMap &map, const WindowProjection &projection,
   SetSize((screen_width + quantisation_pixels - 1) / quantisation_pixels,
           (screen_height + quantisation_pixels - 1) / quantisation_pixels);
 
+  /* the terrain pyramid level must not be coarser than the distance
+     between two rows */
+  const unsigned max_level =
+    map.GetScanLevel(projection.ScreenToGeo(0, 0),
+                     projection.ScreenToGeo(0, screen_height),
+                     height);
+
   short *p = data.begin();
   for (unsigned y = 0; y < screen_height;
        y += quantisation_pixels, p += width) {
     map.ScanLine(projection.ScreenToGeo(0, y),
                  projection.ScreenToGeo(screen_width, y),
-                 p, width, interpolate);
+                 p, width, interpolate, max_level);
   }
 }
 
 #endif
+
+void
+HeightMatrix::Shift(int dx, int dy)
+{
+  assert(unsigned(abs(dx)) < width);
+  assert(unsigned(abs(dy)) < height);
+
+  const unsigned n_columns = width - abs(dx);
+  const unsigned n_rows = height - abs(dy);
+
+  const short *src = data.begin() + std::max(dy, 0) * width + std::max(dx, 0);
+  short *dest = data.begin() + std::max(-dy, 0) * width + std::max(-dx, 0);
+
+  for (unsigned i = 0; i < n_rows; ++i) {
+    /* dy > 0 moves the contents up (each row is copied from one
+       further down), so walk from the top row downwards; dy < 0
+       moves them down, so walk from the bottom row upwards.  Either
+       way, a source row is read before it gets overwritten */
+    const unsigned y = dy > 0 ? i : n_rows - 1 - i;
+    memmove(dest + y * width, src + y * width, n_columns * sizeof(*src));
+  }
+}
@@ -55,6 +55,16 @@ public:
    */
   void Fill(const RasterMap &map, const GeoBounds &bounds,
             unsigned _width, unsigned _height, bool interpolate);
+
+  /**
+   * Refresh a rectangle of the buffer, keeping its size.  This is
+   * used after Shift() to fill the cells which were exposed.
+   *
+   * @param bounds the geographic bounds of the whole buffer
+   */
+  void Fill(const RasterMap &map, const GeoBounds &bounds,
+            unsigned left, unsigned top, unsigned right, unsigned bottom,
+            bool interpolate);
 #else
   /**
    * @param interpolate true enables interpolation of sub-pixel values
@@ -63,6 +73,13 @@ public:
             unsigned quantisation_pixels, bool interpolate);
 #endif
 
+  /**
+   * Move the contents by the specified number of cells: afterwards,
+   * cell (x,y) contains what was at (x+dx,y+dy) previously.  The
+   * values of the cells which were exposed are undefined.
+   */
+  void Shift(int dx, int dy);
+
   unsigned GetWidth() const {
     return width;
   }
@@ -262,41 +262,130 @@ RasterTileCache::GetFieldDirect(const unsigned px, const unsigned py) const
   return std::make_pair(overview.Get(x_overview, y_overview), false);
 }
 
-SignedRasterLocation
-RasterTileCache::Intersection(const int x0, const int y0,
-                              const int x1, const int y1,
-                              const int h_origin,
-                              const int slope_fact) const
-{
-  SignedRasterLocation location(x0, y0);
-
-  if (!IsInside(location))
-    // origin is outside overall bounds
-    return location;
+/**
+ * The state of one Intersection() search.  This allows the batch
+ * variant to advance many of them alternately.
+ */
+class RasterTileCache::IntersectionWalk {
+  SignedRasterLocation location, destination;
 
   // line algorithm parameters
-  const int dx = abs(x1-x0);
-  const int dy = abs(y1-y0);
-  int err = dx-dy;
-  const int sx = (x0 < x1)? 1: -1;
-  const int sy = (y0 < y1)? 1: -1;
+  int dx, dy, err, sx, sy;
 
   // max number of steps to walk
-  const int max_steps = (dx+dy);
-  // calculate number of fine steps to produce a step on the overview field
+  int max_steps;
 
   // step size at selected refinement level
-  const int refine_step = max_steps >> 5;
+  int refine_step;
 
   // number of steps for update to the fine map
-  const int step_fine = std::max(1, refine_step);
+  int step_fine;
   // number of steps for update to the overview map
-  const int step_coarse = std::max(1<< OVERVIEW_BITS, step_fine);
+  int step_coarse;
 
   // counter for steps to reach next position to be checked on the field.
-  unsigned step_counter = 0;
+  unsigned step_counter;
   // total counter of fine steps
-  int total_steps = 0;
+  int total_steps;
+
+  int h_origin, slope_fact;
+
+  RasterLocation last_clear_location;
+  int last_clear_h;
+
+public:
+  /**
+   * Only valid after a method has returned false.
+   */
+  SignedRasterLocation result;
+
+  /**
+   * @return false if the search has already finished
+   */
+  bool Start(const RasterTileCache &cache,
+             int x0, int y0, int x1, int y1,
+             int _h_origin, int _slope_fact);
+
+  /**
+   * Check the terrain at the current location.
+   *
+   * @return false if the search has finished
+   */
+  bool Sample(const RasterTileCache &cache);
+
+  /**
+   * Walk along the line to the next location to be checked.
+   *
+   * @return false if the search has finished
+   */
+  bool Advance() {
+    /* copy the state to local variables, which allows the compiler
+       to keep them in registers */
+    int _err = err, x = location.x, y = location.y;
+    unsigned counter = step_counter;
+    int steps = total_steps;
+
+    while (counter != 0) {
+      if (steps > max_steps) {
+        // walked past the destination without hitting terrain
+        result = destination;
+        return false;
+      }
+
+      const int e2 = 2*_err;
+      if (e2 > -dy) {
+        _err -= dy;
+        x += sx;
+        if (counter>0)
+          counter--;
+        steps++;
+      }
+      if (e2 < dx) {
+        _err += dx;
+        y += sy;
+        if (counter>0)
+          counter--;
+        steps++;
+      }
+    }
+
+    err = _err;
+    location = SignedRasterLocation(x, y);
+    step_counter = counter;
+    total_steps = steps;
+    return true;
+  }
+};
+
+inline bool
+RasterTileCache::IntersectionWalk::Start(const RasterTileCache &cache,
+                                         const int x0, const int y0,
+                                         const int x1, const int y1,
+                                         const int _h_origin,
+                                         const int _slope_fact)
+{
+  location = SignedRasterLocation(x0, y0);
+  destination = SignedRasterLocation(x1, y1);
+
+  if (!cache.IsInside(location)) {
+    // origin is outside overall bounds
+    result = location;
+    return false;
+  }
+
+  dx = abs(x1-x0);
+  dy = abs(y1-y0);
+  err = dx-dy;
+  sx = (x0 < x1)? 1: -1;
+  sy = (y0 < y1)? 1: -1;
+
+  max_steps = (dx+dy);
+  refine_step = max_steps >> 5;
+  step_fine = std::max(1, refine_step);
+  step_coarse = std::max(1<< OVERVIEW_BITS, step_fine);
+
+  step_counter = 0;
+  total_steps = 0;
 
 #ifdef DEBUG_TILE
   printf("# max steps %d\n", max_steps);
@@ -304,65 +393,128 @@ RasterTileCache::Intersection(const int x0, const int y0,
   printf("# step fine %d\n", step_fine);
 #endif
 
-  RasterLocation last_clear_location = location;
-  int last_clear_h = h_origin;
+  h_origin = _h_origin;
+  slope_fact = _slope_fact;
 
-  while (true) {
+  last_clear_location = location;
+  last_clear_h = h_origin;
+  return true;
+}
 
-    if (!step_counter) {
+inline bool
+RasterTileCache::IntersectionWalk::Sample(const RasterTileCache &cache)
+{
+  assert(step_counter == 0);
 
-      if (!IsInside(location))
-        break; // outside bounds
+  if (!cache.IsInside(location)) {
+    // outside bounds: assume we can hit MSL
+    result = destination;
+    return false;
+  }
 
-      const auto field_direct = GetFieldDirect(location.x, location.y);
-      if (RasterBuffer::IsInvalid(field_direct.first))
-        break;
+  const auto field_direct = cache.GetFieldDirect(location.x, location.y);
+  if (RasterBuffer::IsInvalid(field_direct.first)) {
+    // if we reached invalid terrain, assume we can hit MSL
+    result = destination;
+    return false;
+  }
 
-      const int h_terrain = ReplaceWater0(field_direct.first);
-      step_counter = field_direct.second ? step_fine : step_coarse;
+  const int h_terrain = ReplaceWater0(field_direct.first);
+  step_counter = field_direct.second ? step_fine : step_coarse;
 
-      // calculate height of glide so far
-      const int dh = (total_steps * slope_fact) >> RASTER_SLOPE_FACT;
+  // calculate height of glide so far
+  const int dh = (total_steps * slope_fact) >> RASTER_SLOPE_FACT;
 
-      // current aircraft height
-      const int h_int = h_origin - dh;
+  // current aircraft height
+  const int h_int = h_origin - dh;
 
-      if (h_int < h_terrain) {
-        if (refine_step<3) // can't refine any further
-          return RasterLocation(last_clear_location.x, last_clear_location.y);
+  if (h_int < h_terrain) {
+    if (refine_step<3) { // can't refine any further
+      result = last_clear_location;
+      return false;
+    }
 
-        // refine solution
-        return Intersection(last_clear_location.x, last_clear_location.y,
-                            location.x, location.y, last_clear_h, slope_fact);
-      }
+    // refine solution
+    const SignedRasterLocation clear = last_clear_location;
+    return Start(cache, clear.x, clear.y, location.x, location.y,
+                 last_clear_h, slope_fact);
+  }
+
+  if (h_int <= 0) {
+    // reached max range
+    result = destination;
+    return false;
+  }
 
-      if (h_int <= 0) 
-        break; // reached max range
+  last_clear_location = location;
+  last_clear_h = h_int;
+  return true;
+}
 
-      last_clear_location = location;
-      last_clear_h = h_int;
-    }
+SignedRasterLocation
+RasterTileCache::Intersection(const int x0, const int y0,
+                              const int x1, const int y1,
+                              const int h_origin,
+                              const int slope_fact) const
+{
+  IntersectionWalk walk;
+  if (walk.Start(*this, x0, y0, x1, y1, h_origin, slope_fact))
+    while (walk.Sample(*this) && walk.Advance()) {}
 
-    if (total_steps > max_steps)
-      break;
+  return walk.result;
+}
 
-    const int e2 = 2*err;
-    if (e2 > -dy) {
-      err -= dy;
-      location.x += sx;
-      if (step_counter>0)
-        step_counter--;
-      total_steps++;
+void
+RasterTileCache::Intersection(const int x0, const int y0,
+                              const SignedRasterLocation *destinations,
+                              const int *slope_facts, unsigned n,
+                              const int h_origin,
+                              SignedRasterLocation *results) const
+{
+  static constexpr unsigned CHUNK = 64;
+
+  IntersectionWalk walks[CHUNK];
+  unsigned active[CHUNK];
+
+  for (unsigned offset = 0; offset < n; offset += CHUNK) {
+    const unsigned chunk_size = std::min(n - offset, unsigned(CHUNK));
+
+    unsigned n_active = 0;
+    for (unsigned i = 0; i < chunk_size; ++i) {
+      const SignedRasterLocation d = destinations[offset + i];
+      if (walks[i].Start(*this, x0, y0, d.x, d.y,
+                         h_origin, slope_facts[offset + i]))
+        active[n_active++] = i;
+      else
+        results[offset + i] = walks[i].result;
     }
-    if (e2 < dx) {
-      err += dx;
-      location.y += sy;
-      if (step_counter>0)
-        step_counter--;
-      total_steps++;
+
+    while (n_active > 0) {
+      /* check the terrain of all lines first: these memory accesses
+         do not depend on each other, and the CPU can overlap their
+         latencies */
+      unsigned n_remaining = 0;
+      for (unsigned j = 0; j < n_active; ++j) {
+        const unsigned i = active[j];
+        if (walks[i].Sample(*this))
+          active[n_remaining++] = i;
+        else
+          results[offset + i] = walks[i].result;
+      }
+
+      n_active = n_remaining;
+
+      /* now walk all lines to their next sample */
+      n_remaining = 0;
+      for (unsigned j = 0; j < n_active; ++j) {
+        const unsigned i = active[j];
+        if (walks[i].Advance())
+          active[n_remaining++] = i;
+        else
+          results[offset + i] = walks[i].result;
+      }
+
+      n_active = n_remaining;
     }
   }
-
-  // if we reached invalid terrain, assume we can hit MSL
-  return {x1, y1};
 }
@@ -0,0 +1,175 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TERRAIN_KERNEL_NEON_HPP
+#define XCSOAR_TERRAIN_KERNEL_NEON_HPP
+
+#include "Portable.hpp"
+
+#ifndef __ARM_NEON__
+#error ARM NEON required
+#endif
+
+#include <arm_neon.h>
+
+/**
+ * Implementation of #PortableRasterKernels using ARM NEON
+ * instructions.  All methods process multiples of 8 pixels.
+ *
+ * ARMv7 NEON has neither a square root nor a division instruction,
+ * therefore SlopeValue() is still evaluated with scalar VFP
+ * instructions; everything else is vectorised.
+ */
+class NEONRasterKernels {
+public:
+  gcc_hot gcc_flatten gcc_nonnull_all
+  static void HeightIndices(const short *gcc_restrict src, unsigned n,
+                            unsigned height_scale,
+                            unsigned contour_height_scale,
+                            uint8_t *gcc_restrict color_index,
+                            uint8_t *gcc_restrict contour) {
+    const int16x8_t zero = vdupq_n_s16(0);
+    const int16x8_t max_index = vdupq_n_s16(254);
+
+    /* vshlq_s16() shifts right with negative counts; clamp the count
+       because larger shifts would be undefined */
+    const int16x8_t v_height_scale =
+      vdupq_n_s16(-(int)std::min(height_scale, 15u));
+    const int16x8_t v_contour_height_scale =
+      vdupq_n_s16(-(int)std::min(contour_height_scale, 15u));
+
+    for (unsigned i = 0; i < n; i += 8) {
+      /* "special" values are negative, and thus become zero, just
+         like ContourInterval() returns for them */
+      const int16x8_t h = vmaxq_s16(vld1q_s16(src + i), zero);
+
+      const int16x8_t index =
+        vminq_s16(vshlq_s16(h, v_height_scale), max_index);
+      const int16x8_t interval =
+        vminq_s16(vshlq_s16(h, v_contour_height_scale), max_index);
+
+      vst1_u8(color_index + i, vqmovun_s16(index));
+      vst1_u8(contour + i, vqmovun_s16(interval));
+    }
+  }
+
+  /**
+   * Multiply 4 values with the contrast and divide by 128, rounding
+   * towards zero like the C division operator.
+   */
+  gcc_always_inline
+  static int32x4_t ApplyContrast4(int32x4_t x, int32x4_t contrast) {
+    const int32x4_t product = vmulq_s32(x, contrast);
+    const int32x4_t bias = vandq_s32(vshrq_n_s32(product, 31),
+                                     vdupq_n_s32(127));
+    return vshrq_n_s32(vaddq_s32(product, bias), 7);
+  }
+
+  gcc_hot gcc_flatten gcc_nonnull_all
+  static void Illumination(const short *gcc_restrict src,
+                           unsigned row_minus_offset,
+                           unsigned row_plus_offset,
+                           unsigned column_offset, unsigned p31,
+                           unsigned n, const SlopeShadingParameters &params,
+                           int8_t *gcc_restrict dest) {
+    const unsigned p20 = 2 * column_offset;
+    const unsigned dd2 = p20 * p31 * params.height_slope_factor;
+    const unsigned square_dd2 = dd2 * dd2;
+
+    const int16x8_t special =
+      vdupq_n_s16(RasterBuffer::TERRAIN_WATER_THRESHOLD + 1);
+    const int16x8_t min_delta = vdupq_n_s16(-512);
+    const int16x8_t max_delta = vdupq_n_s16(512);
+    const int16x8_t v_p20 = vdupq_n_s16(p20);
+    const int16x8_t v_p31 = vdupq_n_s16(p31);
+    const int16x4_t v_sx = vdup_n_s16(params.sx);
+    const int16x4_t v_sy = vdup_n_s16(params.sy);
+    const int32x4_t v_num_dd2 = vdupq_n_s32(int(dd2) * params.sz);
+    const int32x4_t v_sz = vdupq_n_s32(params.sz);
+    const int32x4_t v_contrast = vdupq_n_s32(params.contrast);
+    const int16x8_t min_illumination = vdupq_n_s16(-63);
+    const int16x8_t max_illumination = vdupq_n_s16(63);
+    const int8x8_t no_slope = vdup_n_s8(SlopeShadingParameters::NO_SLOPE);
+
+    int32_t num[8], square[8], sval[8];
+
+    for (unsigned i = 0; i < n; i += 8, src += 8) {
+      const int16x8_t h_above = vld1q_s16(src - row_minus_offset);
+      const int16x8_t h_below = vld1q_s16(src + row_plus_offset);
+      const int16x8_t h_left = vld1q_s16(src - column_offset);
+      const int16x8_t h_right = vld1q_s16(src + column_offset);
+
+      const uint16x8_t is_special =
+        vorrq_u16(vorrq_u16(vcltq_s16(h_above, special),
+                            vcltq_s16(h_below, special)),
+                  vorrq_u16(vcltq_s16(h_left, special),
+                            vcltq_s16(h_right, special)));
+
+      /* saturating subtraction, then ClipHeightDelta() */
+      const int16x8_t p32 =
+        vminq_s16(vmaxq_s16(vqsubq_s16(h_above, h_below), min_delta),
+                  max_delta);
+      const int16x8_t p22 =
+        vminq_s16(vmaxq_s16(vqsubq_s16(h_right, h_left), min_delta),
+                  max_delta);
+
+      /* these fit into 16 bit, because quantisation_effective is
+         limited to 25 */
+      const int16x8_t dd0 = vmulq_s16(p22, v_p31);
+      const int16x8_t dd1 = vmulq_s16(p32, v_p20);
+
+      vst1q_s32(num, vmlal_s16(vmlal_s16(v_num_dd2, vget_low_s16(dd0), v_sx),
+                               vget_low_s16(dd1), v_sy));
+      vst1q_s32(num + 4,
+                vmlal_s16(vmlal_s16(v_num_dd2, vget_high_s16(dd0), v_sx),
+                          vget_high_s16(dd1), v_sy));
+
+      vst1q_s32(square, vmlal_s16(vmull_s16(vget_low_s16(dd0),
+                                            vget_low_s16(dd0)),
+                                  vget_low_s16(dd1), vget_low_s16(dd1)));
+      vst1q_s32(square + 4, vmlal_s16(vmull_s16(vget_high_s16(dd0),
+                                                vget_high_s16(dd0)),
+                                      vget_high_s16(dd1),
+                                      vget_high_s16(dd1)));
+
+      for (unsigned j = 0; j < 8; ++j)
+        sval[j] = SlopeValue(num[j], unsigned(square[j]) + square_dd2);
+
+      /* SlopeIllumination() */
+      const int32x4_t sindex_lo =
+        ApplyContrast4(vsubq_s32(vld1q_s32(sval), v_sz), v_contrast);
+      const int32x4_t sindex_hi =
+        ApplyContrast4(vsubq_s32(vld1q_s32(sval + 4), v_sz), v_contrast);
+      const int16x8_t sindex =
+        vminq_s16(vmaxq_s16(vcombine_s16(vqmovn_s32(sindex_lo),
+                                         vqmovn_s32(sindex_hi)),
+                            min_illumination),
+                  max_illumination);
+
+      vst1_s8(dest + i, vbsl_s8(vmovn_u16(is_special), no_slope,
+                                vqmovn_s16(sindex)));
+    }
+  }
+};
+
+#endif
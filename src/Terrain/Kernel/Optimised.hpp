@@ -0,0 +1,97 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TERRAIN_KERNEL_OPTIMISED_HPP
+#define XCSOAR_TERRAIN_KERNEL_OPTIMISED_HPP
+
+#include "Portable.hpp"
+
+#ifdef __SSE2__
+#include "SSE2.hpp"
+#elif defined(__ARM_NEON__)
+#include "NEON.hpp"
+#endif
+
+/**
+ * This class hosts two implementations of the #RasterRenderer inner
+ * loops: one that is optimised (e.g. via SIMD) and one that is
+ * portable (but slow).  The optimised one will be used as much as
+ * possible, and for the odd remainder, we use the portable version.
+ */
+template<typename Optimised, unsigned N, typename Portable>
+class SelectOptimisedRasterKernels {
+public:
+  static constexpr unsigned PORTABLE_MASK = N - 1;
+  static constexpr unsigned OPTIMISED_MASK = ~PORTABLE_MASK;
+
+  gcc_flatten gcc_nonnull_all
+  static void HeightIndices(const short *gcc_restrict src, unsigned n,
+                            unsigned height_scale,
+                            unsigned contour_height_scale,
+                            uint8_t *gcc_restrict color_index,
+                            uint8_t *gcc_restrict contour) {
+    const unsigned no = n & OPTIMISED_MASK;
+    const unsigned np = n & PORTABLE_MASK;
+
+    Optimised::HeightIndices(src, no, height_scale, contour_height_scale,
+                             color_index, contour);
+    Portable::HeightIndices(src + no, np, height_scale, contour_height_scale,
+                            color_index + no, contour + no);
+  }
+
+  gcc_flatten gcc_nonnull_all
+  static void Illumination(const short *gcc_restrict src,
+                           unsigned row_minus_offset,
+                           unsigned row_plus_offset,
+                           unsigned column_offset, unsigned p31,
+                           unsigned n, const SlopeShadingParameters &params,
+                           int8_t *gcc_restrict dest) {
+    const unsigned no = n & OPTIMISED_MASK;
+    const unsigned np = n & PORTABLE_MASK;
+
+    Optimised::Illumination(src, row_minus_offset, row_plus_offset,
+                            column_offset, p31, no, params, dest);
+    Portable::Illumination(src + no, row_minus_offset, row_plus_offset,
+                           column_offset, p31, np, params, dest + no);
+  }
+};
+
+#ifdef __SSE2__
+
+class RasterKernels
+  : public SelectOptimisedRasterKernels<SSE2RasterKernels, 8,
+                                        PortableRasterKernels> {};
+
+#elif defined(__ARM_NEON__)
+
+class RasterKernels
+  : public SelectOptimisedRasterKernels<NEONRasterKernels, 8,
+                                        PortableRasterKernels> {};
+
+#else
+
+class RasterKernels : public PortableRasterKernels {};
+
+#endif
+
+#endif
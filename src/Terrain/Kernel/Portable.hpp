@@ -0,0 +1,207 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TERRAIN_KERNEL_PORTABLE_HPP
+#define XCSOAR_TERRAIN_KERNEL_PORTABLE_HPP
+
+#include "Terrain/RasterBuffer.hpp"
+#include "Math/fixed.hpp"
+#include "Math/FastMath.h"
+#include "Util/Clamp.hpp"
+#include "Compiler.h"
+
+#include <algorithm>
+
+#include <math.h>
+#include <stdint.h>
+
+/**
+ * Parameters for the slope shading kernels.  See
+ * RasterRenderer::GenerateSlopeImage() for details.
+ */
+struct SlopeShadingParameters {
+  /**
+   * Illumination value which means "no slope shading", because a
+   * "special" terrain value (water or invalid) surrounds the pixel.
+   */
+  static constexpr int8_t NO_SLOPE = -128;
+
+  /**
+   * The light source vector.
+   */
+  int sx, sy, sz;
+
+  int contrast;
+
+  unsigned height_slope_factor;
+};
+
+/**
+ * Calculate the contour line interval of the given terrain height.
+ */
+gcc_const
+static inline unsigned
+ContourInterval(const int h, const unsigned contour_height_scale)
+{
+  if (gcc_unlikely(RasterBuffer::IsSpecial(h)) || h <= 0)
+    return 0;
+
+  return std::min(254u, unsigned(h) >> contour_height_scale);
+}
+
+/**
+ * Clip the difference between two adjacent terrain height values to
+ * sane bounds.  This works around integer overflows in the slope
+ * formula when the map file is broken, avoiding the sqrt() call with
+ * a negative argument.
+ */
+gcc_const
+static inline int
+ClipHeightDelta(int d)
+{
+  return Clamp(d, -512, 512);
+}
+
+/**
+ * Divide the dot product of the light source and the surface normal
+ * by the magnitude of the surface normal.
+ */
+gcc_const
+static inline int
+SlopeValue(int num, unsigned square_mag)
+{
+#ifdef FIXED_MATH
+  const unsigned mag = isqrt4(square_mag);
+#else
+  const unsigned mag = (unsigned)sqrt((fixed)square_mag);
+#endif
+  /* this is a workaround for a SIGFPE (division by zero)
+     observed by our users on some Android devices (e.g. Nexus
+     7), even though we did our best to make sure that the
+     integer arithmetics above can't overflow */
+  /* TODO: debug this problem and replace this workaround */
+  return num / int(mag|1);
+}
+
+/**
+ * Scale the slope value with the contrast setting, yielding an
+ * illumination value for the color table.
+ */
+gcc_const
+static inline int
+SlopeIllumination(int sval, int sz, int contrast)
+{
+  const int sindex = (sval - sz) * contrast / 128;
+  return Clamp(sindex, -63, 63);
+}
+
+/**
+ * Calculate the illumination value (-63..63 or
+ * SlopeShadingParameters::NO_SLOPE) of one pixel from the heights of
+ * its four neighbours.
+ *
+ * @param p20 the horizontal distance between the left and the right
+ * neighbour
+ * @param p31 the vertical distance between the upper and the lower
+ * neighbour
+ */
+gcc_pure
+static inline int8_t
+CalculateIllumination(int h_above, int h_below, int h_left, int h_right,
+                      unsigned p20, unsigned p31,
+                      const SlopeShadingParameters &params)
+{
+  if (gcc_unlikely(RasterBuffer::IsSpecial(h_above) ||
+                   RasterBuffer::IsSpecial(h_below) ||
+                   RasterBuffer::IsSpecial(h_left) ||
+                   RasterBuffer::IsSpecial(h_right)))
+    return SlopeShadingParameters::NO_SLOPE;
+
+  const int p32 = ClipHeightDelta(h_above - h_below);
+  const int p22 = ClipHeightDelta(h_right - h_left);
+
+  const int dd0 = p22 * int(p31);
+  const int dd1 = int(p20) * p32;
+  const unsigned dd2 = p20 * p31 * params.height_slope_factor;
+  const int num = (int(dd2) * params.sz + dd0 * params.sx + dd1 * params.sy);
+  const unsigned square_mag = dd0 * dd0 + dd1 * dd1 + dd2 * dd2;
+
+  return SlopeIllumination(SlopeValue(num, square_mag),
+                           params.sz, params.contrast);
+}
+
+/**
+ * Portable implementation of the #RasterRenderer inner loops.  The
+ * SIMD implementations must produce bit-identical results.
+ */
+class PortableRasterKernels {
+public:
+  /**
+   * Calculate the color table index (0..254, without illumination)
+   * and the contour interval of each height value.  The color index
+   * of "special" values is undefined.
+   */
+  gcc_nonnull_all
+  static void HeightIndices(const short *gcc_restrict src, unsigned n,
+                            unsigned height_scale,
+                            unsigned contour_height_scale,
+                            uint8_t *gcc_restrict color_index,
+                            uint8_t *gcc_restrict contour) {
+    for (unsigned i = 0; i < n; ++i) {
+      const int h = std::max(int(src[i]), 0);
+      color_index[i] = std::min(254, h >> height_scale);
+      contour[i] = ContourInterval(src[i], contour_height_scale);
+    }
+  }
+
+  /**
+   * Calculate the illumination value of each pixel in a row, see
+   * CalculateIllumination().  The neighbours of all pixels must be
+   * within the #HeightMatrix.
+   *
+   * @param row_minus_offset the distance to the upper neighbour
+   * @param row_plus_offset the distance to the lower neighbour
+   * @param column_offset the distance to the left and to the right
+   * neighbour
+   * @param p31 the vertical distance between the upper and the lower
+   * neighbour (in rows)
+   */
+  gcc_nonnull_all
+  static void Illumination(const short *gcc_restrict src,
+                           unsigned row_minus_offset,
+                           unsigned row_plus_offset,
+                           unsigned column_offset, unsigned p31,
+                           unsigned n, const SlopeShadingParameters &params,
+                           int8_t *gcc_restrict dest) {
+    const unsigned p20 = 2 * column_offset;
+
+    for (unsigned i = 0; i < n; ++i, ++src)
+      dest[i] = CalculateIllumination(src[-(int)row_minus_offset],
+                                      src[row_plus_offset],
+                                      src[-(int)column_offset],
+                                      src[column_offset],
+                                      p20, p31, params);
+  }
+};
+
+#endif
@@ -0,0 +1,209 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TERRAIN_KERNEL_SSE2_HPP
+#define XCSOAR_TERRAIN_KERNEL_SSE2_HPP
+
+#include "Portable.hpp"
+
+#ifndef __SSE2__
+#error SSE2 required
+#endif
+
+#include <emmintrin.h>
+
+/**
+ * Implementation of #PortableRasterKernels using Intel SSE2
+ * instructions.  All methods process multiples of 8 pixels.
+ */
+class SSE2RasterKernels {
+public:
+  gcc_hot gcc_flatten gcc_nonnull_all
+  static void HeightIndices(const short *gcc_restrict src, unsigned n,
+                            unsigned height_scale,
+                            unsigned contour_height_scale,
+                            uint8_t *gcc_restrict color_index,
+                            uint8_t *gcc_restrict contour) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i max_index = _mm_set1_epi16(254);
+    const __m128i v_height_scale = _mm_cvtsi32_si128(height_scale);
+    const __m128i v_contour_height_scale =
+      _mm_cvtsi32_si128(contour_height_scale);
+
+    for (unsigned i = 0; i < n; i += 8) {
+      /* "special" values are negative, and thus become zero, just
+         like ContourInterval() returns for them */
+      const __m128i h =
+        _mm_max_epi16(_mm_loadu_si128((const __m128i *)(src + i)), zero);
+
+      const __m128i index =
+        _mm_min_epi16(_mm_sra_epi16(h, v_height_scale), max_index);
+      const __m128i interval =
+        _mm_min_epi16(_mm_sra_epi16(h, v_contour_height_scale), max_index);
+
+      _mm_storel_epi64((__m128i *)(color_index + i),
+                       _mm_packus_epi16(index, zero));
+      _mm_storel_epi64((__m128i *)(contour + i),
+                       _mm_packus_epi16(interval, zero));
+    }
+  }
+
+  /**
+   * Calculate SlopeValue() for 4 pixels.  The double precision
+   * square root and division are exact enough to give the same
+   * results as the scalar integer arithmetics.
+   *
+   * @param square the magnitude of the surface normal, without the
+   * (constant) vertical component
+   * @param square_dd2 the square of the vertical component
+   */
+  gcc_always_inline
+  static __m128i SlopeValue4(__m128i num, __m128i square,
+                             __m128d square_dd2) {
+    const __m128d square_lo =
+      _mm_add_pd(_mm_cvtepi32_pd(square), square_dd2);
+    const __m128d square_hi =
+      _mm_add_pd(_mm_cvtepi32_pd(_mm_srli_si128(square, 8)), square_dd2);
+
+    __m128i mag = _mm_unpacklo_epi64(_mm_cvttpd_epi32(_mm_sqrt_pd(square_lo)),
+                                     _mm_cvttpd_epi32(_mm_sqrt_pd(square_hi)));
+    mag = _mm_or_si128(mag, _mm_set1_epi32(1));
+
+    const __m128d sval_lo = _mm_div_pd(_mm_cvtepi32_pd(num),
+                                       _mm_cvtepi32_pd(mag));
+    const __m128d sval_hi =
+      _mm_div_pd(_mm_cvtepi32_pd(_mm_srli_si128(num, 8)),
+                 _mm_cvtepi32_pd(_mm_srli_si128(mag, 8)));
+
+    return _mm_unpacklo_epi64(_mm_cvttpd_epi32(sval_lo),
+                              _mm_cvttpd_epi32(sval_hi));
+  }
+
+  /**
+   * Multiply 4 values with the contrast and divide by 128, rounding
+   * towards zero like the C division operator.
+   *
+   * @param x 16 bit values in the low half of each 32 bit lane
+   */
+  gcc_always_inline
+  static __m128i ApplyContrast4(__m128i x, __m128i contrast) {
+    const __m128i product = _mm_madd_epi16(x, contrast);
+    const __m128i bias = _mm_and_si128(_mm_srai_epi32(product, 31),
+                                       _mm_set1_epi32(127));
+    return _mm_srai_epi32(_mm_add_epi32(product, bias), 7);
+  }
+
+  gcc_hot gcc_flatten gcc_nonnull_all
+  static void Illumination(const short *gcc_restrict src,
+                           unsigned row_minus_offset,
+                           unsigned row_plus_offset,
+                           unsigned column_offset, unsigned p31,
+                           unsigned n, const SlopeShadingParameters &params,
+                           int8_t *gcc_restrict dest) {
+    const unsigned p20 = 2 * column_offset;
+    const unsigned dd2 = p20 * p31 * params.height_slope_factor;
+
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i special = _mm_set1_epi16(RasterBuffer::TERRAIN_WATER_THRESHOLD + 1);
+    const __m128i min_delta = _mm_set1_epi16(-512);
+    const __m128i max_delta = _mm_set1_epi16(512);
+    const __m128i v_p20 = _mm_set1_epi16(p20);
+    const __m128i v_p31 = _mm_set1_epi16(p31);
+    const __m128i v_sxy = _mm_set_epi16(params.sy, params.sx,
+                                        params.sy, params.sx,
+                                        params.sy, params.sx,
+                                        params.sy, params.sx);
+    const __m128i v_num_dd2 = _mm_set1_epi32(int(dd2) * params.sz);
+    const __m128d v_square_dd2 = _mm_set1_pd(double(dd2 * dd2));
+    const __m128i v_sz = _mm_set1_epi32(params.sz);
+    const __m128i v_contrast = _mm_set_epi16(0, params.contrast,
+                                             0, params.contrast,
+                                             0, params.contrast,
+                                             0, params.contrast);
+    const __m128i min_illumination = _mm_set1_epi16(-63);
+    const __m128i max_illumination = _mm_set1_epi16(63);
+    const __m128i no_slope = _mm_set1_epi8(SlopeShadingParameters::NO_SLOPE);
+
+    for (unsigned i = 0; i < n; i += 8, src += 8) {
+      const __m128i h_above =
+        _mm_loadu_si128((const __m128i *)(src - row_minus_offset));
+      const __m128i h_below =
+        _mm_loadu_si128((const __m128i *)(src + row_plus_offset));
+      const __m128i h_left =
+        _mm_loadu_si128((const __m128i *)(src - column_offset));
+      const __m128i h_right =
+        _mm_loadu_si128((const __m128i *)(src + column_offset));
+
+      const __m128i is_special =
+        _mm_or_si128(_mm_or_si128(_mm_cmplt_epi16(h_above, special),
+                                  _mm_cmplt_epi16(h_below, special)),
+                     _mm_or_si128(_mm_cmplt_epi16(h_left, special),
+                                  _mm_cmplt_epi16(h_right, special)));
+
+      /* saturating subtraction, then ClipHeightDelta() */
+      const __m128i p32 =
+        _mm_min_epi16(_mm_max_epi16(_mm_subs_epi16(h_above, h_below),
+                                    min_delta), max_delta);
+      const __m128i p22 =
+        _mm_min_epi16(_mm_max_epi16(_mm_subs_epi16(h_right, h_left),
+                                    min_delta), max_delta);
+
+      /* these fit into 16 bit, because quantisation_effective is
+         limited to 25 */
+      const __m128i dd0 = _mm_mullo_epi16(p22, v_p31);
+      const __m128i dd1 = _mm_mullo_epi16(p32, v_p20);
+
+      const __m128i dd01_lo = _mm_unpacklo_epi16(dd0, dd1);
+      const __m128i dd01_hi = _mm_unpackhi_epi16(dd0, dd1);
+
+      const __m128i num_lo =
+        _mm_add_epi32(_mm_madd_epi16(dd01_lo, v_sxy), v_num_dd2);
+      const __m128i num_hi =
+        _mm_add_epi32(_mm_madd_epi16(dd01_hi, v_sxy), v_num_dd2);
+
+      const __m128i sval_lo =
+        SlopeValue4(num_lo, _mm_madd_epi16(dd01_lo, dd01_lo), v_square_dd2);
+      const __m128i sval_hi =
+        SlopeValue4(num_hi, _mm_madd_epi16(dd01_hi, dd01_hi), v_square_dd2);
+
+      /* SlopeIllumination() */
+      const __m128i x = _mm_packs_epi32(_mm_sub_epi32(sval_lo, v_sz),
+                                        _mm_sub_epi32(sval_hi, v_sz));
+      __m128i sindex =
+        _mm_packs_epi32(ApplyContrast4(_mm_unpacklo_epi16(x, zero),
+                                       v_contrast),
+                        ApplyContrast4(_mm_unpackhi_epi16(x, zero),
+                                       v_contrast));
+      sindex = _mm_min_epi16(_mm_max_epi16(sindex, min_illumination),
+                             max_illumination);
+
+      const __m128i mask = _mm_packs_epi16(is_special, zero);
+      const __m128i result =
+        _mm_or_si128(_mm_andnot_si128(mask, _mm_packs_epi16(sindex, zero)),
+                     _mm_and_si128(mask, no_slope));
+      _mm_storel_epi64((__m128i *)(dest + i), result);
+    }
+  }
+};
+
+#endif
@@ -34,6 +34,47 @@ RasterBuffer::Resize(unsigned _width, unsigned _height)
   assert(_width > 0 && _height > 0);
 
   data.GrowDiscard(_width, _height);
+  base = data.begin();
+  width = _width;
+  height = _height;
+}
+
+void
+RasterBuffer::SetMapped(const short *_data, unsigned _width, unsigned _height)
+{
+  assert(_data != nullptr);
+  assert(_width > 0 && _height > 0);
+
+  data.Reset();
+  base = _data;
+  width = _width;
+  height = _height;
+}
+
+void
+RasterBuffer::Downsample(const RasterBuffer &src)
+{
+  assert(src.IsDefined());
+  assert(&src != this);
+
+  const unsigned src_width = src.GetWidth(), src_height = src.GetHeight();
+  Resize((src_width + 1) / 2, (src_height + 1) / 2);
+
+  short *dest = data.begin();
+  for (unsigned y = 0; y < src_height; y += 2) {
+    const unsigned dy = y + 1 < src_height ? src_width : 0;
+
+    for (unsigned x = 0; x < src_width; x += 2) {
+      const unsigned dx = x + 1 < src_width ? 1 : 0;
+      const short *tm = src.GetDataAt(x, y);
+
+      if (IsSpecial(*tm) || IsSpecial(tm[dx]) ||
+          IsSpecial(tm[dy]) || IsSpecial(tm[dx + dy]))
+        *dest++ = *tm;
+      else
+        *dest++ = (*tm + tm[dx] + tm[dy] + tm[dx + dy] + 2) >> 2;
+    }
+  }
 }
 
 short
@@ -251,5 +292,7 @@ RasterBuffer::ScanLineChecked(unsigned ax, unsigned ay,
 short
 RasterBuffer::GetMaximum() const
 {
-  return IsDefined() ? *std::max_element(data.begin(), data.end()) : 0;
+  return IsDefined()
+    ? *std::max_element(base, base + width * height)
+    : 0;
 }
@@ -30,6 +30,8 @@ Copyright_License {
 
 #include <cstddef>
 
+#include <assert.h>
+
 class RasterBuffer : private NonCopyable {
 public:
   /** invalid value for terrain */
@@ -69,21 +71,38 @@ public:
 private:
   AllocatedGrid<short> data;
 
+  /**
+   * Points to the first element of the grid.  This is either
+   * data.begin(), or a read-only pointer into memory owned by
+   * somebody else (see SetMapped()).
+   */
+  const short *base;
+
+  unsigned width, height;
+
 public:
-  RasterBuffer() = default;
+  RasterBuffer():base(nullptr), width(0), height(0) {}
   RasterBuffer(unsigned _width, unsigned _height)
-    :data(_width, _height) {}
+    :data(_width, _height), base(data.begin()),
+     width(_width), height(_height) {}
 
   bool IsDefined() const {
-    return data.IsDefined();
+    return base != nullptr;
+  }
+
+  /**
+   * Does this object refer to foreign read-only memory?
+   */
+  bool IsMapped() const {
+    return base != nullptr && !data.IsDefined();
   }
 
   unsigned GetWidth() const {
-    return data.GetWidth();
+    return width;
   }
 
   unsigned GetHeight() const {
-    return data.GetHeight();
+    return height;
   }
 
   unsigned GetFineWidth() const {
@@ -95,23 +114,46 @@ public:
   }
 
   short *GetData() {
+    assert(!IsMapped());
+
     return data.begin();
   }
 
   const short *GetData() const {
-    return data.begin();
+    return base;
   }
 
   const short *GetDataAt(unsigned x, unsigned y) const {
-    return data.GetPointerAt(x, y);
+    assert(x < width);
+    assert(y < height);
+
+    return base + y * width + x;
   }
 
   void Reset() {
     data.Reset();
+    base = nullptr;
+    width = height = 0;
   }
 
   void Resize(unsigned _width, unsigned _height);
 
+  /**
+   * Let this object refer to a read-only grid owned by somebody
+   * else, e.g. a file mapping.  The caller is responsible for
+   * keeping the memory alive until Reset() is called.
+   */
+  void SetMapped(const short *_data, unsigned _width, unsigned _height);
+
+  /**
+   * Fill this buffer with a copy of the specified one, downsampled by
+   * factor 2 in both directions (rounding the size up).  Each value
+   * is the average of a 2x2 block; if one of them is "special"
+   * (water or invalid), the top left value is copied, just like
+   * GetInterpolated() does.
+   */
+  void Downsample(const RasterBuffer &src);
+
   gcc_pure
   short GetInterpolated(unsigned lx, unsigned ly,
                         unsigned ix, unsigned iy) const;
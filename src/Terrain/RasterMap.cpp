@@ -25,9 +25,11 @@ Copyright_License {
 #include "Geo/GeoClip.hpp"
 #include "IO/FileCache.hpp"
 #include "Util/ConvertString.hpp"
+#include "Util/StaticArray.hpp"
 
 #include <algorithm>
 #include <assert.h>
+#include <stdlib.h>
 #include <string.h>
 
 /* use separate cache files for FIXED=y and FIXED=n because the file
@@ -38,6 +40,12 @@ static const TCHAR *const terrain_cache_name = _T("terrain_fixed");
 static const TCHAR *const terrain_cache_name = _T("terrain");
 #endif
 
+/**
+ * The name of the #RasterTileStore file, which contains all tiles
+ * already decoded.
+ */
+static const TCHAR *const tile_store_name = _T("terrain_tiles");
+
 static char *
 ToNarrowPath(const TCHAR *src)
 {
@@ -74,11 +82,53 @@ RasterMap::RasterMap(const TCHAR *_path, const TCHAR *world_file,
     }
   }
 
+  if (cache != NULL)
+    LoadTileStore(*cache, _path, operation);
+
   projection.Set(GetBounds(),
                  raster_tile_cache.GetFineWidth(),
                  raster_tile_cache.GetFineHeight());
 }
 
+void
+RasterMap::LoadTileStore(FileCache &cache, const TCHAR *_path,
+                         OperationEnvironment &operation)
+{
+  FILE *file = cache.Load(tile_store_name, _path);
+  if (file == NULL) {
+    /* generate the tile store; this is expensive, but needs to be
+       done only once */
+    file = cache.Save(tile_store_name, _path);
+    if (file == NULL)
+      return;
+
+    if (!raster_tile_cache.SaveTileStore(path, file, operation)) {
+      cache.Cancel(tile_store_name, file);
+      return;
+    }
+
+    if (!cache.Commit(tile_store_name, file))
+      return;
+
+    file = cache.Load(tile_store_name, _path);
+    if (file == NULL)
+      return;
+  }
+
+  /* the tile store begins after the FileCache header */
+  const long header_offset = ftell(file);
+  fclose(file);
+  if (header_offset < 0)
+    return;
+
+  TCHAR buffer[cache.PathBufferSize(tile_store_name)];
+  if (!raster_tile_cache.LoadTileStore(cache.MakeCachePath(buffer,
+                                                           tile_store_name),
+                                       header_offset))
+    /* corrupt or obsolete file: delete it, and try again next time */
+    cache.Flush(tile_store_name);
+}
+
 RasterMap::~RasterMap() {
   free(path);
 }
@@ -89,22 +139,55 @@ AngleToPixel(Angle value, Angle start, Angle end, unsigned width)
   return unsigned((value - start).Native() * width / (end - start).Native());
 }
 
+gcc_pure
+static SignedRasterLocation
+GeoToPixel(const GeoPoint &location, const GeoBounds &bounds,
+           unsigned width, unsigned height)
+{
+  return SignedRasterLocation(AngleToPixel(location.longitude,
+                                           bounds.GetWest(), bounds.GetEast(),
+                                           width),
+                              AngleToPixel(location.latitude,
+                                           bounds.GetNorth(), bounds.GetSouth(),
+                                           height));
+}
+
 void
 RasterMap::SetViewCenter(const GeoPoint &location, fixed radius)
+{
+  SetViewCenter(location, radius, nullptr);
+}
+
+void
+RasterMap::SetViewCenter(const GeoPoint &location, fixed radius,
+                         ConstBuffer<GeoPoint> prefetch)
 {
   if (!raster_tile_cache.GetInitialised())
     return;
 
   const GeoBounds &bounds = GetBounds();
+  const unsigned width = raster_tile_cache.GetWidth();
+  const unsigned height = raster_tile_cache.GetHeight();
+
+  const auto p = GeoToPixel(location, bounds, width, height);
+
+  StaticArray<SignedRasterLocation, 32> prefetch_pixels;
+  for (const auto &i : prefetch) {
+    if (prefetch_pixels.full())
+      break;
 
-  int x = AngleToPixel(location.longitude, bounds.GetWest(), bounds.GetEast(),
-                       raster_tile_cache.GetWidth());
+    if (!bounds.IsInside(i))
+      /* no terrain there */
+      continue;
 
-  int y = AngleToPixel(location.latitude, bounds.GetNorth(), bounds.GetSouth(),
-                       raster_tile_cache.GetHeight());
+    prefetch_pixels.append(GeoToPixel(i, bounds, width, height));
+  }
 
-  raster_tile_cache.UpdateTiles(path, x, y,
-                                projection.DistancePixelsCoarse(radius));
+  const unsigned pixel_radius = projection.DistancePixelsCoarse(radius);
+  raster_tile_cache.UpdateTiles(path, p.x, p.y, pixel_radius,
+                                {prefetch_pixels.begin(),
+                                 prefetch_pixels.size()},
+                                pixel_radius);
 }
 
 short
@@ -121,9 +204,22 @@ RasterMap::GetInterpolatedHeight(const GeoPoint &location) const
   return raster_tile_cache.GetInterpolatedHeight(pt.x, pt.y);
 }
 
+unsigned
+RasterMap::GetScanLevel(const GeoPoint &start, const GeoPoint &end,
+                        unsigned size) const
+{
+  assert(size > 0);
+
+  const auto a = projection.ProjectFine(start);
+  const auto b = projection.ProjectFine(end);
+  const unsigned dx = abs(b.x - a.x), dy = abs(b.y - a.y);
+  return raster_tile_cache.GetLevel(std::max(dx, dy) / size);
+}
+
 void
 RasterMap::ScanLine(const GeoPoint &start, const GeoPoint &end,
-                    short *buffer, unsigned size, bool interpolate) const
+                    short *buffer, unsigned size, bool interpolate,
+                    unsigned max_level) const
 {
   assert(buffer != NULL);
   assert(size > 0);
@@ -191,7 +287,7 @@ RasterMap::ScanLine(const GeoPoint &start, const GeoPoint &end,
   raster_tile_cache.ScanLine(raster_start, raster_end,
                              buffer + clipped_start_offset,
                              clipped_end_offset - clipped_start_offset,
-                             interpolate);
+                             interpolate, max_level);
 }
 
 bool
@@ -259,3 +355,53 @@ RasterMap::Intersection(const GeoPoint& origin,
 
   return projection.UnprojectCoarse(c_int);
 }
+
+void
+RasterMap::Intersection(const GeoPoint &origin,
+                        const int h_origin, const int h_glide,
+                        const GeoPoint *destinations, GeoPoint *results,
+                        unsigned n) const
+{
+  const auto c_origin = projection.ProjectCoarse(origin);
+
+  static constexpr unsigned CHUNK = 64;
+  SignedRasterLocation c_destinations[CHUNK], c_results[CHUNK];
+  int slope_facts[CHUNK];
+
+  /* the index of each line submitted to the tile cache; lines with
+     zero length are skipped */
+  unsigned indices[CHUNK];
+
+  for (unsigned offset = 0; offset < n; offset += CHUNK) {
+    const unsigned chunk_size = std::min(n - offset, unsigned(CHUNK));
+
+    unsigned n_lines = 0;
+    for (unsigned i = 0; i < chunk_size; ++i) {
+      const GeoPoint &destination = destinations[offset + i];
+      const auto c_destination = projection.ProjectCoarse(destination);
+      const int c_diff = c_origin.ManhattanDistance(c_destination);
+      if (c_diff == 0) {
+        results[offset + i] = destination; // no distance
+        continue;
+      }
+
+      c_destinations[n_lines] = c_destination;
+      slope_facts[n_lines] = (((int)h_glide) << RASTER_SLOPE_FACT) / c_diff;
+      indices[n_lines] = offset + i;
+      ++n_lines;
+    }
+
+    raster_tile_cache.Intersection(c_origin.x, c_origin.y,
+                                   c_destinations, slope_facts, n_lines,
+                                   h_origin, c_results);
+
+    for (unsigned j = 0; j < n_lines; ++j) {
+      const unsigned i = indices[j];
+      if (c_results[j] == c_destinations[j])
+        // made it to grid location, return exact location of destination
+        results[i] = destinations[i];
+      else
+        results[i] = projection.UnprojectCoarse(c_results[j]);
+    }
+  }
+}
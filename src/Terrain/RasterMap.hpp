@@ -28,6 +28,7 @@ Copyright_License {
 #include "RasterTileCache.hpp"
 #include "Geo/GeoPoint.hpp"
 #include "Util/NonCopyable.hpp"
+#include "Util/ConstBuffer.hxx"
 #include "Compiler.h"
 
 #include <tchar.h>
@@ -45,6 +46,17 @@ public:
             OperationEnvironment &operation);
   ~RasterMap();
 
+private:
+  /**
+   * Load (or generate) the #RasterTileStore, which contains all
+   * tiles already decoded.  On failure, tiles will be decoded from
+   * the JPEG2000 file on demand.
+   */
+  void LoadTileStore(FileCache &cache, const TCHAR *_path,
+                     OperationEnvironment &operation);
+
+public:
+
   bool IsDefined() const {
     return raster_tile_cache.GetInitialised();
   }
@@ -65,6 +77,14 @@ public:
 
   void SetViewCenter(const GeoPoint &location, fixed radius);
 
+  /**
+   * Like SetViewCenter(), but also load the tiles around the
+   * specified locations, e.g. along the predicted flight path.  The
+   * tiles near #location are loaded first.
+   */
+  void SetViewCenter(const GeoPoint &location, fixed radius,
+                     ConstBuffer<GeoPoint> prefetch);
+
   /**
    * Determines if SetViewCenter() should be called again to continue
    * loading.
@@ -78,6 +98,15 @@ public:
     return raster_tile_cache.GetSerial();
   }
 
+  gcc_pure
+  RasterTileStatistics GetTileStatistics() const {
+    return raster_tile_cache.GetStatistics();
+  }
+
+  void ResetTileStatistics() {
+    raster_tile_cache.ResetStatistics();
+  }
+
   /**
    * The geographical distance in meters of the given amount
    * of pixels multiplied by 256.
@@ -101,12 +130,26 @@ public:
   gcc_pure
   short GetInterpolatedHeight(const GeoPoint &location) const;
 
+  /**
+   * Determine the coarsest terrain pyramid level which may be used
+   * to sample the specified line with the specified number of
+   * samples.  See RasterTileCache::GetLevel().
+   */
+  gcc_pure
+  unsigned GetScanLevel(const GeoPoint &start, const GeoPoint &end,
+                        unsigned size) const;
+
   /**
    * Scan a straight line and fill the buffer with the specified
    * number of samples along the line.
+   *
+   * @param max_level the coarsest pyramid level which may be used;
+   * the level is also limited by the distance between two samples
+   * on this line
    */
   void ScanLine(const GeoPoint &start, const GeoPoint &end,
-                short *buffer, unsigned size, bool interpolate) const;
+                short *buffer, unsigned size, bool interpolate,
+                unsigned max_level=RasterTile::MAX_LEVELS) const;
 
   gcc_pure
   bool FirstIntersection(const GeoPoint &origin, int h_origin,
@@ -131,6 +174,19 @@ public:
                         int h_origin, int h_glide,
                         const GeoPoint& destination) const;
 
+  /**
+   * Batch version of Intersection() for many destinations, e.g. all
+   * directions of a reach fan.  The results are the same as calling
+   * Intersection() for each of them.
+   *
+   * @param destinations the locations of aircraft at MSL
+   * @param results receives the intersection location (or the
+   * destination) for each destination
+   */
+  void Intersection(const GeoPoint &origin, int h_origin, int h_glide,
+                    const GeoPoint *destinations, GeoPoint *results,
+                    unsigned n) const;
+
 };
 
 
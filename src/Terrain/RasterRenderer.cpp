@@ -23,7 +23,7 @@ Copyright_License {
 
 #include "Terrain/RasterRenderer.hpp"
 #include "Terrain/RasterMap.hpp"
-#include "Math/FastMath.h"
+#include "Terrain/Kernel/Optimised.hpp"
 #include "Util/Clamp.hpp"
 #include "Screen/Ramp.hpp"
 #include "Screen/Layout.hpp"
@@ -33,8 +33,12 @@ Copyright_License {
 #include "Asset.hpp"
 #include "Event/Idle.hpp"
 
+#include <algorithm>
+
 #include <assert.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
 /**
  * Interpolate between x and y with i/128, i.e. i/(1 << 7).
@@ -81,16 +85,6 @@ TerrainShading(const int illum, RGB8Color color)
     return RawColor(color.Red(), color.Green(), color.Blue());
 }
 
-gcc_const
-static unsigned
-ContourInterval(const int h, const unsigned contour_height_scale)
-{
-  if (gcc_unlikely(RasterBuffer::IsSpecial(h)) || h <= 0)
-    return 0;
-
-  return std::min(254u, unsigned(h) >> contour_height_scale);
-}
-
 RasterRenderer::RasterRenderer()
 {
   // scale quantisation_pixels so resolution is not too high on old hardware
@@ -105,6 +99,9 @@ RasterRenderer::~RasterRenderer()
   delete[] color_table;
   delete image;
   delete[] contour_column_base;
+  delete[] row_color_index;
+  delete[] row_contour;
+  delete[] row_illumination;
 }
 
 #ifdef ENABLE_OPENGL
@@ -141,7 +138,10 @@ RasterRenderer::BindAndGetTexture() const
 #endif
 
 void
-RasterRenderer::ScanMap(const RasterMap &map, const WindowProjection &projection)
+RasterRenderer::CalculateResolution(const RasterMap &map,
+                                    const WindowProjection &projection,
+                                    fixed &_pixel_size,
+                                    unsigned &_quantisation_effective) const
 {
   // Coordinates of the MapWindow center
   unsigned x = projection.GetScreenWidth() / 2;
@@ -153,29 +153,35 @@ RasterRenderer::ScanMap(const RasterMap &map, const WindowProjection &projection
                                              y + quantisation_pixels);
 
   // Geographical edge length of pixel in the MapWindow center in meters
-  pixel_size = fixed_sqrt_half * center.DistanceS(neighbor);
+  _pixel_size = fixed_sqrt_half * center.DistanceS(neighbor);
 
   // set resolution
 
-  if (pixel_size < fixed(3000)) {
+  if (_pixel_size < fixed(3000)) {
     // Data point size of the (terrain) map in meters multiplied by 256
     fixed map_pixel_size = map.PixelDistance(center, 1);
 
     // How many screen pixels does one data point stretch?
-    fixed q = map_pixel_size / pixel_size;
+    fixed q = map_pixel_size / _pixel_size;
 
     /* round down to reduce slope shading artefacts (caused by
        RasterBuffer interpolation) */
-    quantisation_effective = std::max(1, (int)q);
+    _quantisation_effective = std::max(1, (int)q);
 
     /* disable slope shading when zoomed in very near (not enough
        terrain resolution to make a useful slope calculation) */
-    if (quantisation_effective > 25)
-      quantisation_effective = 0;
+    if (_quantisation_effective > 25)
+      _quantisation_effective = 0;
 
   } else
     /* disable slope shading when zoomed out very far (too tiny) */
-    quantisation_effective = 0;
+    _quantisation_effective = 0;
+}
+
+void
+RasterRenderer::ScanMap(const RasterMap &map, const WindowProjection &projection)
+{
+  CalculateResolution(map, projection, pixel_size, quantisation_effective);
 
 #ifdef ENABLE_OPENGL
   bounds = projection.GetScreenBounds().Scale(fixed(1.5));
@@ -185,11 +191,118 @@ RasterRenderer::ScanMap(const RasterMap &map, const WindowProjection &projection
                      true);
 
   last_quantisation_pixels = quantisation_pixels;
+  scrolled = false;
 #else
   height_matrix.Fill(map, projection, quantisation_pixels, true);
 #endif
 }
 
+#ifdef ENABLE_OPENGL
+
+/**
+ * Are the two angles equal, apart from rounding errors?
+ */
+gcc_const
+static bool
+IsSameSize(Angle a, Angle b)
+{
+  return fabs(a.Native() - b.Native()) <= fabs(b.Native()) / 1000;
+}
+
+bool
+RasterRenderer::ScrollMap(const RasterMap &map,
+                          const WindowProjection &projection)
+{
+  const unsigned width = height_matrix.GetWidth();
+  const unsigned height = height_matrix.GetHeight();
+
+  if (!bounds.IsValid() || scrolled || image == nullptr ||
+      quantisation_pixels != last_quantisation_pixels ||
+      projection.GetScreenWidth() / quantisation_pixels != width ||
+      projection.GetScreenHeight() / quantisation_pixels != height)
+    return false;
+
+  /* the scale must not have changed */
+  const GeoBounds new_bounds = projection.GetScreenBounds().Scale(fixed(1.5));
+  if (!IsSameSize(new_bounds.GetWidth(), bounds.GetWidth()) ||
+      !IsSameSize(new_bounds.GetHeight(), bounds.GetHeight()))
+    return false;
+
+  fixed new_pixel_size;
+  unsigned new_quantisation_effective;
+  CalculateResolution(map, projection,
+                      new_pixel_size, new_quantisation_effective);
+  if (new_quantisation_effective != quantisation_effective)
+    return false;
+
+  /* snap to the cell grid of the previous bounds */
+  const Angle cell_width = bounds.GetWidth() / width;
+  const Angle cell_height = bounds.GetHeight() / height;
+  const int dx = iround((new_bounds.GetWest() - bounds.GetWest()).Native() /
+                        cell_width.Native());
+  const int dy = iround((bounds.GetNorth() - new_bounds.GetNorth()).Native() /
+                        cell_height.Native());
+
+  /* if more than half of the matrix would need to be scanned, a full
+     scan is cheaper */
+  if (unsigned(abs(dx)) * 2 > width || unsigned(abs(dy)) * 2 > height)
+    return false;
+
+  bounds = GeoBounds(GeoPoint(bounds.GetWest() + cell_width * dx,
+                              bounds.GetNorth() - cell_height * dy),
+                     GeoPoint(bounds.GetEast() + cell_width * dx,
+                              bounds.GetSouth() - cell_height * dy));
+
+  height_matrix.Shift(dx, dy);
+
+  /* scan the exposed rows over the full width, and then the exposed
+     columns in the remaining rows */
+
+  unsigned top = 0, bottom = height;
+  if (dy > 0) {
+    bottom = height - dy;
+    height_matrix.Fill(map, bounds, 0, bottom, width, height, true);
+  } else if (dy < 0) {
+    top = -dy;
+    height_matrix.Fill(map, bounds, 0, 0, width, top, true);
+  }
+
+  if (dx > 0)
+    height_matrix.Fill(map, bounds, width - dx, top, width, bottom, true);
+  else if (dx < 0)
+    height_matrix.Fill(map, bounds, 0, top, -dx, bottom, true);
+
+  scroll_x = dx;
+  scroll_y = dy;
+  scrolled = true;
+  return true;
+}
+
+void
+RasterRenderer::ShiftImage(int dx, int dy)
+{
+  const unsigned width = height_matrix.GetWidth();
+  const unsigned height = height_matrix.GetHeight();
+
+  const unsigned n_columns = width - abs(dx);
+  const unsigned n_rows = height - abs(dy);
+  const unsigned src_x = std::max(dx, 0), dest_x = std::max(-dx, 0);
+  const unsigned src_y = std::max(dy, 0), dest_y = std::max(-dy, 0);
+
+  for (unsigned i = 0; i < n_rows; ++i) {
+    /* dy > 0 moves the contents up (each row is copied from one
+       further down), so walk from the top row downwards; dy < 0
+       moves them down, so walk from the bottom row upwards.  Either
+       way, a source row is read before it gets overwritten */
+    const unsigned y = dy > 0 ? i : n_rows - 1 - i;
+    memmove(image->GetRow(dest_y + y) + dest_x,
+            image->GetRow(src_y + y) + src_x,
+            n_columns * sizeof(RawColor));
+  }
+}
+
+#endif
+
 void
 RasterRenderer::GenerateImage(bool do_shading,
                               unsigned height_scale,
@@ -197,16 +310,80 @@ RasterRenderer::GenerateImage(bool do_shading,
                               const Angle sunazimuth,
                               bool do_contour)
 {
+  const unsigned width = height_matrix.GetWidth();
+  const unsigned height = height_matrix.GetHeight();
+
+  /* the regions of the image to be generated; usually the whole
+     image, but only the exposed strips after ScrollMap() */
+  PixelRect regions[2];
+  unsigned n_regions = 0;
+
   if (image == NULL ||
-      height_matrix.GetWidth() > image->GetWidth() ||
-      height_matrix.GetHeight() > image->GetHeight()) {
+      width > image->GetWidth() ||
+      height > image->GetHeight()) {
     delete image;
-    image = new RawBitmap(height_matrix.GetWidth(), height_matrix.GetHeight());
+    image = new RawBitmap(width, height);
 
     delete[] contour_column_base;
-    contour_column_base = new unsigned char[height_matrix.GetWidth()];
+    contour_column_base = new unsigned char[width];
+
+    delete[] row_color_index;
+    row_color_index = new uint8_t[width];
+    delete[] row_contour;
+    row_contour = new uint8_t[width];
+    delete[] row_illumination;
+    row_illumination = new int8_t[width];
+#ifdef ENABLE_OPENGL
+  } else if (scrolled) {
+    ShiftImage(scroll_x, scroll_y);
+
+    /* regenerate a margin of the old image, too: slope shading looks
+       at neighbours up to #quantisation_effective cells away, and
+       contour lines at the previous cell */
+    const int margin = quantisation_effective + 1;
+
+    if (scroll_y != 0) {
+      PixelRect &rc = regions[n_regions++];
+      rc.left = 0;
+      rc.right = width;
+      if (scroll_y > 0) {
+        rc.top = std::max(int(height) - scroll_y - margin, 0);
+        rc.bottom = height;
+      } else {
+        rc.top = 0;
+        rc.bottom = std::min(-scroll_y + margin, int(height));
+      }
+    }
+
+    if (scroll_x != 0) {
+      PixelRect &rc = regions[n_regions++];
+      rc.top = 0;
+      rc.bottom = height;
+      if (scroll_x > 0) {
+        rc.left = std::max(int(width) - scroll_x - margin, 0);
+        rc.right = width;
+      } else {
+        rc.left = 0;
+        rc.right = std::min(-scroll_x + margin, int(width));
+      }
+    }
+#endif
   }
 
+#ifdef ENABLE_OPENGL
+  if (!scrolled)
+#endif
+  {
+    PixelRect &rc = regions[n_regions++];
+    rc.left = rc.top = 0;
+    rc.right = width;
+    rc.bottom = height;
+  }
+
+#ifdef ENABLE_OPENGL
+  scrolled = false;
+#endif
+
   if (quantisation_effective == 0) {
     do_shading = false;
     do_contour = false;
@@ -214,49 +391,59 @@ RasterRenderer::GenerateImage(bool do_shading,
 
   const unsigned contour_height_scale = do_contour? height_scale * 2 : 16;
 
-  ContourStart(contour_height_scale);
+  for (unsigned i = 0; i < n_regions; ++i) {
+    const PixelRect &rc = regions[i];
 
-  if (do_shading)
-    GenerateSlopeImage(height_scale, contrast, brightness,
-                       sunazimuth, contour_height_scale);
-  else
-    GenerateUnshadedImage(height_scale, contour_height_scale);
+    /* the contour state of each column is continued from the row
+       above the region */
+    ContourStart(contour_height_scale, rc.top > 0 ? rc.top - 1 : 0);
+
+    if (do_shading)
+      GenerateSlopeImage(height_scale, contrast, brightness,
+                         sunazimuth, contour_height_scale, rc);
+    else
+      GenerateUnshadedImage(height_scale, contour_height_scale, rc);
+  }
 
   image->SetDirty();
 }
 
 void
 RasterRenderer::GenerateUnshadedImage(unsigned height_scale,
-                                      const unsigned contour_height_scale)
+                                      const unsigned contour_height_scale,
+                                      const PixelRect &rc)
 {
-  const short *src = height_matrix.GetData();
   const RawColor *oColorBuf = color_table + 64 * 256;
-  RawColor *dest = image->GetTopRow();
 
-  for (unsigned y = height_matrix.GetHeight(); y > 0; --y) {
-    RawColor *p = dest;
-    dest = image->GetNextRow(dest);
+  for (unsigned y = rc.top; y < (unsigned)rc.bottom; ++y) {
+    const short *src = height_matrix.GetRow(y);
+    RawColor *p = image->GetRow(y) + rc.left;
 
-    unsigned contour_row_base = ContourInterval(*src, contour_height_scale);
-    unsigned char *contour_this_column_base = contour_column_base;
+    RasterKernels::HeightIndices(src + rc.left, rc.right - rc.left,
+                                 height_scale, contour_height_scale,
+                                 row_color_index + rc.left,
+                                 row_contour + rc.left);
 
-    for (unsigned x = height_matrix.GetWidth(); x > 0; --x) {
-      int h = *src++;
-      if (gcc_likely(!RasterBuffer::IsSpecial(h))) {
-        if (h < 0)
-          h = 0;
+    /* the contour state of this row is continued from the column
+       left of the region */
+    unsigned contour_row_base = rc.left > 0
+      ? ContourInterval(src[rc.left - 1], contour_height_scale)
+      : row_contour[0];
+    unsigned char *contour_this_column_base = contour_column_base + rc.left;
 
-        const unsigned contour_interval =
-          ContourInterval(h, contour_height_scale);
+    for (unsigned x = rc.left; x < (unsigned)rc.right; ++x) {
+      const int h = src[x];
+      if (gcc_likely(!RasterBuffer::IsSpecial(h))) {
+        const unsigned contour_interval = row_contour[x];
+        const int index = row_color_index[x];
 
-        h = std::min(254, h >> height_scale);
         if (gcc_unlikely((contour_interval != contour_row_base)
                          || (contour_interval != *contour_this_column_base))) {
 
-          *p++ = oColorBuf[h - 64 * 256];
+          *p++ = oColorBuf[index - 64 * 256];
           *contour_this_column_base = contour_row_base = contour_interval;
         } else {
-          *p++ = oColorBuf[h];
+          *p++ = oColorBuf[index];
         }
       } else if (RasterBuffer::IsWater(h)) {
         // we're in the water, so look up the color for water
@@ -271,19 +458,6 @@ RasterRenderer::GenerateUnshadedImage(unsigned height_scale,
   }
 }
 
-/**
- * Clip the difference between two adjacent terrain height values to
- * sane bounds.  This works around integer overflows in the
- * GenerateSlopeImage() formula when the map file is broken, avoiding
- * the sqrt() call with a negative argument.
- */
-gcc_const
-static int
-ClipHeightDelta(int d)
-{
-  return Clamp(d, -512, 512);
-}
-
 // JMW: if zoomed right in (e.g. one unit is larger than terrain
 // grid), then increase the step size to be equal to the terrain
 // grid for purposes of calculating slope, to avoid shading problems
@@ -293,7 +467,8 @@ void
 RasterRenderer::GenerateSlopeImage(unsigned height_scale,
                                    int contrast,
                                    const int sx, const int sy, const int sz,
-                                   const unsigned contour_height_scale)
+                                   const unsigned contour_height_scale,
+                                   const PixelRect &rc)
 {
   assert(quantisation_effective > 0);
 
@@ -303,80 +478,108 @@ RasterRenderer::GenerateSlopeImage(unsigned height_scale,
   border.right = height_matrix.GetWidth() - quantisation_effective;
   border.bottom = height_matrix.GetHeight() - quantisation_effective;
 
-  const unsigned height_slope_factor =
+  SlopeShadingParameters params;
+  params.sx = sx;
+  params.sy = sy;
+  params.sz = sz;
+  params.contrast = contrast;
+  params.height_slope_factor =
     Clamp((unsigned)pixel_size, 1u,
           /* this upper limit avoids integer overflows in the "mag"
              formula; it effectively limits "dd2" so calculating its
              square will not overflow */
           8192u / (quantisation_effective * quantisation_effective));
 
-  const short *src = height_matrix.GetData();
+  const unsigned width = height_matrix.GetWidth();
+
+  /* the columns where both horizontal neighbours are
+     quantisation_effective pixels away; their illumination is
+     calculated by the (vectorised) RasterKernels::Illumination() */
+  const unsigned left = rc.left, right = rc.right;
+  const unsigned interior_start =
+    std::min(std::max(quantisation_effective, left), right);
+  const unsigned interior_end = border.right > border.left
+    ? Clamp((unsigned)border.right, interior_start, right)
+    : interior_start;
+
   const RawColor *oColorBuf = color_table + 64 * 256;
 
-  RawColor *dest = image->GetTopRow();
+  for (unsigned y = rc.top; y < (unsigned)rc.bottom; ++y) {
+    const short *src = height_matrix.GetRow(y);
 
-  for (unsigned y = 0; y < height_matrix.GetHeight(); ++y) {
     const unsigned row_plus_index = y < (unsigned)border.bottom
       ? quantisation_effective
       : height_matrix.GetHeight() - 1 - y;
-    const unsigned row_plus_offset = height_matrix.GetWidth() * row_plus_index;
+    const unsigned row_plus_offset = width * row_plus_index;
 
     const unsigned row_minus_index = y >= quantisation_effective
       ? quantisation_effective : y;
-    const unsigned row_minus_offset = height_matrix.GetWidth() * row_minus_index;
+    const unsigned row_minus_offset = width * row_minus_index;
 
     const unsigned p31 = row_plus_index + row_minus_index;
 
-    RawColor *p = dest;
-    dest = image->GetNextRow(dest);
-
-    unsigned contour_row_base = ContourInterval(*src, contour_height_scale);
-    unsigned char *contour_this_column_base = contour_column_base;
-
-    for (unsigned x = 0; x < height_matrix.GetWidth(); ++x, ++src) {
-      int h = *src;
-      if (gcc_likely(!RasterBuffer::IsSpecial(h))) {
-        if (h < 0)
-          h = 0;
-
-        const unsigned contour_interval =
-          ContourInterval(h, contour_height_scale);
+    // Y direction
+    assert(src - row_minus_offset >= height_matrix.GetData());
+    assert(src + row_plus_offset + width <= height_matrix.GetDataEnd());
+
+    RasterKernels::HeightIndices(src + left, right - left,
+                                 height_scale, contour_height_scale,
+                                 row_color_index + left, row_contour + left);
+
+    RasterKernels::Illumination(src + interior_start,
+                                row_minus_offset, row_plus_offset,
+                                quantisation_effective, p31,
+                                interior_end - interior_start, params,
+                                row_illumination + interior_start);
+
+    /* the remaining columns near the left and right border */
+    for (unsigned x = left; x < right; ++x) {
+      if (x == interior_start) {
+        x = interior_end;
+        if (x >= right)
+          break;
+      }
 
-        h = std::min(254, h >> height_scale);
+      // X direction
 
-        // no need to calculate slope if undefined height or sea level
+      const unsigned column_plus_index = x < (unsigned)border.right
+        ? quantisation_effective
+        : width - 1 - x;
+      const unsigned column_minus_index = x >= (unsigned)border.left
+        ? quantisation_effective : x;
 
-        // Y direction
-        assert(src - row_minus_offset >= height_matrix.GetData());
-        assert(src + row_plus_offset >= height_matrix.GetData());
-        assert(src - row_minus_offset < height_matrix.GetDataEnd());
-        assert(src + row_plus_offset < height_matrix.GetDataEnd());
+      assert(column_minus_index <= x);
+      assert(x + column_plus_index < width);
 
-        // X direction
+      const short *s = src + x;
+      row_illumination[x] =
+        CalculateIllumination(s[-(int)row_minus_offset], s[row_plus_offset],
+                              s[-(int)column_minus_index],
+                              s[column_plus_index],
+                              column_plus_index + column_minus_index, p31,
+                              params);
+    }
 
-        const unsigned column_plus_index = x < (unsigned)border.right
-          ? quantisation_effective
-          : height_matrix.GetWidth() - 1 - x;
-        const unsigned column_minus_index = x >= (unsigned)border.left
-          ? quantisation_effective : x;
+    RawColor *p = image->GetRow(y) + left;
 
-        assert(src - column_minus_index >= height_matrix.GetData());
-        assert(src + column_plus_index >= height_matrix.GetData());
-        assert(src - column_minus_index < height_matrix.GetDataEnd());
-        assert(src + column_plus_index < height_matrix.GetDataEnd());
+    /* the contour state of this row is continued from the column
+       left of the region */
+    unsigned contour_row_base = left > 0
+      ? ContourInterval(src[left - 1], contour_height_scale)
+      : row_contour[0];
+    unsigned char *contour_this_column_base = contour_column_base + left;
 
-        const int h_above = src[-(int)row_minus_offset];
-        const int h_below = src[row_plus_offset];
-        const int h_left = src[-(int)column_minus_index];
-        const int h_right = src[column_plus_index];
+    for (unsigned x = left; x < right; ++x) {
+      const int h = src[x];
+      if (gcc_likely(!RasterBuffer::IsSpecial(h))) {
+        const unsigned contour_interval = row_contour[x];
+        const int index = row_color_index[x];
+        const int illumination = row_illumination[x];
 
-        if (gcc_unlikely(RasterBuffer::IsSpecial(h_above) ||
-                         RasterBuffer::IsSpecial(h_below) ||
-                         RasterBuffer::IsSpecial(h_left) ||
-                         RasterBuffer::IsSpecial(h_right))) {
+        if (gcc_unlikely(illumination == SlopeShadingParameters::NO_SLOPE)) {
           /* some "special" terrain value surrounding us (water or
              invalid), skip slope calculation */
-          *p++ = oColorBuf[h];
+          *p++ = oColorBuf[index];
           contour_this_column_base++;
           continue;
         }
@@ -385,33 +588,11 @@ RasterRenderer::GenerateSlopeImage(unsigned height_scale,
                          || (contour_interval != *contour_this_column_base))) {
 
           *contour_this_column_base++ = contour_row_base = contour_interval;
-          *p++ = oColorBuf[h-64*256];
+          *p++ = oColorBuf[index - 64 * 256];
           continue;
         }
 
-        const int p32 = ClipHeightDelta(h_above - h_below);
-        const int p22 = ClipHeightDelta(h_right - h_left);
-
-        const unsigned p20 = column_plus_index + column_minus_index;
-
-        const int dd0 = p22 * int(p31);
-        const int dd1 = int(p20) * p32;
-        const unsigned dd2 = p20 * p31 * height_slope_factor;
-        const int num = (int(dd2) * sz + dd0 * sx + dd1 * sy);
-        const unsigned square_mag = dd0 * dd0 + dd1 * dd1 + dd2 * dd2;
-#ifdef FIXED_MATH
-        const unsigned mag = isqrt4(square_mag);
-#else
-        const unsigned mag = (unsigned)sqrt((fixed)square_mag);
-#endif
-        /* this is a workaround for a SIGFPE (division by zero)
-           observed by our users on some Android devices (e.g. Nexus
-           7), even though we did our best to make sure that the
-           integer arithmetics above can't overflow */
-        /* TODO: debug this problem and replace this workaround */
-        const int sval = num / int(mag|1);
-        const int sindex = (sval - sz) * contrast / 128;
-        *p++ = oColorBuf[h + 256 * Clamp(sindex, -63, 63)];
+        *p++ = oColorBuf[index + 256 * illumination];
       } else if (RasterBuffer::IsWater(h)) {
         // we're in the water, so look up the color for water
         *p++ = oColorBuf[255];
@@ -429,7 +610,8 @@ void
 RasterRenderer::GenerateSlopeImage(unsigned height_scale,
                                    int contrast, int brightness,
                                    const Angle sunazimuth,
-                                   const unsigned contour_height_scale)
+                                   const unsigned contour_height_scale,
+                                   const PixelRect &rc)
 {
   const Angle fudgeelevation = Angle::Degrees(10) +
     Angle::Degrees(80.0 / 255.0) * brightness;
@@ -439,7 +621,7 @@ RasterRenderer::GenerateSlopeImage(unsigned height_scale,
   const int sz = (int)(255 * fudgeelevation.fastsine());
 
   GenerateSlopeImage(height_scale, contrast,
-                     sx, sy, sz, contour_height_scale);
+                     sx, sy, sz, contour_height_scale, rc);
 }
 
 void
@@ -477,10 +659,10 @@ RasterRenderer::PrepareColorTable(const ColorRamp *color_ramp, bool do_water,
 }
 
 void
-RasterRenderer::ContourStart(const unsigned contour_height_scale)
+RasterRenderer::ContourStart(const unsigned contour_height_scale, unsigned y)
 {
-  // initialise column to first row
-  const short *src = height_matrix.GetData();
+  // initialise column to the specified row
+  const short *src = height_matrix.GetRow(y);
   unsigned char *col_base = contour_column_base;
   for (unsigned x = height_matrix.GetWidth(); x > 0; --x)
     *col_base++ = ContourInterval(*src++, contour_height_scale);
@@ -28,6 +28,8 @@ Copyright_License {
 #include "Math/fixed.hpp"
 #include "Util/NonCopyable.hpp"
 
+#include <stdint.h>
+
 #ifdef ENABLE_OPENGL
 #include "Geo/GeoBounds.hpp"
 #endif
@@ -40,6 +42,7 @@ class RasterMap;
 class WindowProjection;
 class RawBitmap;
 struct RawColor;
+struct PixelRect;
 struct ColorRamp;
 
 #ifdef ENABLE_OPENGL
@@ -71,6 +74,18 @@ class RasterRenderer : private NonCopyable {
    * texture has to be redrawn.
    */
   GeoBounds bounds = GeoBounds::Invalid();
+
+  /**
+   * The number of cells the #HeightMatrix was moved by ScrollMap().
+   * The next GenerateImage() call applies this to the #RawBitmap and
+   * regenerates only the strips which were exposed.
+   */
+  int scroll_x, scroll_y;
+
+  /**
+   * Was ScrollMap() called after the last GenerateImage() call?
+   */
+  bool scrolled = false;
 #endif
 
   HeightMatrix height_matrix;
@@ -78,6 +93,13 @@ class RasterRenderer : private NonCopyable {
 
   unsigned char *contour_column_base = nullptr;
 
+  /**
+   * Scratch buffers for one row of the image, filled by the
+   * #RasterKernels.
+   */
+  uint8_t *row_color_index = nullptr, *row_contour = nullptr;
+  int8_t *row_illumination = nullptr;
+
   fixed pixel_size;
 
   RawColor *color_table = nullptr;
@@ -116,6 +138,18 @@ public:
   }
 
   const GLTexture &BindAndGetTexture() const;
+
+  /**
+   * Attempt to reuse the #HeightMatrix after the map was moved at
+   * constant scale: move its contents by whole cells, and scan only
+   * the strips which were exposed.  The bounds are snapped to the
+   * cell grid of the previous bounds.  Call GenerateImage()
+   * afterwards, with the same parameters as the last time.
+   *
+   * @return false if that was not possible; the caller should call
+   * ScanMap() instead
+   */
+  bool ScrollMap(const RasterMap &map, const WindowProjection &projection);
 #endif
 
   /**
@@ -146,16 +180,20 @@ public:
 protected:
   /**
    * Convert the height matrix into the image, without shading.
+   *
+   * @param rc the region of the image to be generated
    */
   void GenerateUnshadedImage(unsigned height_scale,
-                             const unsigned contour_height_scale);
+                             const unsigned contour_height_scale,
+                             const PixelRect &rc);
 
   /**
    * Convert the height matrix into the image, with slope shading.
    */
   void GenerateSlopeImage(unsigned height_scale, int contrast,
                           const int sx, const int sy, const int sz,
-                          const unsigned contour_height_scale);
+                          const unsigned contour_height_scale,
+                          const PixelRect &rc);
 
   /**
    * Convert the height matrix into the image, with slope shading.
@@ -163,11 +201,32 @@ protected:
   void GenerateSlopeImage(unsigned height_scale,
                           int contrast, int brightness,
                           const Angle sunazimuth,
-                          const unsigned contour_height_scale);
+                          const unsigned contour_height_scale,
+                          const PixelRect &rc);
 
 private:
+  /**
+   * Calculate the pixel size and the step size for slope
+   * calculations for the given projection.
+   */
+  void CalculateResolution(const RasterMap &map,
+                           const WindowProjection &projection,
+                           fixed &_pixel_size,
+                           unsigned &_quantisation_effective) const;
+
+#ifdef ENABLE_OPENGL
+  /**
+   * Move the contents of the image by the specified number of
+   * pixels, see HeightMatrix::Shift().
+   */
+  void ShiftImage(int dx, int dy);
+#endif
 
-  void ContourStart(const unsigned contour_height_scale);
+  /**
+   * Initialise the contour state of all columns with the specified
+   * row of the height matrix.
+   */
+  void ContourStart(const unsigned contour_height_scale, unsigned y=0);
 };
 
 #endif
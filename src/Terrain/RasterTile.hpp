@@ -25,7 +25,9 @@ Copyright_License {
 #define XCSOAR_RASTERTILE_HPP
 
 #include "Terrain/RasterBuffer.hpp"
+#include "Terrain/RasterLocation.hpp"
 #include "Util/NonCopyable.hpp"
+#include "Util/ConstBuffer.hxx"
 
 #include <stdio.h>
 
@@ -35,6 +37,12 @@ class RasterTile : private NonCopyable {
   };
 
 public:
+  /**
+   * The maximum number of downsampled levels (2x, 4x, 8x) which may
+   * be available in addition to the full resolution #buffer.
+   */
+  static constexpr unsigned MAX_LEVELS = 3;
+
   unsigned int xstart, ystart, xend, yend;
   unsigned int width, height;
 
@@ -46,12 +54,25 @@ public:
 
   bool request;
 
+  /**
+   * The index of the decoder thread which shall load this tile, see
+   * RasterTileCache::DecodeRequestedTiles().
+   */
+  unsigned char decoder;
+
   RasterBuffer buffer;
 
+  /**
+   * Downsampled copies of #buffer; levels[i] is smaller by factor
+   * 2^(i+1).  These are only available when the tile is served from
+   * a #RasterTileStore.
+   */
+  RasterBuffer levels[MAX_LEVELS];
+
 public:
   RasterTile()
     :xstart(0), ystart(0), xend(0), yend(0),
-     width(0), height(0) {}
+     width(0), height(0), request(false), decoder(0) {}
 
   void Set(unsigned _xstart, unsigned _ystart,
            unsigned _xend, unsigned _yend) {
@@ -83,8 +104,17 @@ public:
     return request;
   }
 
-  void SetRequest() {
+  /**
+   * Is this tile requested, and shall it be loaded by the specified
+   * decoder thread?
+   */
+  bool IsRequested(unsigned _decoder) const {
+    return request && decoder == _decoder;
+  }
+
+  void SetRequest(unsigned _decoder=0) {
     request = true;
+    decoder = _decoder;
   }
 
   void ClearRequest() {
@@ -94,13 +124,54 @@ public:
   bool SaveCache(FILE *file) const;
   bool LoadCache(FILE *file);
 
+private:
+  gcc_pure
+  unsigned CalculateDistance(int x, int y) const;
+
+public:
   bool CheckTileVisibility(int view_x, int view_y, unsigned view_radius);
 
+  /**
+   * Is this tile within the given radius of one of the specified
+   * locations?  Unlike CheckTileVisibility(), this does not modify
+   * the #distance attribute.
+   */
+  gcc_pure
+  bool IsNear(ConstBuffer<SignedRasterLocation> locations,
+              unsigned radius) const;
+
   void Disable() {
     buffer.Reset();
+
+    for (auto &i : levels)
+      i.Reset();
   }
 
   void Enable();
+
+  /**
+   * Enable this tile, letting it refer to already decoded data owned
+   * by a #RasterTileStore.
+   */
+  void EnableMapped(const short *data) {
+    assert(IsDefined());
+
+    buffer.SetMapped(data, width, height);
+  }
+
+  /**
+   * Like EnableMapped(), but for a downsampled level.
+   *
+   * @param level the pyramid level (1..MAX_LEVELS)
+   */
+  void EnableMapped(unsigned level, const short *data) {
+    assert(IsDefined());
+    assert(level > 0 && level <= MAX_LEVELS);
+
+    levels[level - 1].SetMapped(data, (width + (1u << level) - 1) >> level,
+                                (height + (1u << level) - 1) >> level);
+  }
+
   bool IsEnabled() const {
     return buffer.IsDefined();
   }
@@ -137,11 +208,24 @@ public:
 
   bool VisibilityChanged(int view_x, int view_y, unsigned view_radius);
 
+  /**
+   * @param level the preferred pyramid level; falls back to the full
+   * resolution if that level is not available
+   */
   void ScanLine(unsigned ax, unsigned ay, unsigned bx, unsigned by,
-                short *dest, unsigned size, bool interpolate) const {
-    buffer.ScanLine(ax - (xstart << 8), ay - (ystart << 8),
-                    bx - (xstart << 8), by - (ystart << 8),
-                    dest, size, interpolate);
+                short *dest, unsigned size, bool interpolate,
+                unsigned level=0) const {
+    ax -= xstart << 8;
+    ay -= ystart << 8;
+    bx -= xstart << 8;
+    by -= ystart << 8;
+
+    if (level > 0 && levels[level - 1].IsDefined())
+      levels[level - 1].ScanLine(ax >> level, ay >> level,
+                                 bx >> level, by >> level,
+                                 dest, size, interpolate);
+    else
+      buffer.ScanLine(ax, ay, bx, by, dest, size, interpolate);
   }
 };
 
@@ -29,6 +29,10 @@ Copyright_License {
 #include "IO/ZipLineReader.hpp"
 #include "Operation/Operation.hpp"
 #include "Math/FastMath.h"
+#include "Util/AllocatedArray.hpp"
+#include "Util/Macros.hpp"
+#include "Thread/Parallel.hpp"
+#include "OS/Clock.hpp"
 
 #include <string.h>
 #include <algorithm>
@@ -42,11 +46,30 @@ RasterTileCache::GetImageBuffer(unsigned index)
   return NULL;
 }
 
+/**
+ * The state of the JPEG2000 decoder running in the current thread.
+ */
+struct DecodeState {
+  /**
+   * The index of this decoder thread.  Only tiles assigned to this
+   * index are loaded.
+   */
+  unsigned decoder;
+
+  /**
+   * The number of remaining segments after the current one.
+   */
+  unsigned remaining_segments;
+};
+
+static thread_local DecodeState decode_state;
+
 void
 RasterTileCache::SetTile(unsigned index,
                          int xstart, int ystart, int xend, int yend)
 {
-  if (!segments.empty() && !segments.last().IsTileSegment())
+  if (scan_overview &&
+      !segments.empty() && !segments.last().IsTileSegment())
     /* link current marker segment with this tile */
     segments.last().tile = index;
 
@@ -67,9 +90,13 @@ struct RTDistanceSort {
 };
 
 bool
-RasterTileCache::PollTiles(int x, int y, unsigned radius)
+RasterTileCache::PollTiles(int x, int y, unsigned radius,
+                           ConstBuffer<SignedRasterLocation> prefetch,
+                           unsigned prefetch_radius)
 {
-  if (scan_overview)
+  if (scan_overview || store != nullptr)
+    /* nothing to load; with a tile store, all tiles are always
+       available */
     return false;
 
   /* tiles are usually 256 pixels wide; with a radius smaller than
@@ -77,6 +104,7 @@ RasterTileCache::PollTiles(int x, int y, unsigned radius)
      additionally, this ensures that tiles which are slightly out of
      the screen will be loaded in advance */
   radius += 256;
+  prefetch_radius += 256;
 
   /**
    * Maximum number of tiles loaded at a time, to reduce system load
@@ -86,24 +114,34 @@ RasterTileCache::PollTiles(int x, int y, unsigned radius)
     ? 16
     : MAX_ACTIVE_TILES / 2;
 
-  /* query all tiles; all tiles which are either in range or already
-     loaded are added to RequestTiles */
+  /* query all tiles; all tiles which are either in range (of the
+     view or of a prefetch location) or already loaded are added to
+     RequestTiles */
 
   request_tiles.clear();
-  for (int i = tiles.GetSize() - 1; i >= 0 && !request_tiles.full(); --i)
-    if (tiles.GetLinear(i).VisibilityChanged(x, y, radius))
+  for (int i = tiles.GetSize() - 1; i >= 0 && !request_tiles.full(); --i) {
+    RasterTile &tile = tiles.GetLinear(i);
+    if (tile.VisibilityChanged(x, y, radius) ||
+        tile.IsNear(prefetch, prefetch_radius))
       request_tiles.append(i);
+  }
 
-  /* reduce if there are too many */
+  /* sort by distance, so the tiles near the view are loaded first,
+     and the most distant ones are discarded if there are too many */
 
-  if (request_tiles.size() > MAX_ACTIVE_TILES) {
-    /* sort by distance */
+  if (request_tiles.size() > MAX_ACTIVE_TILES || !prefetch.IsEmpty()) {
     const RTDistanceSort sort(*this);
     std::sort(request_tiles.begin(), request_tiles.end(), sort);
+  }
+
+  /* reduce if there are too many */
 
+  if (request_tiles.size() > MAX_ACTIVE_TILES) {
     /* dispose all tiles which are out of range */
     for (unsigned i = MAX_ACTIVE_TILES; i < request_tiles.size(); ++i) {
       RasterTile &tile = tiles.GetLinear(request_tiles[i]);
+      if (tile.IsEnabled())
+        ++statistics.tiles_evicted;
       tile.Disable();
     }
 
@@ -136,7 +174,7 @@ RasterTileCache::TileRequest(unsigned index)
 {
   RasterTile &tile = tiles.GetLinear(index);
 
-  if (!tile.IsRequested())
+  if (!tile.IsRequested(decode_state.decoder))
     return false;
 
   tile.Enable();
@@ -171,10 +209,13 @@ RasterTileCache::GetInterpolatedHeight(unsigned int lx, unsigned int ly) const
   const unsigned int iy = CombinedDivAndMod(py);
 
   const RasterTile &tile = tiles.Get(px / tile_width, py / tile_height);
-  if (tile.IsEnabled())
+  if (tile.IsEnabled()) {
+    fine_lookups.fetch_add(1, std::memory_order_relaxed);
     return tile.GetInterpolatedHeight(px, py, ix, iy);
+  }
 
   // still not found, so go to overview
+  overview_lookups.fetch_add(1, std::memory_order_relaxed);
   return overview.GetInterpolated(lx >> OVERVIEW_BITS,
                                    ly >> OVERVIEW_BITS);
 }
@@ -184,6 +225,12 @@ RasterTileCache::SetSize(unsigned _width, unsigned _height,
                          unsigned _tile_width, unsigned _tile_height,
                          unsigned tile_columns, unsigned tile_rows)
 {
+  if (!scan_overview)
+    /* this is called each time the decoder parses the main header;
+       the size is already known, and other decoder threads may be
+       using the tiles right now */
+    return;
+
   width = _width;
   height = _height;
   tile_width = _tile_width;
@@ -197,8 +244,21 @@ RasterTileCache::SetSize(unsigned _width, unsigned _height,
 }
 
 void
-RasterTileCache::SetLatLonBounds(double _lon_min, double _lon_max,
-                                 double _lat_min, double _lat_max)
+RasterTileCache::SetLatLonBounds(double lon_min, double lon_max,
+                                 double lat_min, double lat_max)
+{
+  if (!scan_overview)
+    /* this is called each time the decoder parses the comment
+       segment; the bounds are already known, and other decoder
+       threads may be reading them right now */
+    return;
+
+  StoreLatLonBounds(lon_min, lon_max, lat_min, lat_max);
+}
+
+void
+RasterTileCache::StoreLatLonBounds(double _lon_min, double _lon_max,
+                                   double _lat_min, double _lat_max)
 {
   const Angle lon_min(Angle::Degrees(_lon_min));
   const Angle lon_max(Angle::Degrees(_lon_max));
@@ -212,6 +272,41 @@ RasterTileCache::SetLatLonBounds(double _lon_min, double _lon_max,
   bounds_initialised = true;
 }
 
+RasterTileStatistics
+RasterTileCache::GetStatistics() const
+{
+  RasterTileStatistics result = statistics;
+  result.fine_lookups = fine_lookups.load(std::memory_order_relaxed);
+  result.overview_lookups = overview_lookups.load(std::memory_order_relaxed);
+
+  for (auto it = tiles.begin(), end = tiles.end(); it != end; ++it) {
+    if (!it->IsEnabled())
+      continue;
+
+    ++result.resident_tiles;
+    if (!it->buffer.IsMapped())
+      result.resident_bytes += it->buffer.GetWidth() *
+        it->buffer.GetHeight() * sizeof(short);
+  }
+
+  return result;
+}
+
+void
+RasterTileCache::ResetStatistics()
+{
+  statistics.Clear();
+  fine_lookups = 0;
+  overview_lookups = 0;
+}
+
+RasterTileCache::~RasterTileCache()
+{
+  /* the tiles may refer to the mapping; let's clear them first */
+  for (auto it = tiles.begin(), end = tiles.end(); it != end; ++it)
+    it->Disable();
+}
+
 void
 RasterTileCache::Reset()
 {
@@ -226,6 +321,8 @@ RasterTileCache::Reset()
 
   for (auto it = tiles.begin(), end = tiles.end(); it != end; ++it)
     it->Disable();
+
+  store.reset();
 }
 
 gcc_pure
@@ -246,9 +343,9 @@ RasterTileCache::SkipMarkerSegment(long file_offset) const
     /* use all segments when loading the overview */
     return 0;
 
-  if (remaining_segments > 0) {
+  if (decode_state.remaining_segments > 0) {
     /* enable the follow-up segment */
-    --remaining_segments;
+    --decode_state.remaining_segments;
     return 0;
   }
 
@@ -259,7 +356,7 @@ RasterTileCache::SkipMarkerSegment(long file_offset) const
 
   long skip_to = segment->file_offset;
   while (segment->IsTileSegment() &&
-         !tiles.GetLinear(segment->tile).IsRequested()) {
+         !tiles.GetLinear(segment->tile).IsRequested(decode_state.decoder)) {
     ++segment;
     if (segment >= segments.end())
       /* last segment is hidden; shouldn't happen either, because we
@@ -269,7 +366,7 @@ RasterTileCache::SkipMarkerSegment(long file_offset) const
     skip_to = segment->file_offset;
   }
 
-  remaining_segments = segment->count;
+  decode_state.remaining_segments = segment->count;
   return skip_to - file_offset;
 }
 
@@ -323,24 +420,27 @@ RasterTileCache::MarkerSegment(long file_offset, unsigned id)
                                       MarkerSegmentInfo::NO_TILE));
 }
 
-extern RasterTileCache *raster_tile_current;
+extern thread_local RasterTileCache *raster_tile_current;
 
-void
-RasterTileCache::LoadJPG2000(const char *jp2_filename)
+extern "C" void jpc_initluts(void);
+
+bool
+RasterTileCache::LoadJPG2000(const char *jp2_filename, unsigned decoder)
 {
   raster_tile_current = this;
+  decode_state.decoder = decoder;
+  decode_state.remaining_segments = 0;
 
   const auto in = OpenJasperZzipStream(jp2_filename);
-  if (!in) {
-    Reset();
-    return;
-  }
+  if (!in)
+    return false;
 
   if (operation != NULL)
     operation->SetProgressRange(jas_stream_length(in) / 65536);
 
   jp2_decode(in, scan_overview ? "xcsoar=2" : "xcsoar=1");
   jas_stream_close(in);
+  return true;
 }
 
 bool
@@ -398,8 +498,8 @@ RasterTileCache::LoadWorldFile(const TCHAR *path)
   if (endptr == line)
     return false;
 
-  SetLatLonBounds(x_origin, x_origin + GetWidth() * x_scale,
-                  y_origin, y_origin + GetHeight() * y_scale);
+  StoreLatLonBounds(x_origin, x_origin + GetWidth() * x_scale,
+                    y_origin, y_origin + GetHeight() * y_scale);
   return true;
 }
 
@@ -429,14 +529,63 @@ RasterTileCache::LoadOverview(const char *path, const TCHAR *world_file,
 }
 
 void
-RasterTileCache::UpdateTiles(const char *path, int x, int y, unsigned radius)
+RasterTileCache::DecodeRequestedTiles(const char *path)
 {
-  if (!PollTiles(x, y, radius))
+  unsigned num_requested = 0;
+  for (auto it = tiles.begin(), end = tiles.end(); it != end; ++it)
+    if (it->IsRequested())
+      ++num_requested;
+
+  if (num_requested == 0)
     return;
 
-  remaining_segments = 0;
+  const unsigned num_decoders =
+    std::min(std::min(num_requested, GetProcessorCount()),
+             unsigned(MAX_DECODER_THREADS));
 
-  LoadJPG2000(path);
+  /* assign the tiles to decoder threads round-robin */
+  unsigned i = 0;
+  for (auto it = tiles.begin(), end = tiles.end(); it != end; ++it)
+    if (it->IsRequested())
+      it->SetRequest(i++ % num_decoders);
+
+  /* initialise libjasper's global lookup tables before starting the
+     threads */
+  jpc_initluts();
+
+  bool failed[MAX_DECODER_THREADS];
+  ParallelFor(num_decoders, num_decoders,
+              [this, path, &failed](unsigned decoder){
+                failed[decoder] = !LoadJPG2000(path, decoder);
+              });
+
+  /* the other decoders may have been using the tiles while one of
+     them failed, so reset only after all of them have finished */
+  if (std::any_of(failed, failed + num_decoders,
+                  [](bool f){ return f; }))
+    Reset();
+}
+
+void
+RasterTileCache::UpdateTiles(const char *path, int x, int y, unsigned radius,
+                             ConstBuffer<SignedRasterLocation> prefetch,
+                             unsigned prefetch_radius)
+{
+  const uint64_t poll_start = MonotonicClockUS();
+  const bool activate = PollTiles(x, y, radius, prefetch, prefetch_radius);
+  const uint64_t poll_end = MonotonicClockUS();
+
+  const unsigned poll_us = unsigned(poll_end - poll_start);
+  ++statistics.polls;
+  statistics.poll_us += poll_us;
+  if (poll_us > statistics.poll_max_us)
+    statistics.poll_max_us = poll_us;
+
+  if (!activate)
+    return;
+
+  DecodeRequestedTiles(path);
+  statistics.decode_us += MonotonicClockUS() - poll_end;
 
   /* permanently disable the requested tiles which are still not
      loaded, to prevent trying to reload them over and over in a busy
@@ -444,8 +593,15 @@ RasterTileCache::UpdateTiles(const char *path, int x, int y, unsigned radius)
   for (auto it = request_tiles.begin(), end = request_tiles.end();
       it != end; ++it) {
     RasterTile &tile = tiles.GetLinear(*it);
-    if (tile.IsRequested() && !tile.IsEnabled())
+    if (!tile.IsRequested())
+      continue;
+
+    if (tile.IsEnabled()) {
+      ++statistics.tiles_loaded;
+    } else {
+      ++statistics.tiles_failed;
       tile.Clear();
+    }
   }
 
   ++serial;
@@ -557,3 +713,235 @@ RasterTileCache::LoadCache(FILE *file)
   scan_overview = false;
   return true;
 }
+
+void
+RasterTileCache::MakeTileStoreHeader(RasterTileStore::Header &header) const
+{
+  /* zero-fill all implicit padding bytes (to make valgrind happy) */
+  memset(&header, 0, sizeof(header));
+
+  header.version = RasterTileStore::Header::VERSION;
+  header.width = width;
+  header.height = height;
+  header.tile_width = tile_width;
+  header.tile_height = tile_height;
+  header.tile_columns = tiles.GetWidth();
+  header.tile_rows = tiles.GetHeight();
+  header.levels = RasterTile::MAX_LEVELS;
+}
+
+/**
+ * Write zero bytes until the file position is aligned for the
+ * #RasterTileStore.
+ */
+static bool
+PadTileStore(FILE *file, size_t position)
+{
+  static constexpr char zero[RasterTileStore::ALIGNMENT] = {};
+  const size_t n = RasterTileStore::Align(position) - position;
+  return n == 0 || fwrite(zero, 1, n, file) == n;
+}
+
+/**
+ * Returns the number of elements of the specified tile pyramid level.
+ */
+gcc_pure
+static size_t
+GetTileLevelSize(const RasterTile &tile, unsigned level)
+{
+  return RasterTileStore::GetLevelSize(tile.width, level) *
+    RasterTileStore::GetLevelSize(tile.height, level);
+}
+
+/**
+ * Write the specified number of "invalid" values, as a replacement
+ * for a tile which could not be decoded.
+ */
+static bool
+WriteInvalidTile(FILE *file, size_t size)
+{
+  const short invalid_value = RasterBuffer::TERRAIN_INVALID;
+  short invalid[256];
+  std::fill_n(invalid, ARRAY_SIZE(invalid), invalid_value);
+
+  while (size > 0) {
+    const size_t n = std::min(size, ARRAY_SIZE(invalid));
+    if (fwrite(invalid, sizeof(short), n, file) != n)
+      return false;
+
+    size -= n;
+  }
+
+  return true;
+}
+
+/**
+ * Write all levels of a decoded tile to the #RasterTileStore.
+ */
+static bool
+WriteTilePyramid(FILE *file, const RasterBuffer &buffer,
+                 const uint32_t *offsets)
+{
+  RasterBuffer levels[RasterTile::MAX_LEVELS];
+
+  const RasterBuffer *src = &buffer;
+  for (unsigned level = 0;; ++level) {
+    const size_t size = src->GetWidth() * src->GetHeight();
+    if (fwrite(src->GetData(), sizeof(short), size, file) != size ||
+        !PadTileStore(file, offsets[level] + size * sizeof(short)))
+      return false;
+
+    if (level == RasterTile::MAX_LEVELS)
+      return true;
+
+    levels[level].Downsample(*src);
+    src = &levels[level];
+  }
+}
+
+bool
+RasterTileCache::SaveTileStore(const char *path, FILE *file,
+                               OperationEnvironment &_operation)
+{
+  if (!initialised || scan_overview || store != nullptr)
+    return false;
+
+  const long header_offset = ftell(file);
+  if (header_offset < 0)
+    return false;
+
+  const unsigned num_tiles = tiles.GetSize();
+
+  RasterTileStore::Header header;
+  MakeTileStoreHeader(header);
+
+  /* calculate the position of each tile level within the file */
+
+  const unsigned num_levels = 1 + header.levels;
+  const unsigned num_offsets = header.GetNumOffsets();
+  AllocatedArray<uint32_t> offsets(num_offsets);
+  size_t position = RasterTileStore::GetDataOffset(header_offset,
+                                                   num_offsets);
+  for (unsigned i = 0; i < num_tiles; ++i) {
+    const RasterTile &tile = tiles.GetLinear(i);
+
+    for (unsigned level = 0; level < num_levels; ++level) {
+      uint32_t &offset = offsets[i * num_levels + level];
+      if (!tile.IsDefined()) {
+        offset = 0;
+        continue;
+      }
+
+      offset = position;
+      position = RasterTileStore::Align(position +
+                                        GetTileLevelSize(tile, level) *
+                                        sizeof(short));
+    }
+
+    /* FileMapping refuses to map more than 1 GB */
+    if (position > 1024 * 1024 * 1024)
+      return false;
+  }
+
+  if (fwrite(&header, sizeof(header), 1, file) != 1 ||
+      fwrite(offsets.begin(), sizeof(offsets[0]), num_offsets,
+             file) != num_offsets ||
+      !PadTileStore(file, header_offset + sizeof(header) +
+                    num_offsets * sizeof(offsets[0])))
+    return false;
+
+  /* decode the tiles in batches, and write them to the file */
+
+  for (auto it = tiles.begin(), end = tiles.end(); it != end; ++it)
+    it->ClearRequest();
+
+  _operation.SetProgressRange(num_tiles);
+
+  for (unsigned start = 0; start < num_tiles; start += MAX_ACTIVE_TILES) {
+    const unsigned end = std::min(start + MAX_ACTIVE_TILES, num_tiles);
+
+    for (unsigned i = start; i < end; ++i) {
+      RasterTile &tile = tiles.GetLinear(i);
+      if (tile.IsDefined())
+        tile.SetRequest();
+    }
+
+    DecodeRequestedTiles(path);
+
+    bool success = true;
+    for (unsigned i = start; i < end; ++i) {
+      RasterTile &tile = tiles.GetLinear(i);
+      if (!tile.IsDefined())
+        continue;
+
+      const uint32_t *tile_offsets = &offsets[i * num_levels];
+      if (tile.IsEnabled()) {
+        success = success &&
+          WriteTilePyramid(file, tile.buffer, tile_offsets);
+      } else {
+        /* decoder failure: fill with "invalid" values */
+        for (unsigned level = 0; success && level < num_levels; ++level) {
+          const size_t size = GetTileLevelSize(tile, level);
+          success = WriteInvalidTile(file, size) &&
+            PadTileStore(file, tile_offsets[level] + size * sizeof(short));
+        }
+      }
+
+      tile.Disable();
+      tile.ClearRequest();
+    }
+
+    if (!success)
+      return false;
+
+    _operation.SetProgressPosition(end);
+  }
+
+  return true;
+}
+
+bool
+RasterTileCache::LoadTileStore(const TCHAR *path, size_t header_offset)
+{
+  if (!initialised || scan_overview)
+    return false;
+
+  RasterTileStore::Header header;
+  MakeTileStoreHeader(header);
+
+  std::unique_ptr<RasterTileStore> new_store(new RasterTileStore(path));
+  if (!new_store->Open(header_offset, header))
+    return false;
+
+  const unsigned num_levels = 1 + new_store->GetLevels();
+
+  /* verify all tiles before modifying anything */
+  for (unsigned i = 0; i < tiles.GetSize(); ++i) {
+    const RasterTile &tile = tiles.GetLinear(i);
+    if (!tile.IsDefined())
+      continue;
+
+    for (unsigned level = 0; level < num_levels; ++level)
+      if (new_store->GetTile(i, level,
+                             GetTileLevelSize(tile, level)) == nullptr)
+        return false;
+  }
+
+  for (unsigned i = 0; i < tiles.GetSize(); ++i) {
+    RasterTile &tile = tiles.GetLinear(i);
+    tile.Disable();
+    if (!tile.IsDefined())
+      continue;
+
+    tile.EnableMapped(new_store->GetTile(i, 0, GetTileLevelSize(tile, 0)));
+    for (unsigned level = 1; level < num_levels; ++level)
+      tile.EnableMapped(level,
+                        new_store->GetTile(i, level,
+                                           GetTileLevelSize(tile, level)));
+  }
+
+  store = std::move(new_store);
+  dirty = false;
+  ++serial;
+  return true;
+}
@@ -26,11 +26,16 @@ Copyright_License {
 
 #include "RasterTile.hpp"
 #include "RasterLocation.hpp"
+#include "RasterTileStore.hpp"
+#include "RasterTileStatistics.hpp"
 #include "Geo/GeoBounds.hpp"
 #include "Util/NonCopyable.hpp"
 #include "Util/StaticArray.hpp"
 #include "Util/Serial.hpp"
 
+#include <memory>
+#include <atomic>
+
 #include <assert.h>
 #include <tchar.h>
 #include <stddef.h>
@@ -68,6 +73,11 @@ class RasterTileCache : private NonCopyable {
    */
   static constexpr unsigned INTERSECT_BITS = 7;
 
+  /**
+   * The maximum number of threads decoding tiles at a time.
+   */
+  static constexpr unsigned MAX_DECODER_THREADS = 4;
+
 public:
   /**
    * The fixed-point fractional part of sub-pixel coordinates.
@@ -148,11 +158,6 @@ protected:
 
   StaticArray<MarkerSegmentInfo, 8192> segments;
 
-  /**
-   * The number of remaining segments after the current one.
-   */
-  mutable unsigned remaining_segments;
-
   /**
    * An array that is used to sort the requested tiles by distance.
    * This is only used by PollTiles() internally, but is stored in the
@@ -165,14 +170,35 @@ protected:
    */
   OperationEnvironment *operation;
 
+  /**
+   * If this is set, then all tiles refer to pre-decoded data inside
+   * this file mapping, and the JPEG2000 file is never decoded again.
+   */
+  std::unique_ptr<RasterTileStore> store;
+
+  /**
+   * Counters which are updated by UpdateTiles().
+   */
+  RasterTileStatistics statistics;
+
+  /**
+   * Counters for GetInterpolatedHeight().  These are atomic because
+   * several readers may be using this object at a time.
+   */
+  mutable std::atomic<unsigned> fine_lookups, overview_lookups;
+
 public:
-  RasterTileCache():operation(NULL) {
+  RasterTileCache()
+    :operation(NULL), statistics(), fine_lookups(0), overview_lookups(0) {
     Reset();
   }
 
+  ~RasterTileCache();
+
 protected:
   void ScanTileLine(GridLocation start, GridLocation end,
-                    short *buffer, unsigned size, bool interpolate) const;
+                    short *buffer, unsigned size, bool interpolate,
+                    unsigned level) const;
 
 public:
   /**
@@ -196,15 +222,31 @@ public:
   short GetInterpolatedHeight(unsigned int lx,
                               unsigned int ly) const;
 
+  /**
+   * Determine the coarsest pyramid level (0 being the full
+   * resolution) whose pixels are not larger than the specified
+   * sample distance.  Downsampled levels are only available with a
+   * #RasterTileStore.
+   *
+   * @param spacing the distance between two samples in sub-pixels
+   */
+  gcc_pure
+  unsigned GetLevel(unsigned spacing) const;
+
   /**
    * Scan a straight line and fill the buffer with the specified
-   * number of samples along the line.
+   * number of samples along the line.  The data is read from the
+   * pyramid level which matches the distance between two samples
+   * (see GetLevel()).
    *
    * @param start the sub-pixel start location
    * @param end the sub-pixel end location
+   * @param max_level use no pyramid level coarser than this one,
+   * e.g. to match the distance between two scan lines
    */
   void ScanLine(const RasterLocation start, const RasterLocation end,
-                short *buffer, unsigned size, bool interpolate) const;
+                short *buffer, unsigned size, bool interpolate,
+                unsigned max_level=RasterTile::MAX_LEVELS) const;
 
   bool FirstIntersection(int origin_x, int origin_y,
                          int destination_x, int destination_y,
@@ -220,15 +262,59 @@ public:
                int destination_x, int destination_y,
                int h_origin, const int slope_fact) const;
 
+  /**
+   * Batch version of Intersection() for many lines starting at the
+   * same origin.  The lines are walked alternately, one sample each,
+   * and the terrain lookups of all lines are done back to back,
+   * which allows the CPU to overlap their memory latencies.  The
+   * results are the same as calling Intersection() for each line.
+   *
+   * @param destinations the end of each line
+   * @param slope_facts the slope factor of each line
+   * @param results receives the result of each line
+   */
+  void Intersection(int origin_x, int origin_y,
+                    const SignedRasterLocation *destinations,
+                    const int *slope_facts, unsigned n,
+                    int h_origin,
+                    SignedRasterLocation *results) const;
+
 protected:
-  void LoadJPG2000(const char *path);
+  /**
+   * Run the JPEG2000 decoder on the file.  While scanning the
+   * overview, all segments are parsed; later, only the tiles which
+   * are requested for the specified decoder are loaded.
+   *
+   * This method may be called from several threads at a time, each
+   * one with a different decoder index.  It does not modify the
+   * object on failure; the caller is responsible for calling Reset()
+   * after all decoders have finished.
+   *
+   * @return false if the file could not be opened
+   */
+  bool LoadJPG2000(const char *path, unsigned decoder=0);
+
+  /**
+   * Load all requested tiles, distributing them over several decoder
+   * threads.  Each thread parses the whole file, but skips the
+   * marker segments of tiles assigned to other threads.
+   */
+  void DecodeRequestedTiles(const char *path);
 
   /**
    * Load a world file (*.tfw or *.j2w).
    */
   bool LoadWorldFile(const TCHAR *path);
 
+  /**
+   * Set the geographic bounds of the map, unconditionally.
+   */
+  void StoreLatLonBounds(double lon_min, double lon_max,
+                         double lat_min, double lat_max);
+
 private:
+  class IntersectionWalk;
+
   /**
    * Get field (not interpolated) directly, without bringing tiles to front.
    * @param px X position/256
@@ -247,7 +333,46 @@ public:
   bool SaveCache(FILE *file) const;
   bool LoadCache(FILE *file);
 
-  void UpdateTiles(const char *path, int x, int y, unsigned radius);
+  /**
+   * Decode all tiles from the JPEG2000 file and write them to a
+   * #RasterTileStore file, together with their downsampled pyramid
+   * levels.  Tiles are decoded in batches of #MAX_ACTIVE_TILES and
+   * disabled again afterwards.
+   *
+   * @param path the JPEG2000 file
+   * @param file the destination file
+   */
+  bool SaveTileStore(const char *path, FILE *file,
+                     OperationEnvironment &operation);
+
+  /**
+   * Map a file written by SaveTileStore() into memory, and let all
+   * tiles refer to it.  After that, UpdateTiles() does not need to
+   * decode anything.
+   *
+   * @param header_offset the position of the tile store within the
+   * file
+   */
+  bool LoadTileStore(const TCHAR *path, size_t header_offset);
+
+  /**
+   * Are the tiles served from a #RasterTileStore?
+   */
+  bool IsTileStoreLoaded() const {
+    return store != nullptr;
+  }
+
+  /**
+   * Load the tiles around the specified location.
+   *
+   * @param prefetch further locations (in pixels), e.g. along the
+   * predicted flight path; the tiles around them are loaded after
+   * the ones around (x,y), as far as #MAX_ACTIVE_TILES permits
+   * @param prefetch_radius the radius around each prefetch location
+   */
+  void UpdateTiles(const char *path, int x, int y, unsigned radius,
+                   ConstBuffer<SignedRasterLocation> prefetch=nullptr,
+                   unsigned prefetch_radius=0);
 
   /**
    * Determines if there are still tiles scheduled to be loaded.  Call
@@ -266,6 +391,15 @@ public:
     return serial;
   }
 
+  /**
+   * Returns a snapshot of the counters, including the current memory
+   * usage.
+   */
+  gcc_pure
+  RasterTileStatistics GetStatistics() const;
+
+  void ResetStatistics();
+
   void Reset();
 
   const GeoBounds &GetBounds() const {
@@ -275,6 +409,8 @@ public:
   }
 
 private:
+  void MakeTileStoreHeader(RasterTileStore::Header &header) const;
+
   gcc_pure
   const MarkerSegmentInfo *
   FindMarkerSegment(uint32_t file_offset) const;
@@ -304,7 +440,9 @@ public:
   }
 
 protected:
-  bool PollTiles(int x, int y, unsigned radius);
+  bool PollTiles(int x, int y, unsigned radius,
+                 ConstBuffer<SignedRasterLocation> prefetch,
+                 unsigned prefetch_radius);
 
 public:
   short GetMaxElevation() const {
@@ -0,0 +1,111 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TERRAIN_RASTER_TILE_STATISTICS_HPP
+#define XCSOAR_TERRAIN_RASTER_TILE_STATISTICS_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Counters which describe how well #RasterTileCache performs.  They
+ * help tuning the number of active tiles and the loading radius for
+ * a device.
+ */
+struct RasterTileStatistics {
+  /**
+   * The number of tiles which were decoded successfully.
+   */
+  unsigned tiles_loaded;
+
+  /**
+   * The number of requested tiles which could not be decoded.
+   */
+  unsigned tiles_failed;
+
+  /**
+   * The number of loaded tiles which were discarded because there
+   * were too many of them.
+   */
+  unsigned tiles_evicted;
+
+  /**
+   * The total wall time spent decoding tiles [us].
+   */
+  uint64_t decode_us;
+
+  /**
+   * The number of RasterTileCache::PollTiles() calls.
+   */
+  unsigned polls;
+
+  /**
+   * The total and the maximum duration of RasterTileCache::PollTiles()
+   * [us].
+   */
+  uint64_t poll_us;
+  unsigned poll_max_us;
+
+  /**
+   * The number of RasterTileCache::GetInterpolatedHeight() calls
+   * which were served from a full-resolution tile, and from the
+   * overview.
+   */
+  unsigned fine_lookups, overview_lookups;
+
+  /**
+   * The number of tiles which are currently available.
+   */
+  unsigned resident_tiles;
+
+  /**
+   * The memory allocated for decoded tiles [bytes].  Tiles mapped
+   * from a #RasterTileStore are not included.
+   */
+  size_t resident_bytes;
+
+  void Clear() {
+    *this = RasterTileStatistics();
+  }
+
+  /**
+   * Returns the average time for decoding one tile [us].
+   */
+  unsigned GetDecodeTimePerTile() const {
+    return tiles_loaded > 0
+      ? unsigned(decode_us / tiles_loaded)
+      : 0;
+  }
+
+  /**
+   * Returns the average duration of RasterTileCache::PollTiles()
+   * [us].
+   */
+  unsigned GetAveragePollTime() const {
+    return polls > 0
+      ? unsigned(poll_us / polls)
+      : 0;
+  }
+};
+
+#endif
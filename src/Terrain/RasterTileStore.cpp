@@ -0,0 +1,65 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Terrain/RasterTileStore.hpp"
+
+bool
+RasterTileStore::Open(size_t header_offset, const Header &expected)
+{
+  if (mapping.error())
+    return false;
+
+  if (mapping.size() < header_offset + sizeof(Header))
+    return false;
+
+  const Header &header = *(const Header *)mapping.at(header_offset);
+  if (header.version != Header::VERSION ||
+      header.width != expected.width ||
+      header.height != expected.height ||
+      header.tile_width != expected.tile_width ||
+      header.tile_height != expected.tile_height ||
+      header.tile_columns != expected.tile_columns ||
+      header.tile_rows != expected.tile_rows ||
+      header.levels > expected.levels ||
+      mapping.size() < GetDataOffset(header_offset, header.GetNumOffsets()))
+    return false;
+
+  offsets = (const uint32_t *)mapping.at(header_offset + sizeof(header));
+  num_tiles = header.tile_columns * header.tile_rows;
+  levels = header.levels;
+  return true;
+}
+
+const short *
+RasterTileStore::GetTile(unsigned index, unsigned level, size_t size) const
+{
+  if (index >= num_tiles || level > levels)
+    return nullptr;
+
+  const size_t offset = offsets[index * (1 + levels) + level];
+  if (offset == 0 || offset % ALIGNMENT != 0 ||
+      offset + size * sizeof(short) > mapping.size())
+    return nullptr;
+
+  return (const short *)mapping.at(offset);
+}
@@ -0,0 +1,142 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TERRAIN_RASTER_TILE_STORE_HPP
+#define XCSOAR_TERRAIN_RASTER_TILE_STORE_HPP
+
+#include "OS/FileMapping.hpp"
+#include "Util/NonCopyable.hpp"
+#include "Compiler.h"
+
+#include <tchar.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * A file containing all terrain tiles, already decoded, which gets
+ * mapped into memory.  It is generated once from the JPEG2000 file
+ * (see RasterTileCache::SaveTileStore()), and afterwards, the
+ * #RasterTile buffers point straight into the mapping, leaving all
+ * paging to the kernel.
+ *
+ * File layout: a #Header (which may be preceded by arbitrary data,
+ * e.g. the #FileCache header), followed by 1+Header::levels 32 bit
+ * file offsets per tile (0 if the tile is not defined), followed by
+ * the tile data (native byte order, rows of "short" values).  Each
+ * tile begins at a file offset which is a multiple of #ALIGNMENT.
+ *
+ * Level 0 is the full resolution tile; each following level is
+ * downsampled by factor 2 from the previous one (see
+ * RasterBuffer::Downsample()).  Together, they form a pyramid which
+ * allows scanning the map at low zoom levels without touching all
+ * of the full resolution data.
+ */
+class RasterTileStore : private NonCopyable {
+public:
+  static constexpr size_t ALIGNMENT = 16;
+
+  struct Header {
+    static constexpr uint32_t VERSION = 2;
+
+    uint32_t version;
+    uint32_t width, height;
+    uint32_t tile_width, tile_height;
+    uint32_t tile_columns, tile_rows;
+
+    /**
+     * The number of downsampled levels stored for each tile (in
+     * addition to the full resolution level 0).
+     */
+    uint32_t levels;
+
+    unsigned GetNumOffsets() const {
+      return tile_columns * tile_rows * (1 + levels);
+    }
+  };
+
+private:
+  FileMapping mapping;
+
+  const uint32_t *offsets;
+  unsigned num_tiles, levels;
+
+public:
+  explicit RasterTileStore(const TCHAR *path)
+    :mapping(path), offsets(nullptr), num_tiles(0), levels(0) {}
+
+  static constexpr size_t Align(size_t size) {
+    return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+  }
+
+  /**
+   * Calculate the file offset of the first tile.
+   *
+   * @param header_offset the file offset of the #Header
+   * @param num_offsets the number of entries in the offset table,
+   * see Header::GetNumOffsets()
+   */
+  static constexpr size_t GetDataOffset(size_t header_offset,
+                                        unsigned num_offsets) {
+    return Align(header_offset + sizeof(Header) +
+                 num_offsets * sizeof(uint32_t));
+  }
+
+  /**
+   * Calculate the size of a tile dimension at the specified pyramid
+   * level.
+   */
+  static constexpr unsigned GetLevelSize(unsigned size, unsigned level) {
+    return (size + (1u << level) - 1) >> level;
+  }
+
+  /**
+   * Verify the file header and initialise the tile table.
+   *
+   * @param header_offset the position of the #Header within the
+   * file
+   * @param expected the header contents which must match the file;
+   * its "levels" attribute is the maximum number of levels accepted
+   * @return false if the file is not usable
+   */
+  bool Open(size_t header_offset, const Header &expected);
+
+  /**
+   * Returns the number of downsampled levels per tile.
+   */
+  unsigned GetLevels() const {
+    return levels;
+  }
+
+  /**
+   * Returns a pointer to the data of the specified tile, or nullptr
+   * if the tile is not present or its data does not fit into the
+   * file.
+   *
+   * @param level the pyramid level, 0 being full resolution
+   * @param size the expected number of elements
+   */
+  gcc_pure
+  const short *GetTile(unsigned index, unsigned level, size_t size) const;
+};
+
+#endif
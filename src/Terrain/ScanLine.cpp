@@ -24,6 +24,8 @@ Copyright_License {
 #include "Terrain/RasterTileCache.hpp"
 #include "Terrain/RasterLocation.hpp"
 
+#include <algorithm>
+
 #include <stdlib.h>
 
 struct GridLocation : public RasterLocation {
@@ -262,7 +264,7 @@ NextGridIntersection(const GridRay &ray,
 inline void
 RasterTileCache::ScanTileLine(GridLocation start, GridLocation end,
                               short *buffer, unsigned size,
-                              bool interpolate) const
+                              bool interpolate, unsigned level) const
 {
   assert(end.index >= start.index);
   assert(end.index <= size);
@@ -300,7 +302,7 @@ RasterTileCache::ScanTileLine(GridLocation start, GridLocation end,
   if (tile.IsEnabled())
     tile.ScanLine(start.x, start.y, end.x, end.y,
                   buffer + start.index, end.index - start.index,
-                  interpolate);
+                  interpolate, level);
   else
     /* need range checking in the overview buffer because its size may
        be rounded down, and then the "fine" location may exceed its
@@ -312,10 +314,23 @@ RasterTileCache::ScanTileLine(GridLocation start, GridLocation end,
                              interpolate);
 }
 
+unsigned
+RasterTileCache::GetLevel(unsigned spacing) const
+{
+  const unsigned max_level = store != nullptr ? store->GetLevels() : 0;
+
+  unsigned level = 0;
+  while (level < max_level && spacing >= (2u << (level + 8)))
+    ++level;
+
+  return level;
+}
+
 void
 RasterTileCache::ScanLine(const RasterLocation _start,
                           const RasterLocation _end,
-                          short *buffer, unsigned size, bool interpolate) const
+                          short *buffer, unsigned size, bool interpolate,
+                          unsigned max_level) const
 {
   assert(_start.x < GetFineWidth());
   assert(_start.y < GetFineHeight());
@@ -329,10 +344,15 @@ RasterTileCache::ScanLine(const RasterLocation _start,
   assert(ray.start.index == 0);
   assert(ray.end.index == size);
 
+  const unsigned dx = abs((int)_end.x - (int)_start.x);
+  const unsigned dy = abs((int)_end.y - (int)_start.y);
+  const unsigned level = std::min(GetLevel(std::max(dx, dy) / size),
+                                  max_level);
+
   GridLocation current = ray.start;
   while (current.index < size) {
     GridLocation next = NextGridIntersection(ray, current);
-    ScanTileLine(current, next, buffer, size, interpolate);
+    ScanTileLine(current, next, buffer, size, interpolate, level);
     current = next;
   }
 }
@@ -294,6 +294,9 @@ TerrainRenderer::TerrainRenderer(const RasterTerrain &_terrain)
    last_color_ramp(nullptr)
 {
   settings.SetDefaults();
+#ifdef ENABLE_OPENGL
+  last_settings = settings;
+#endif
 }
 
 void
@@ -338,6 +341,15 @@ TerrainRenderer::Generate(const WindowProjection &map_projection,
     /* no change since previous frame */
     return;
 
+  /* if only the map location has changed, the previous height matrix
+     and image can be scrolled, and only the exposed strips need to be
+     scanned and rendered */
+  const bool may_scroll = old_bounds.IsValid() &&
+    terrain_serial == terrain.GetSerial() &&
+    sunazimuth.CompareRoughly(last_sun_azimuth) &&
+    settings == last_settings;
+  last_settings = settings;
+
 #else
   if (compare_projection.Compare(map_projection) &&
       terrain_serial == terrain.GetSerial() &&
@@ -370,7 +382,10 @@ TerrainRenderer::Generate(const WindowProjection &map_projection,
 
   {
     RasterTerrain::Lease map(terrain);
-    raster_renderer.ScanMap(map, map_projection);
+#ifdef ENABLE_OPENGL
+    if (!may_scroll || !raster_renderer.ScrollMap(map, map_projection))
+#endif
+      raster_renderer.ScanMap(map, map_projection);
   }
 
   raster_renderer.GenerateImage(do_shading, height_scale,
@@ -52,6 +52,14 @@ protected:
 
   Angle last_sun_azimuth;
 
+#ifdef ENABLE_OPENGL
+  /**
+   * The settings which were used to generate the current image.  The
+   * image may only be scrolled if they have not changed.
+   */
+  TerrainRendererSettings last_settings;
+#endif
+
   const ColorRamp *last_color_ramp;
 
   RasterRenderer raster_renderer;
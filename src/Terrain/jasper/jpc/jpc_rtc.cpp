@@ -1,7 +1,9 @@
 #include "jasper/jpc_rtc.h"
 #include "Terrain/RasterTileCache.hpp"
 
-RasterTileCache *raster_tile_current = 0;
+/* each decoder thread has its own "current" object, see
+   RasterTileCache::DecodeRequestedTiles() */
+thread_local RasterTileCache *raster_tile_current = 0;
 
 extern "C" {
 
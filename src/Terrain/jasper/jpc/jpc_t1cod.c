@@ -235,6 +235,9 @@ int JPC_ISTERMINATED(int passno, int firstpassno, int numpasses, int termall,
 
 void jpc_initluts()
 {
+	/* XCSoar: initialise only once, because several decoder threads
+	   may be reading the tables at a time */
+	static int initialised = 0;
 	int i;
 	int orient;
 	int refine;
@@ -242,6 +245,9 @@ void jpc_initluts()
 	float v;
 	float t;
 
+	if (initialised)
+		return;
+
 /* XXX - hack */
 jpc_initmqctxs();
 
@@ -282,6 +288,8 @@ jpc_initmqctxs();
 /* XXX - this calc is not correct */
 		jpc_refnmsedec0[i] = jpc_dbltofix(floor((u * u) * jpc_pow2i(JPC_NMSEDEC_FRACBITS) + 0.5) / jpc_pow2i(JPC_NMSEDEC_FRACBITS));
 	}
+
+	initialised = 1;
 }
 
 jpc_fix_t jpc_getsignmsedec_func(jpc_fix_t x, int bitpos)
@@ -0,0 +1,117 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Parallel.hpp"
+#include "Thread.hpp"
+#include "Util/StaticArray.hpp"
+
+#include <atomic>
+#include <algorithm>
+
+#ifdef HAVE_POSIX
+#include <unistd.h>
+#else
+#include <windows.h>
+#endif
+
+unsigned
+GetProcessorCount()
+{
+#ifdef HAVE_POSIX
+#ifdef _SC_NPROCESSORS_ONLN
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  if (n > 0)
+    return n;
+#endif
+  return 1;
+#else
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return std::max(info.dwNumberOfProcessors, DWORD(1));
+#endif
+}
+
+/**
+ * Fetch indexes from the shared counter until all have been consumed.
+ */
+static void
+ParallelForWork(std::atomic_uint &next, unsigned n,
+                const std::function<void(unsigned)> &f)
+{
+  unsigned i;
+  while ((i = next++) < n)
+    f(i);
+}
+
+class ParallelForThread final : public Thread {
+  std::atomic_uint &next;
+  const unsigned n;
+  const std::function<void(unsigned)> &f;
+
+public:
+  ParallelForThread(std::atomic_uint &_next, unsigned _n,
+                    const std::function<void(unsigned)> &_f)
+    :Thread("ParallelFor"), next(_next), n(_n), f(_f) {}
+
+protected:
+  /* virtual methods from class Thread */
+  void Run() override {
+    ParallelForWork(next, n, f);
+  }
+};
+
+void
+ParallelFor(unsigned n, unsigned max_threads,
+            const std::function<void(unsigned)> &f)
+{
+  static constexpr unsigned MAX_THREADS = 16;
+
+  max_threads = std::min(std::min(max_threads, n), MAX_THREADS);
+
+  if (max_threads <= 1) {
+    /* fast path: no threads */
+    for (unsigned i = 0; i < n; ++i)
+      f(i);
+    return;
+  }
+
+  std::atomic_uint next(0);
+
+  StaticArray<ParallelForThread *, MAX_THREADS> threads;
+  for (unsigned i = 1; i < max_threads; ++i) {
+    ParallelForThread *thread = new ParallelForThread(next, n, f);
+    if (!thread->Start()) {
+      delete thread;
+      break;
+    }
+
+    threads.append(thread);
+  }
+
+  ParallelForWork(next, n, f);
+
+  for (ParallelForThread *thread : threads) {
+    thread->Join();
+    delete thread;
+  }
+}
@@ -0,0 +1,52 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_THREAD_PARALLEL_HPP
+#define XCSOAR_THREAD_PARALLEL_HPP
+
+#include "Compiler.h"
+
+#include <functional>
+
+/**
+ * Determine the number of processors which are online.  Returns 1
+ * if that is unknown.
+ */
+gcc_pure
+unsigned
+GetProcessorCount();
+
+/**
+ * Invoke the given function once for each index in the range
+ * [0, n), distributed over up to #max_threads threads (the calling
+ * thread being one of them), and wait until all invocations have
+ * finished.
+ *
+ * The function must be thread-safe.  If a thread cannot be created,
+ * the remaining threads do its share of the work.
+ */
+void
+ParallelFor(unsigned n, unsigned max_threads,
+            const std::function<void(unsigned)> &f);
+
+#endif
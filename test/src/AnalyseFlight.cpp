@@ -22,6 +22,7 @@
 
 #include "Engine/Trace/Trace.hpp"
 #include "Contest/ContestManager.hpp"
+#include "Thread/Parallel.hpp"
 #include "OS/Args.hpp"
 #include "Computer/CirclingComputer.hpp"
 #include "DebugReplay.hpp"
@@ -178,6 +179,7 @@ SolveContest(Contest contest,
              Trace &full_trace, Trace &triangle_trace, Trace &sprint_trace)
 {
   ContestManager manager(contest, full_trace, triangle_trace, sprint_trace);
+  manager.SetMaxThreads(GetProcessorCount());
   manager.SolveExhaustive();
   return manager.GetStats();
 }
@@ -0,0 +1,468 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * Measure the contest optimisers on a set of IGC files.  Each flight
+ * is replayed into a fresh ContestManager for each contest, and the
+ * time spent in the solvers (including the trace updates), their
+ * iterations, their memory usage and the final scores are recorded.
+ * The results can be saved as a baseline, and a later run can be
+ * compared against it.
+ */
+
+#include "ContestReplay.hpp"
+#include "Engine/Trace/Trace.hpp"
+#include "Contest/ContestManager.hpp"
+#include "Thread/Parallel.hpp"
+#include "OS/Args.hpp"
+#include "OS/Clock.hpp"
+#include "IO/FileLineReader.hpp"
+#include "IO/TextWriter.hpp"
+#include "Util/Macros.hpp"
+#include "Util/StringUtil.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct Measurement {
+  const char *file;
+  const ContestInfo *contest;
+
+  ContestStatistics stats;
+
+  /**
+   * The fastest of all repetitions.
+   */
+  uint64_t duration_us;
+
+  unsigned iterations;
+  size_t memory;
+};
+
+/**
+ * A line of the baseline file: the file name, the contest name, the
+ * duration [us], the iterations, the memory usage [bytes] and one
+ * score per result slot ("-" for unused slots).
+ */
+struct BaselineEntry {
+  std::string file, contest;
+  uint64_t duration_us;
+  unsigned iterations;
+  size_t memory;
+  std::string scores[3];
+};
+
+static void
+FormatScore(char *buffer, size_t size, const ContestInfo &info,
+            const ContestStatistics &stats, unsigned i)
+{
+  if (info.variants[i] != nullptr)
+    snprintf(buffer, size, "%.3f", (double)stats.result[i].score);
+  else
+    strcpy(buffer, "-");
+}
+
+gcc_pure
+static bool
+ScoresEqual(const ContestStatistics &a, const ContestStatistics &b)
+{
+  for (unsigned i = 0; i < ARRAY_SIZE(a.result); ++i)
+    if (a.result[i].score != b.result[i].score)
+      return false;
+
+  return true;
+}
+
+/**
+ * Solve the flight once and update the measurement.
+ *
+ * @param first true for the first repetition
+ * @return false if the scores differ from the previous repetition
+ */
+static bool
+Measure(const ContestFlight &flight, const TraceSizes &trace_sizes,
+        unsigned max_threads, bool first, Measurement &m)
+{
+  Trace full_trace(0, Trace::null_time, trace_sizes.full);
+  Trace triangle_trace(0, Trace::null_time, trace_sizes.triangle);
+  Trace sprint_trace(0, 9000, trace_sizes.sprint);
+
+  ContestManager manager(m.contest->contest,
+                         full_trace, triangle_trace, sprint_trace);
+  manager.SetMaxThreads(max_threads);
+  ContestManager *const idle_manager = &manager;
+  const bool idle = UsesSprintTrace(m.contest->contest);
+
+  const uint64_t start_time = MonotonicClockUS();
+
+  ReplayContestFlight(flight, full_trace, triangle_trace, sprint_trace,
+                      &idle_manager, idle ? 1 : 0);
+  manager.SolveExhaustive();
+
+  const uint64_t duration = MonotonicClockUS() - start_time;
+
+  /* the scores must not vary; with several threads, the iterations
+     and the memory usage depend on the timing of the workers, and
+     the last repetition's values are reported */
+  const ContestStatistics &stats = manager.GetStats();
+  const bool equal = first || ScoresEqual(stats, m.stats);
+
+  m.duration_us = std::min(m.duration_us, duration);
+  m.stats = stats;
+  m.iterations = manager.GetIterations();
+  m.memory = manager.GetMemoryUsage();
+  return equal;
+}
+
+static void
+PrintMeasurement(const Measurement &m)
+{
+  printf("%-24s %-12s %10.1f %12u %10u",
+         m.file, m.contest->name, m.duration_us / 1000.,
+         m.iterations, unsigned(m.memory / 1024));
+
+  for (unsigned i = 0; i < ARRAY_SIZE(m.contest->variants); ++i)
+    if (m.contest->variants[i] != nullptr)
+      printf(" %s=%.3f", m.contest->variants[i],
+             (double)m.stats.result[i].score);
+
+  putchar('\n');
+}
+
+static void
+PrintTotals(const std::vector<const ContestInfo *> &contests,
+            const std::vector<Measurement> &measurements)
+{
+  printf("\n%-12s %10s %12s %10s\n", "total", "ms", "iterations", "peak_KiB");
+
+  for (const ContestInfo *info : contests) {
+    uint64_t duration_us = 0, iterations = 0;
+    size_t memory = 0;
+
+    for (const auto &m : measurements) {
+      if (m.contest != info)
+        continue;
+
+      duration_us += m.duration_us;
+      iterations += m.iterations;
+      memory = std::max(memory, m.memory);
+    }
+
+    printf("%-12s %10.1f %12llu %10u\n", info->name, duration_us / 1000.,
+           (unsigned long long)iterations, unsigned(memory / 1024));
+  }
+}
+
+static bool
+WriteBaseline(const char *path, const std::vector<Measurement> &measurements)
+{
+  TextWriter writer(path);
+  if (!writer.IsOpen())
+    return false;
+
+  for (const auto &m : measurements) {
+    char scores[ARRAY_SIZE(m.contest->variants)][32];
+    for (unsigned i = 0; i < ARRAY_SIZE(scores); ++i)
+      FormatScore(scores[i], sizeof(scores[i]), *m.contest, m.stats, i);
+
+    writer.FormatLine("%s\t%s\t%llu\t%u\t%lu\t%s\t%s\t%s",
+                      m.file, m.contest->name,
+                      (unsigned long long)m.duration_us, m.iterations,
+                      (unsigned long)m.memory,
+                      scores[0], scores[1], scores[2]);
+  }
+
+  return writer.Flush();
+}
+
+/**
+ * Split the line at tabs.
+ *
+ * @return the number of fields
+ */
+static unsigned
+SplitFields(char *line, char **fields, unsigned max_fields)
+{
+  unsigned n = 0;
+  while (n < max_fields) {
+    fields[n++] = line;
+
+    char *tab = strchr(line, '\t');
+    if (tab == nullptr)
+      break;
+
+    *tab = 0;
+    line = tab + 1;
+  }
+
+  return n;
+}
+
+static bool
+ReadBaseline(const char *path, std::vector<BaselineEntry> &entries)
+{
+  FileLineReaderA reader(path);
+  if (reader.error())
+    return false;
+
+  char *line;
+  while ((line = reader.ReadLine()) != nullptr) {
+    char *fields[8];
+    if (SplitFields(line, fields, ARRAY_SIZE(fields)) != ARRAY_SIZE(fields))
+      continue;
+
+    BaselineEntry entry;
+    entry.file = fields[0];
+    entry.contest = fields[1];
+    entry.duration_us = strtoull(fields[2], nullptr, 10);
+    entry.iterations = strtoul(fields[3], nullptr, 10);
+    entry.memory = strtoul(fields[4], nullptr, 10);
+    for (unsigned i = 0; i < ARRAY_SIZE(entry.scores); ++i)
+      entry.scores[i] = fields[5 + i];
+
+    entries.push_back(std::move(entry));
+  }
+
+  return true;
+}
+
+gcc_pure
+static const BaselineEntry *
+FindBaseline(const std::vector<BaselineEntry> &entries, const Measurement &m)
+{
+  for (const auto &entry : entries)
+    if (entry.file == m.file && entry.contest == m.contest->name)
+      return &entry;
+
+  return nullptr;
+}
+
+static double
+Ratio(double value, double baseline)
+{
+  return baseline > 0 ? value / baseline : 1;
+}
+
+/**
+ * Print the differences to the baseline.
+ *
+ * @return false if a score has changed
+ */
+static bool
+CompareBaseline(const std::vector<const ContestInfo *> &contests,
+                const std::vector<Measurement> &measurements,
+                const std::vector<BaselineEntry> &entries)
+{
+  bool scores_equal = true;
+
+  printf("\n%-24s %-12s %10s %12s %10s\n",
+         "baseline", "contest", "time", "iterations", "memory");
+
+  for (const auto &m : measurements) {
+    const BaselineEntry *entry = FindBaseline(entries, m);
+    if (entry == nullptr) {
+      printf("%-24s %-12s not in baseline\n", m.file, m.contest->name);
+      continue;
+    }
+
+    printf("%-24s %-12s %9.2fx %11.2fx %9.2fx",
+           m.file, m.contest->name,
+           Ratio(m.duration_us, entry->duration_us),
+           Ratio(m.iterations, entry->iterations),
+           Ratio(m.memory, entry->memory));
+
+    for (unsigned i = 0; i < ARRAY_SIZE(entry->scores); ++i) {
+      char score[32];
+      FormatScore(score, sizeof(score), *m.contest, m.stats, i);
+      if (entry->scores[i] != score) {
+        printf(" %s: %s -> %s", m.contest->variants[i] != nullptr
+               ? m.contest->variants[i] : "?",
+               entry->scores[i].c_str(), score);
+        scores_equal = false;
+      }
+    }
+
+    putchar('\n');
+  }
+
+  for (const ContestInfo *info : contests) {
+    uint64_t duration_us = 0, baseline_us = 0;
+    uint64_t iterations = 0, baseline_iterations = 0;
+
+    for (const auto &m : measurements) {
+      const BaselineEntry *entry;
+      if (m.contest != info || (entry = FindBaseline(entries, m)) == nullptr)
+        continue;
+
+      duration_us += m.duration_us;
+      baseline_us += entry->duration_us;
+      iterations += m.iterations;
+      baseline_iterations += entry->iterations;
+    }
+
+    printf("%-24s %-12s %9.2fx %11.2fx\n", "total", info->name,
+           Ratio(duration_us, baseline_us),
+           Ratio(iterations, baseline_iterations));
+  }
+
+  puts(scores_equal ? "\nAll scores match the baseline."
+       : "\nSome scores differ from the baseline.");
+  return scores_equal;
+}
+
+int main(int argc, char **argv)
+{
+  std::vector<const ContestInfo *> contests;
+  unsigned repeat = 1, max_threads = 1;
+  const TraceSizes *trace_sizes = &default_trace_sizes;
+  const char *baseline_path = nullptr, *write_baseline_path = nullptr;
+
+  Args args(argc, argv,
+            "[options] FILE_OR_DIRECTORY...\n"
+            "Options:\n"
+            "  --contest=NAME           Measure this contest (may be repeated, default = all)\n"
+            "  --repeat=N               Solve each flight N times, keep the fastest (default = 1)\n"
+            "  --threads=N              Threads used by the exhaustive search (default = 1)\n"
+            "  --high-resolution        Don't thin the traces of flights up to ten hours\n"
+            "  --baseline=FILE          Compare the results with this baseline\n"
+            "  --write-baseline=FILE    Save the results as a baseline\n"
+            "Contests:\n"
+            "  olc_sprint olc_fai olc_classic olc_league olc_plus\n"
+            "  xcontest dhv_xc sis_at netcoupe dmst");
+
+  const char *arg;
+  while ((arg = args.PeekNext()) != nullptr && *arg == '-') {
+    args.Skip();
+
+    const char *value;
+    if ((value = StringAfterPrefix(arg, "--contest=")) != nullptr) {
+      const ContestInfo *info = FindContest(value);
+      if (info == nullptr) {
+        fprintf(stderr, "Unknown contest: %s\n", value);
+        args.UsageError();
+      }
+
+      contests.push_back(info);
+
+    } else if ((value = StringAfterPrefix(arg, "--repeat=")) != nullptr) {
+      repeat = strtoul(value, NULL, 10);
+      if (repeat == 0) {
+        fputs("The repeat parameter could not be parsed correctly.\n",
+              stderr);
+        args.UsageError();
+      }
+
+    } else if ((value = StringAfterPrefix(arg, "--threads=")) != nullptr) {
+      max_threads = strtoul(value, NULL, 10);
+      if (max_threads == 0) {
+        fputs("The threads parameter could not be parsed correctly.\n",
+              stderr);
+        args.UsageError();
+      }
+
+    } else if (strcmp(arg, "--high-resolution") == 0) {
+      trace_sizes = &high_resolution_trace_sizes;
+
+    } else if ((value = StringAfterPrefix(arg, "--baseline=")) != nullptr) {
+      baseline_path = value;
+
+    } else if ((value = StringAfterPrefix(arg,
+                                          "--write-baseline=")) != nullptr) {
+      write_baseline_path = value;
+
+    } else {
+      args.UsageError();
+    }
+  }
+
+  if (contests.empty())
+    for (const ContestInfo *info = contest_infos; info->name != nullptr; ++info)
+      contests.push_back(info);
+
+  if (args.IsEmpty())
+    args.UsageError();
+
+  std::vector<std::string> files;
+  while (!args.IsEmpty())
+    CollectIGCFiles(args.ExpectNext(), files);
+
+  std::sort(files.begin(), files.end());
+
+  std::vector<BaselineEntry> baseline;
+  if (baseline_path != nullptr && !ReadBaseline(baseline_path, baseline)) {
+    fprintf(stderr, "Failed to read %s\n", baseline_path);
+    return EXIT_FAILURE;
+  }
+
+  printf("# %u solver threads, %u CPUs\n",
+         max_threads, GetProcessorCount());
+  printf("%-24s %-12s %10s %12s %10s scores\n",
+         "file", "contest", "ms", "iterations", "peak_KiB");
+
+  std::vector<Measurement> measurements;
+  bool stable = true;
+  for (const auto &file : files) {
+    ContestFlight flight;
+    if (!LoadContestFlight(file.c_str(), flight)) {
+      fprintf(stderr, "Failed to open %s\n", file.c_str());
+      continue;
+    }
+
+    for (const ContestInfo *info : contests) {
+      Measurement m;
+      m.file = file.c_str();
+      m.contest = info;
+      m.duration_us = UINT64_MAX;
+
+      for (unsigned i = 0; i < repeat; ++i) {
+        if (!Measure(flight, *trace_sizes, max_threads, i == 0, m)) {
+          fprintf(stderr, "%s %s: the scores differ between repetitions\n",
+                  m.file, info->name);
+          stable = false;
+        }
+      }
+
+      PrintMeasurement(m);
+      measurements.push_back(m);
+    }
+  }
+
+  PrintTotals(contests, measurements);
+
+  if (write_baseline_path != nullptr &&
+      !WriteBaseline(write_baseline_path, measurements)) {
+    fprintf(stderr, "Failed to write %s\n", write_baseline_path);
+    return EXIT_FAILURE;
+  }
+
+  if (baseline_path != nullptr &&
+      !CompareBaseline(contests, measurements, baseline))
+    return EXIT_FAILURE;
+
+  return stable ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,86 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Terrain/Kernel/Optimised.hpp"
+#include "OS/Clock.hpp"
+
+#include <stdio.h>
+
+static constexpr unsigned WIDTH = 800, HEIGHT = 480;
+static constexpr unsigned ITERATIONS = 200;
+
+static short heights[WIDTH * HEIGHT];
+static uint8_t color_index[WIDTH], contour[WIDTH];
+static int8_t illumination[WIDTH];
+
+/**
+ * Simulate what RasterRenderer::GenerateSlopeImage() does, with the
+ * specified kernel implementation.
+ */
+template<typename Kernels>
+static unsigned
+Run(const SlopeShadingParameters &params)
+{
+  const unsigned q = 1;
+  unsigned sum = 0;
+
+  const unsigned start_time = MonotonicClockMS();
+
+  for (unsigned i = 0; i < ITERATIONS; ++i) {
+    for (unsigned y = q; y < HEIGHT - q; ++y) {
+      const short *src = heights + y * WIDTH;
+
+      Kernels::HeightIndices(src, WIDTH, 4, 8, color_index, contour);
+      Kernels::Illumination(src + q, q * WIDTH, q * WIDTH, q, 2 * q,
+                            WIDTH - 2 * q, params, illumination + q);
+
+      /* prevent gcc from optimizing this loop away */
+      sum += color_index[y] + contour[y] + illumination[y];
+    }
+  }
+
+  printf("%u ms\n", MonotonicClockMS() - start_time);
+  return sum;
+}
+
+int main(int argc, char **argv)
+{
+  for (unsigned y = 0; y < HEIGHT; ++y)
+    for (unsigned x = 0; x < WIDTH; ++x)
+      heights[y * WIDTH + x] = 500 + (x * x + y * 3) % 700;
+
+  SlopeShadingParameters params;
+  params.sx = -130;
+  params.sy = 170;
+  params.sz = 120;
+  params.contrast = 160;
+  params.height_slope_factor = 60;
+
+  printf("portable: ");
+  const unsigned a = Run<PortableRasterKernels>(params);
+
+  printf("optimised: ");
+  const unsigned b = Run<RasterKernels>(params);
+
+  return a == b ? 0 : 1;
+}
@@ -0,0 +1,157 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "ContestReplay.hpp"
+#include "DebugReplayIGC.hpp"
+#include "Engine/Trace/Trace.hpp"
+#include "Contest/ContestManager.hpp"
+#include "OS/FileUtil.hpp"
+#include "OS/PathName.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+class IGCFileCollector : public File::Visitor {
+  std::vector<std::string> &files;
+
+public:
+  IGCFileCollector(std::vector<std::string> &_files):files(_files) {}
+
+  void Visit(const TCHAR *path, const TCHAR *filename) override {
+    files.emplace_back(path);
+  }
+};
+
+void
+CollectIGCFiles(const char *path, std::vector<std::string> &files)
+{
+  if (Directory::Exists(path)) {
+    IGCFileCollector collector(files);
+    Directory::VisitSpecificFiles(path, "*.igc", collector, true);
+  } else if (MatchesExtension(path, ".igc"))
+    files.emplace_back(path);
+  else
+    fprintf(stderr, "Ignoring %s\n", path);
+}
+
+const ContestInfo contest_infos[] = {
+  { "olc_sprint", Contest::OLC_SPRINT, { "sprint", nullptr, nullptr } },
+  { "olc_fai", Contest::OLC_FAI, { "fai", nullptr, nullptr } },
+  { "olc_classic", Contest::OLC_CLASSIC, { "classic", nullptr, nullptr } },
+  { "olc_league", Contest::OLC_LEAGUE, { "league", "classic", nullptr } },
+  { "olc_plus", Contest::OLC_PLUS, { "classic", "triangle", "plus" } },
+  { "xcontest", Contest::XCONTEST, { "free", "triangle", nullptr } },
+  { "dhv_xc", Contest::DHV_XC, { "free", "triangle", nullptr } },
+  { "sis_at", Contest::SIS_AT, { "sis_at", nullptr, nullptr } },
+  { "netcoupe", Contest::NET_COUPE, { "netcoupe", nullptr, nullptr } },
+  { "dmst", Contest::DMST, { "quadrilateral", nullptr, nullptr } },
+  { nullptr, Contest::NONE, { nullptr, nullptr, nullptr } },
+};
+
+const ContestInfo *
+FindContest(const char *name)
+{
+  for (const ContestInfo *info = contest_infos; info->name != nullptr; ++info)
+    if (strcmp(info->name, name) == 0)
+      return info;
+
+  return nullptr;
+}
+
+bool
+UsesSprintTrace(Contest contest)
+{
+  return contest == Contest::OLC_SPRINT || contest == Contest::OLC_LEAGUE;
+}
+
+bool
+LoadContestFlight(const char *path, ContestFlight &flight)
+{
+  DebugReplay *replay = DebugReplayIGC::Create(path);
+  if (replay == nullptr)
+    return false;
+
+  flight.points.clear();
+  flight.release_index = 0;
+  flight.release_time = fixed(-1);
+
+  while (replay->Next()) {
+    const MoreData &basic = replay->Basic();
+    if (!basic.time_available || !basic.location_available ||
+        !basic.NavAltitudeAvailable())
+      continue;
+
+    const FlyingState &flying = replay->Calculated().flight;
+    if (negative(flight.release_time) && !negative(flying.release_time)) {
+      flight.release_index = flight.points.size();
+      flight.release_time = flying.release_time;
+    }
+
+    if (!negative(flight.release_time) && !flying.flying)
+      /* the aircraft has landed, stop here */
+      break;
+
+    flight.points.emplace_back(basic);
+  }
+
+  delete replay;
+  return true;
+}
+
+static void
+EraseEarlierThan(Trace &full_trace, Trace &triangle_trace,
+                 Trace &sprint_trace, fixed time)
+{
+  full_trace.EraseEarlierThan(time);
+  triangle_trace.EraseEarlierThan(time);
+  sprint_trace.EraseEarlierThan(time);
+}
+
+void
+ReplayContestFlight(const ContestFlight &flight,
+                    Trace &full_trace, Trace &triangle_trace,
+                    Trace &sprint_trace,
+                    ContestManager *const*idle_managers,
+                    unsigned n_idle_managers)
+{
+  const bool released = !negative(flight.release_time);
+
+  for (unsigned i = 0; i < flight.points.size(); ++i) {
+    if (released && i == flight.release_index)
+      EraseEarlierThan(full_trace, triangle_trace, sprint_trace,
+                       flight.release_time);
+
+    const TracePoint &point = flight.points[i];
+    full_trace.push_back(point);
+    triangle_trace.push_back(point);
+    sprint_trace.push_back(point);
+
+    for (unsigned j = 0; j < n_idle_managers; ++j)
+      idle_managers[j]->UpdateIdle();
+  }
+
+  if (released && flight.release_index == flight.points.size())
+    /* released and landed at the same time */
+    EraseEarlierThan(full_trace, triangle_trace, sprint_trace,
+                     flight.release_time);
+}
@@ -0,0 +1,136 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_CONTEST_REPLAY_HPP
+#define XCSOAR_CONTEST_REPLAY_HPP
+
+#include "Contest/Settings.hpp"
+#include "Engine/Trace/Point.hpp"
+#include "Math/fixed.hpp"
+#include "Compiler.h"
+
+#include <string>
+#include <vector>
+
+class Trace;
+class ContestManager;
+
+struct ContestInfo {
+  const char *name;
+  Contest contest;
+
+  /**
+   * The names of the #ContestStatistics result slots, nullptr for
+   * unused slots.
+   */
+  const char *variants[3];
+};
+
+/**
+ * Add the given IGC file, or all IGC files in the given directory
+ * and its subdirectories, to the list.
+ */
+void
+CollectIGCFiles(const char *path, std::vector<std::string> &files);
+
+/**
+ * All contests, terminated by an entry with a nullptr name.
+ */
+extern const ContestInfo contest_infos[];
+
+/**
+ * Look up a contest by its command line name.
+ *
+ * @return nullptr if there is no such contest
+ */
+gcc_pure
+const ContestInfo *
+FindContest(const char *name);
+
+/**
+ * Does the contest use the sprint trace?  It only covers the last
+ * 2.5 hours, so these contests must be updated during the flight.
+ */
+gcc_const
+bool
+UsesSprintTrace(Contest contest);
+
+/**
+ * The maximum number of points of the traces which are passed to the
+ * solvers.
+ */
+struct TraceSizes {
+  unsigned full, triangle, sprint;
+};
+
+/**
+ * The sizes used by RunOLCAnalysis.
+ */
+static constexpr TraceSizes default_trace_sizes = { 512, 1024, 128 };
+
+/**
+ * Large enough to keep a ten hour flight at the full resolution of
+ * one point every two seconds.
+ */
+static constexpr TraceSizes high_resolution_trace_sizes = {
+  32768, 32768, 8192,
+};
+
+/**
+ * The points of a flight which are fed into the contest traces, from
+ * the beginning of the recording until the landing.
+ */
+struct ContestFlight {
+  std::vector<TracePoint> points;
+
+  /**
+   * The release was detected right before this point was received;
+   * all earlier points are then erased from the traces.  Only valid
+   * if #release_time is not negative.
+   */
+  unsigned release_index;
+
+  fixed release_time;
+};
+
+/**
+ * Replay an IGC file through the flight computer and collect the
+ * points for the contest traces.
+ *
+ * @return false if the file could not be opened
+ */
+bool
+LoadContestFlight(const char *path, ContestFlight &flight);
+
+/**
+ * Feed the flight into the traces.  The given managers are updated
+ * after each point, see UsesSprintTrace().
+ */
+void
+ReplayContestFlight(const ContestFlight &flight,
+                    Trace &full_trace, Trace &triangle_trace,
+                    Trace &sprint_trace,
+                    ContestManager *const*idle_managers,
+                    unsigned n_idle_managers);
+
+#endif
@@ -26,6 +26,7 @@ Copyright_License {
  * for valgrind and profiling.
  */
 
+#include "TerrainStatistics.hpp"
 #include "Terrain/RasterTileCache.hpp"
 #include "OS/Args.hpp"
 #include "OS/ConvertPathName.hpp"
@@ -69,5 +70,7 @@ int main(int argc, char **argv)
                     1000);
   } while (rtc.IsDirty());
 
+  PrintTerrainStatistics(rtc.GetStatistics());
+
   return EXIT_SUCCESS;
 }
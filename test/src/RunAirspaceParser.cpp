@@ -24,34 +24,93 @@ Copyright_License {
 #include "Airspace/AirspaceParser.hpp"
 #include "Engine/Airspace/Airspaces.hpp"
 #include "OS/Args.hpp"
+#include "OS/Clock.hpp"
 #include "IO/FileLineReader.hpp"
 #include "Operation/Operation.hpp"
+#include "Util/StringUtil.hpp"
+
+#include <algorithm>
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <tchar.h>
 
 int main(int argc, char **argv)
 {
-  Args args(argc, argv, "PATH");
+  unsigned repeat = 1, max_threads = 0;
+
+  Args args(argc, argv,
+            "[options] PATH\n"
+            "Options:\n"
+            "  --threads=N              Parser threads (default = one per processor)\n"
+            "  --repeat=N               Load the file N times, keep the fastest (default = 1)");
+
+  const char *arg;
+  while ((arg = args.PeekNext()) != nullptr && *arg == '-') {
+    args.Skip();
+
+    const char *value;
+    if ((value = StringAfterPrefix(arg, "--threads=")) != nullptr) {
+      max_threads = strtoul(value, NULL, 10);
+      if (max_threads == 0) {
+        fputs("The threads parameter could not be parsed correctly.\n",
+              stderr);
+        args.UsageError();
+      }
+
+    } else if ((value = StringAfterPrefix(arg, "--repeat=")) != nullptr) {
+      repeat = strtoul(value, NULL, 10);
+      if (repeat == 0) {
+        fputs("The repeat parameter could not be parsed correctly.\n",
+              stderr);
+        args.UsageError();
+      }
+
+    } else {
+      args.UsageError();
+    }
+  }
+
   const char *path = args.ExpectNext();
   args.ExpectEnd();
 
-  FileLineReader reader(path, Charset::AUTO);
-  if (reader.error()) {
-    fprintf(stderr, "Failed to open input file\n");
-    return 1;
-  }
+  /* the startup sequence of ReadAirspace(): parse, then build the
+     index */
+  uint64_t best_parse = UINT64_MAX, best_optimise = UINT64_MAX;
+  unsigned size = 0;
+
+  for (unsigned i = 0; i < repeat; ++i) {
+    FileLineReader reader(path, Charset::AUTO);
+    if (reader.error()) {
+      fprintf(stderr, "Failed to open input file\n");
+      return 1;
+    }
+
+    Airspaces airspaces;
+    AirspaceParser parser(airspaces, max_threads);
+
+    const uint64_t start = MonotonicClockUS();
+
+    NullOperationEnvironment operation;
+    if (!parser.Parse(reader, operation)) {
+      fprintf(stderr, "Failed to parse input file\n");
+      return 1;
+    }
+
+    const uint64_t parsed = MonotonicClockUS();
+
+    airspaces.Optimise();
 
-  Airspaces airspaces;
-  AirspaceParser parser(airspaces);
+    const uint64_t optimised = MonotonicClockUS();
 
-  NullOperationEnvironment operation;
-  if (!parser.Parse(reader, operation)) {
-    fprintf(stderr, "Failed to parse input file\n");
-    return 1;
+    best_parse = std::min(best_parse, parsed - start);
+    best_optimise = std::min(best_optimise, optimised - parsed);
+    size = airspaces.GetSize();
   }
 
-  airspaces.Optimise();
+  printf("%u airspaces, parse %llu us, index %llu us\n", size,
+         (unsigned long long)best_parse, (unsigned long long)best_optimise);
 
   printf("OK\n");
 
@@ -136,6 +136,23 @@ LoadReplay(DebugReplay *replay, GlideComputer &glide_computer,
   blackboard.ReadBlackboardCalculated(glide_computer.Calculated());
 }
 
+static void
+PrintPipelineProfile(const PipelineProfile &profile)
+{
+  _tprintf(_T("%-12s %8s %8s %8s %8s %8s\n"), _T("stage"),
+           _T("count"), _T("avg_us"), _T("p50_us"), _T("p99_us"),
+           _T("max_us"));
+
+  for (unsigned i = 0; i < unsigned(PipelineStage::COUNT); ++i) {
+    const PipelineStage stage = PipelineStage(i);
+    const PipelineStageStatistics s = profile.Get(stage);
+    _tprintf(_T("%-12s %8u %8u %8u %8u %8u\n"),
+             PipelineProfile::GetStageName(stage),
+             s.count, s.GetAverage(), s.GetPercentile(50),
+             s.GetPercentile(99), s.max_us);
+  }
+}
+
 static DebugReplay *replay;
 
 static void
@@ -190,6 +207,8 @@ Main()
   LoadReplay(replay, glide_computer, blackboard);
   delete replay;
 
+  PrintPipelineProfile(glide_computer.GetProfile());
+
   SingleWindow main_window;
   main_window.Create(_T("RunAnalysis"),
                      {640, 480});
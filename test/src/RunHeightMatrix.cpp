@@ -21,6 +21,7 @@ Copyright_License {
 }
 */
 
+#include "TerrainStatistics.hpp"
 #include "Terrain/RasterMap.hpp"
 #include "Terrain/HeightMatrix.hpp"
 #include "Projection/WindowProjection.hpp"
@@ -78,5 +79,7 @@ int main(int argc, char **argv)
   matrix.Fill(map, projection, 1, false);
 #endif
 
+  PrintTerrainStatistics(map.GetTileStatistics());
+
   return EXIT_SUCCESS;
 }
@@ -22,6 +22,7 @@
 
 #include "Engine/Trace/Trace.hpp"
 #include "Contest/ContestManager.hpp"
+#include "Thread/Parallel.hpp"
 #include "Printing.hpp"
 #include "OS/Args.hpp"
 #include "DebugReplay.hpp"
@@ -61,6 +62,13 @@ static ContestManager sis_at(Contest::SIS_AT,
 static ContestManager olc_netcoupe(Contest::NET_COUPE,
                                    full_trace, triangle_trace, sprint_trace);
 
+static void
+PrintMemoryUsage(const char *name, const ContestManager &manager)
+{
+  std::cout << "# " << name << " " << manager.GetMemoryUsage() / 1024
+            << " kB\n";
+}
+
 static int
 TestOLC(DebugReplay &replay)
 {
@@ -94,6 +102,11 @@ TestOLC(DebugReplay &replay)
     olc_league.UpdateIdle();
   }
 
+  const unsigned max_threads = GetProcessorCount();
+  olc_fai.SetMaxThreads(max_threads);
+  olc_plus.SetMaxThreads(max_threads);
+  xcontest.SetMaxThreads(max_threads);
+
   olc_classic.SolveExhaustive();
   olc_fai.SolveExhaustive();
   olc_league.SolveExhaustive();
@@ -139,6 +152,17 @@ TestOLC(DebugReplay &replay)
   std::cout << "netcoupe\n";
   PrintHelper::print(olc_netcoupe.GetStats().GetResult());
 
+  std::cout << "memory\n";
+  PrintMemoryUsage("classic", olc_classic);
+  PrintMemoryUsage("league", olc_league);
+  PrintMemoryUsage("fai", olc_fai);
+  PrintMemoryUsage("sprint", olc_sprint);
+  PrintMemoryUsage("plus", olc_plus);
+  PrintMemoryUsage("dmst", dmst);
+  PrintMemoryUsage("xcontest", xcontest);
+  PrintMemoryUsage("sis_at", sis_at);
+  PrintMemoryUsage("netcoupe", olc_netcoupe);
+
   olc_classic.Reset();
   olc_fai.Reset();
   olc_sprint.Reset();
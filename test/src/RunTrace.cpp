@@ -22,8 +22,68 @@ Copyright_License {
 */
 
 #include "OS/Args.hpp"
+#include "OS/Clock.hpp"
 #include "DebugReplay.hpp"
 #include "Engine/Trace/Trace.hpp"
+#include "Engine/Trace/Vector.hpp"
+
+#include <algorithm>
+
+#include <stdio.h>
+
+/**
+ * The number of points fed into each trace; the flight is repeated
+ * (shifted in time) until there are enough points to fill the
+ * largest trace several times.
+ */
+static constexpr unsigned N_POINTS = 256 * 1024;
+
+static constexpr unsigned trace_sizes[] = {
+  256, 1024, 4096, 16384, 65536,
+};
+
+/**
+ * Append all points to a new trace of the given size, and print
+ * how long insertion and thinning took.
+ */
+static void
+Run(const TracePointVector &fixes, unsigned max_size)
+{
+  Trace trace(0, Trace::null_time, max_size);
+
+  const unsigned duration = fixes.back().GetTime() - fixes.front().GetTime() + 2;
+
+  unsigned n_thin = 0;
+  uint64_t thin_us = 0, max_us = 0;
+  const uint64_t start_time = MonotonicClockUS();
+
+  for (unsigned i = 0; i < N_POINTS; ++i) {
+    const unsigned lap = i / fixes.size();
+    const TracePoint &fix = fixes[i % fixes.size()];
+    const TracePoint point(fix.GetLocation(),
+                           fix.GetTime() + lap * duration,
+                           fix.GetAltitude(), fix.GetVario(), 0);
+
+    const Serial serial = trace.GetModifySerial();
+    const uint64_t push_start = MonotonicClockUS();
+    trace.push_back(point);
+    const uint64_t push_us = MonotonicClockUS() - push_start;
+
+    max_us = std::max(max_us, push_us);
+    if (trace.GetModifySerial() != serial) {
+      /* this point has triggered thinning */
+      ++n_thin;
+      thin_us += push_us;
+    }
+  }
+
+  const uint64_t total_us = MonotonicClockUS() - start_time;
+
+  printf("%6u %7u %6u %8.1f %8.1f %8.1f %6u %6u\n",
+         max_size, N_POINTS, n_thin,
+         total_us / 1000., total_us * 1000. / N_POINTS,
+         thin_us / 1000., unsigned(max_us), trace.size());
+}
 
 int main(int argc, char **argv)
 {
@@ -34,14 +94,27 @@ int main(int argc, char **argv)
 
   args.ExpectEnd();
 
-  Trace trace;
+  TracePointVector fixes;
 
   while (replay->Next()) {
     const MoreData &basic = replay->Basic();
     if (basic.time_available && basic.location_available &&
-        basic.NavAltitudeAvailable())
-      trace.push_back(TracePoint(basic));
+        basic.NavAltitudeAvailable() &&
+        (fixes.empty() || basic.time >= fixed(fixes.back().GetTime() + 2)))
+      fixes.push_back(TracePoint(basic));
   }
 
   delete replay;
+
+  if (fixes.size() < 2) {
+    fprintf(stderr, "Not enough fixes\n");
+    return EXIT_FAILURE;
+  }
+
+  printf("# %u fixes per lap\n", unsigned(fixes.size()));
+  printf("#  size  points  thins total_ms ns/point  thin_ms max_us   size\n");
+  for (const unsigned max_size : trace_sizes)
+    Run(fixes, max_size);
+
+  return EXIT_SUCCESS;
 }
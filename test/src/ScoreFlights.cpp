@@ -0,0 +1,286 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * Score a batch of IGC files with the contest optimisers.  Each
+ * flight is replayed and solved independently, so the flights are
+ * spread over all processors.
+ */
+
+#include "ContestReplay.hpp"
+#include "Engine/Trace/Trace.hpp"
+#include "Contest/ContestManager.hpp"
+#include "Thread/Parallel.hpp"
+#include "OS/Args.hpp"
+#include "OS/Clock.hpp"
+#include "Util/Macros.hpp"
+#include "Util/StringUtil.hpp"
+#include "IO/TextWriter.hpp"
+#include "JSON/Writer.hpp"
+#include "JSON/GeoWriter.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct FlightResult {
+  bool valid;
+
+  /**
+   * The results of each contest, in the order of the "contests"
+   * list.
+   */
+  std::vector<ContestStatistics> stats;
+};
+
+static bool
+ScoreFlight(const char *path,
+            const std::vector<const ContestInfo *> &contests,
+            const TraceSizes &trace_sizes,
+            FlightResult &result)
+{
+  ContestFlight flight;
+  if (!LoadContestFlight(path, flight))
+    return false;
+
+  Trace full_trace(0, Trace::null_time, trace_sizes.full);
+  Trace triangle_trace(0, Trace::null_time, trace_sizes.triangle);
+  Trace sprint_trace(0, 9000, trace_sizes.sprint);
+
+  std::vector<ContestManager *> managers, idle_managers;
+  managers.reserve(contests.size());
+  for (const ContestInfo *info : contests) {
+    ContestManager *manager = new ContestManager(info->contest, full_trace,
+                                                 triangle_trace, sprint_trace);
+    managers.push_back(manager);
+    if (UsesSprintTrace(info->contest))
+      idle_managers.push_back(manager);
+  }
+
+  ReplayContestFlight(flight, full_trace, triangle_trace, sprint_trace,
+                      idle_managers.data(), idle_managers.size());
+
+  result.stats.clear();
+  result.stats.reserve(managers.size());
+  for (ContestManager *manager : managers) {
+    manager->SolveExhaustive();
+    result.stats.push_back(manager->GetStats());
+    delete manager;
+  }
+
+  return true;
+}
+
+static void
+WriteContestResult(TextWriter &writer, const ContestResult &result)
+{
+  JSON::ObjectWriter object(writer);
+
+  object.WriteElement("score", JSON::WriteFixed, result.score);
+  object.WriteElement("distance", JSON::WriteFixed, result.distance);
+  object.WriteElement("duration", JSON::WriteUnsigned, (unsigned)result.time);
+  object.WriteElement("speed", JSON::WriteFixed, result.GetSpeed());
+  object.WriteElement("optimal", JSON::WriteBool, result.optimal);
+}
+
+static void
+WriteContestStatistics(TextWriter &writer, const ContestInfo &info,
+                       const ContestStatistics &stats)
+{
+  JSON::ObjectWriter object(writer);
+
+  for (unsigned i = 0; i < ARRAY_SIZE(info.variants); ++i)
+    if (info.variants[i] != nullptr)
+      object.WriteElement(info.variants[i], WriteContestResult,
+                          stats.result[i]);
+}
+
+static void
+WriteContests(TextWriter &writer,
+              const std::vector<const ContestInfo *> &contests,
+              const FlightResult &result)
+{
+  JSON::ObjectWriter object(writer);
+
+  for (unsigned i = 0; i < contests.size(); ++i)
+    object.WriteElement(contests[i]->name, WriteContestStatistics,
+                        *contests[i], result.stats[i]);
+}
+
+static void
+WriteFlight(TextWriter &writer, const char *path,
+            const std::vector<const ContestInfo *> &contests,
+            const FlightResult &result)
+{
+  JSON::ObjectWriter object(writer);
+
+  object.WriteElement("file", JSON::WriteString, path);
+  object.WriteElement("contests", WriteContests, contests, result);
+}
+
+static void
+WriteJSON(TextWriter &writer, const std::vector<std::string> &files,
+          const std::vector<const ContestInfo *> &contests,
+          const std::vector<FlightResult> &results)
+{
+  {
+    JSON::ArrayWriter array(writer);
+
+    for (unsigned i = 0; i < files.size(); ++i)
+      if (results[i].valid)
+        array.WriteElement(WriteFlight, files[i].c_str(), contests,
+                           results[i]);
+  }
+
+  writer.NewLine();
+}
+
+static void
+WriteCSV(TextWriter &writer, const std::vector<std::string> &files,
+         const std::vector<const ContestInfo *> &contests,
+         const std::vector<FlightResult> &results)
+{
+  writer.WriteLine("file,contest,variant,score,distance,duration,speed,optimal");
+
+  for (unsigned i = 0; i < files.size(); ++i) {
+    if (!results[i].valid)
+      continue;
+
+    for (unsigned j = 0; j < contests.size(); ++j) {
+      const ContestInfo &info = *contests[j];
+      const ContestStatistics &stats = results[i].stats[j];
+
+      for (unsigned k = 0; k < ARRAY_SIZE(info.variants); ++k) {
+        if (info.variants[k] == nullptr)
+          continue;
+
+        const ContestResult &result = stats.result[k];
+        writer.FormatLine("%s,%s,%s,%f,%f,%u,%f,%u",
+                          files[i].c_str(), info.name, info.variants[k],
+                          (double)result.score, (double)result.distance,
+                          (unsigned)result.time, (double)result.GetSpeed(),
+                          (unsigned)result.optimal);
+      }
+    }
+  }
+}
+
+int main(int argc, char **argv)
+{
+  std::vector<const ContestInfo *> contests;
+  unsigned max_threads = GetProcessorCount();
+  bool csv = false;
+  const TraceSizes *trace_sizes = &default_trace_sizes;
+
+  Args args(argc, argv,
+            "[options] FILE_OR_DIRECTORY...\n"
+            "Options:\n"
+            "  --contest=NAME           Score this contest (may be repeated, default = olc_plus,dmst)\n"
+            "  --jobs=N                 Number of flights scored concurrently (default = number of CPUs)\n"
+            "  --csv                    Write CSV instead of JSON\n"
+            "  --high-resolution        Don't thin the traces of flights up to ten hours\n"
+            "Contests:\n"
+            "  olc_sprint olc_fai olc_classic olc_league olc_plus\n"
+            "  xcontest dhv_xc sis_at netcoupe dmst");
+
+  const char *arg;
+  while ((arg = args.PeekNext()) != nullptr && *arg == '-') {
+    args.Skip();
+
+    const char *value;
+    if ((value = StringAfterPrefix(arg, "--contest=")) != nullptr) {
+      const ContestInfo *info = FindContest(value);
+      if (info == nullptr) {
+        fprintf(stderr, "Unknown contest: %s\n", value);
+        args.UsageError();
+      }
+
+      contests.push_back(info);
+
+    } else if ((value = StringAfterPrefix(arg, "--jobs=")) != nullptr) {
+      unsigned _jobs = strtol(value, NULL, 10);
+      if (_jobs > 0)
+        max_threads = _jobs;
+      else {
+        fputs("The jobs parameter could not be parsed correctly.\n", stderr);
+        args.UsageError();
+      }
+
+    } else if (strcmp(arg, "--csv") == 0) {
+      csv = true;
+
+    } else if (strcmp(arg, "--high-resolution") == 0) {
+      trace_sizes = &high_resolution_trace_sizes;
+
+    } else {
+      args.UsageError();
+    }
+  }
+
+  if (contests.empty()) {
+    contests.push_back(FindContest("olc_plus"));
+    contests.push_back(FindContest("dmst"));
+  }
+
+  if (args.IsEmpty())
+    args.UsageError();
+
+  std::vector<std::string> files;
+  while (!args.IsEmpty())
+    CollectIGCFiles(args.ExpectNext(), files);
+
+  /* the directory order is arbitrary; sort for reproducible output */
+  std::sort(files.begin(), files.end());
+
+  std::vector<FlightResult> results(files.size());
+
+  const unsigned start_time = MonotonicClockMS();
+
+  ParallelFor(files.size(), max_threads, [&](unsigned i){
+      results[i].valid = ScoreFlight(files[i].c_str(), contests,
+                                     *trace_sizes, results[i]);
+    });
+
+  const unsigned duration = MonotonicClockMS() - start_time;
+
+  unsigned n_valid = 0;
+  for (const auto &result : results)
+    if (result.valid)
+      ++n_valid;
+
+  TextWriter writer("/dev/stdout", true);
+  if (csv)
+    WriteCSV(writer, files, contests, results);
+  else
+    WriteJSON(writer, files, contests, results);
+
+  fprintf(stderr, "Scored %u of %u flights in %u ms (%.2f flights/s)\n",
+          n_valid, (unsigned)files.size(), duration,
+          duration > 0 ? n_valid * 1000. / duration : 0.);
+
+  return n_valid == files.size() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,44 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "TerrainStatistics.hpp"
+#include "Terrain/RasterTileStatistics.hpp"
+
+#include <stdio.h>
+
+void
+PrintTerrainStatistics(const RasterTileStatistics &s)
+{
+  printf("tiles: loaded=%u failed=%u evicted=%u resident=%u (%lu kB)\n",
+         s.tiles_loaded, s.tiles_failed, s.tiles_evicted,
+         s.resident_tiles, (unsigned long)(s.resident_bytes / 1024));
+  printf("decode: total=%lu us per_tile=%u us\n",
+         (unsigned long)s.decode_us, s.GetDecodeTimePerTile());
+  printf("poll: count=%u average=%u us max=%u us\n",
+         s.polls, s.GetAveragePollTime(), s.poll_max_us);
+
+  const unsigned lookups = s.fine_lookups + s.overview_lookups;
+  printf("lookups: fine=%u overview=%u (%u%% fine)\n",
+         s.fine_lookups, s.overview_lookups,
+         lookups > 0 ? s.fine_lookups * 100u / lookups : 0u);
+}
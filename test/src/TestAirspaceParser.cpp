@@ -29,10 +29,16 @@ Copyright_License {
 #include "Units/System.hpp"
 #include "Util/Macros.hpp"
 #include "Util/StringAPI.hpp"
+#include "Util/StaticString.hxx"
+#include "Util/NumberParser.hpp"
 #include "IO/FileLineReader.hpp"
 #include "Operation/Operation.hpp"
 #include "TestUtil.hpp"
 
+#include <algorithm>
+#include <string>
+#include <vector>
+
 #include <tchar.h>
 
 struct AirspaceClassTestCouple
@@ -275,12 +281,209 @@ TestTNP()
   }
 }
 
+/**
+ * A #TLineReader which returns the lines of a list of strings.
+ */
+class StringListLineReader : public TLineReader {
+  const std::vector<std::basic_string<TCHAR>> &lines;
+  unsigned next;
+  std::basic_string<TCHAR> current;
+
+public:
+  explicit StringListLineReader(const std::vector<std::basic_string<TCHAR>> &_lines)
+    :lines(_lines), next(0) {}
+
+  TCHAR *ReadLine() override {
+    if (next >= lines.size())
+      return nullptr;
+
+    current = lines[next++];
+    return &current[0];
+  }
+
+  long GetSize() const override {
+    return lines.size();
+  }
+
+  long Tell() const override {
+    return next;
+  }
+};
+
+static constexpr unsigned N_GENERATED = 1500;
+
+/**
+ * Generate an OpenAir file with #N_GENERATED circles and polygons,
+ * about 10000 lines.  If broken_record is smaller than #N_GENERATED,
+ * then that record (which must be odd, i.e. a polygon) contains a
+ * malformed line.
+ */
+static void
+GenerateOpenAir(std::vector<std::basic_string<TCHAR>> &lines,
+                unsigned broken_record)
+{
+  StaticString<64> buffer;
+
+  for (unsigned i = 0; i < N_GENERATED; ++i) {
+    const unsigned lat = i % 60, lon = (i / 60) % 60;
+
+    lines.push_back(_T("* generated airspace"));
+    lines.push_back(i % 2 == 0 ? _T("AC C") : _T("AC D"));
+    buffer.Format(_T("AN Airspace-%u"), i);
+    lines.push_back(buffer.c_str());
+    buffer.Format(_T("AL %u ft"), i % 10 * 100);
+    lines.push_back(buffer.c_str());
+    lines.push_back(_T("AH FL 65"));
+
+    if (i % 2 == 0) {
+      buffer.Format(_T("V X=%02u:%02u.5 N %03u:%02u.5 E"), lat, lon, lat, lon);
+      lines.push_back(buffer.c_str());
+      buffer.Format(_T("DC %u"), i % 7 + 1);
+      lines.push_back(buffer.c_str());
+    } else {
+      buffer.Format(_T("DP %02u:%02u:00 N %03u:%02u:00 E"), lat, lon, lat, lon);
+      lines.push_back(buffer.c_str());
+      buffer.Format(_T("DP %02u:%02u:00 N %03u:%02u:30 E"), lat, lon, lat, lon);
+      lines.push_back(buffer.c_str());
+      if (i == broken_record)
+        lines.push_back(_T("DP garbage"));
+      buffer.Format(_T("DP %02u:%02u:30 N %03u:%02u:30 E"), lat, lon, lat, lon);
+      lines.push_back(buffer.c_str());
+      buffer.Format(_T("DP %02u:%02u:30 N %03u:%02u:00 E"), lat, lon, lat, lon);
+      lines.push_back(buffer.c_str());
+    }
+  }
+}
+
+static bool
+ParseLines(const std::vector<std::basic_string<TCHAR>> &lines,
+           unsigned max_threads, Airspaces &airspaces)
+{
+  StringListLineReader reader(lines);
+  AirspaceParser parser(airspaces, max_threads);
+  NullOperationEnvironment operation;
+
+  const bool success = parser.Parse(reader, operation);
+  airspaces.Optimise();
+  return success;
+}
+
+/**
+ * Returns the number in the name of a generated airspace.
+ */
+gcc_pure
+static unsigned
+GetGeneratedIndex(const AbstractAirspace &airspace)
+{
+  const TCHAR *p = StringAfterPrefix(airspace.GetName(), _T("Airspace-"));
+  return p != nullptr ? ParseUnsigned(p) : N_GENERATED;
+}
+
+static std::vector<const AbstractAirspace *>
+SortedAirspaces(const Airspaces &airspaces)
+{
+  std::vector<const AbstractAirspace *> result;
+  for (auto it = airspaces.begin(); it != airspaces.end(); ++it)
+    result.push_back(&it->GetAirspace());
+
+  std::sort(result.begin(), result.end(),
+            [](const AbstractAirspace *a, const AbstractAirspace *b){
+              return GetGeneratedIndex(*a) < GetGeneratedIndex(*b);
+            });
+  return result;
+}
+
+gcc_pure
+static bool
+Equals(const AirspaceAltitude &a, const AirspaceAltitude &b)
+{
+  return a.reference == b.reference && a.altitude == b.altitude &&
+    a.flight_level == b.flight_level &&
+    a.altitude_above_terrain == b.altitude_above_terrain;
+}
+
+gcc_pure
+static bool
+Equals(const AbstractAirspace &a, const AbstractAirspace &b)
+{
+  if (!StringIsEqual(a.GetName(), b.GetName()) ||
+      a.GetShape() != b.GetShape() || a.GetType() != b.GetType() ||
+      !Equals(a.GetBase(), b.GetBase()) || !Equals(a.GetTop(), b.GetTop()))
+    return false;
+
+  const SearchPointVector &points_a = a.GetPoints();
+  const SearchPointVector &points_b = b.GetPoints();
+  if (points_a.size() != points_b.size())
+    return false;
+
+  for (unsigned i = 0; i < points_a.size(); ++i)
+    if (points_a[i].GetLocation() != points_b[i].GetLocation())
+      return false;
+
+  return true;
+}
+
+gcc_pure
+static bool
+Equals(const Airspaces &a, const Airspaces &b)
+{
+  const auto sorted_a = SortedAirspaces(a), sorted_b = SortedAirspaces(b);
+  return sorted_a.size() == sorted_b.size() &&
+    std::equal(sorted_a.begin(), sorted_a.end(), sorted_b.begin(),
+               [](const AbstractAirspace *x, const AbstractAirspace *y){
+                 return Equals(*x, *y);
+               });
+}
+
+/**
+ * Parse a file which is large enough to be split into several chunks
+ * with different numbers of threads, and compare the results.
+ */
+static void
+TestParallel()
+{
+  static constexpr unsigned thread_counts[] = { 1, 3, 8 };
+
+  std::vector<std::basic_string<TCHAR>> lines;
+  GenerateOpenAir(lines, N_GENERATED);
+
+  Airspaces airspaces[ARRAY_SIZE(thread_counts)];
+  for (unsigned i = 0; i < ARRAY_SIZE(thread_counts); ++i) {
+    ok1(ParseLines(lines, thread_counts[i], airspaces[i]));
+    ok1(airspaces[i].GetSize() == N_GENERATED);
+  }
+
+  for (unsigned i = 1; i < ARRAY_SIZE(thread_counts); ++i)
+    ok1(Equals(airspaces[0], airspaces[i]));
+
+  /* a malformed line at about line 8400, in one of the later chunks:
+     the parser must fail, and keep only the airspaces before it */
+  static constexpr unsigned broken_record = 1201;
+
+  lines.clear();
+  GenerateOpenAir(lines, broken_record);
+
+  for (unsigned i = 0; i < ARRAY_SIZE(thread_counts); ++i) {
+    Airspaces broken;
+    ok1(!ParseLines(lines, thread_counts[i], broken));
+    ok1(broken.GetSize() == broken_record);
+
+    bool before_error = true;
+    for (auto it = broken.begin(); it != broken.end(); ++it)
+      if (GetGeneratedIndex(it->GetAirspace()) >= broken_record)
+        before_error = false;
+
+    ok1(before_error);
+  }
+}
+
 int main(int argc, char **argv)
 {
-  plan_tests(104);
+  plan_tests(104 + 17);
 
   TestOpenAir();
   TestTNP();
+  TestParallel();
 
   return exit_status();
 }
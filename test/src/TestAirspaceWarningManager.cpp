@@ -0,0 +1,128 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Engine/Airspace/AirspaceWarningManager.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/AirspaceCircle.hpp"
+#include "Engine/GlideSolvers/GlidePolar.hpp"
+#include "Engine/Task/Stats/TaskStats.hpp"
+#include "Navigation/Aircraft.hpp"
+#include "Geo/GeoVector.hpp"
+#include "TestUtil.hpp"
+
+static const GeoPoint origin(Angle::Degrees(fixed(7)), Angle::Degrees(fixed(51)));
+
+static GeoPoint
+East(fixed distance)
+{
+  return GeoVector(distance, Angle::QuarterCircle()).EndPoint(origin);
+}
+
+static AbstractAirspace *
+AddCircle(Airspaces &airspaces, fixed distance, fixed radius)
+{
+  AirspaceAltitude base, top;
+  base.altitude = fixed(0);
+  top.altitude = fixed(3000);
+
+  AbstractAirspace *as = new AirspaceCircle(East(distance), radius);
+  as->SetProperties(_T("test"), CTR, base, top);
+  airspaces.Add(as);
+  return as;
+}
+
+static const AirspaceWarning *
+Update(AirspaceWarningManager &manager, const AbstractAirspace &airspace,
+       const GeoPoint &location)
+{
+  AircraftState state;
+  state.Reset();
+  state.location = location;
+  state.altitude = fixed(1000);
+  state.ground_speed = fixed(40);
+  state.track = Angle::QuarterCircle();
+
+  const GlidePolar glide_polar(fixed(1));
+  TaskStats task_stats;
+  task_stats.reset();
+
+  manager.Update(state, glide_polar, task_stats, false, 1);
+  return manager.GetWarningPtr(airspace);
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(9);
+
+  Airspaces airspaces;
+  const AbstractAirspace &inside = *AddCircle(airspaces, fixed(0), fixed(500));
+  const AbstractAirspace &ahead = *AddCircle(airspaces, fixed(1500), fixed(500));
+  const AbstractAirspace &far = *AddCircle(airspaces, fixed(60000), fixed(500));
+  airspaces.Optimise();
+
+  AirspaceWarningManager manager(airspaces);
+  AirspaceWarningConfig config;
+  config.SetDefaults();
+  manager.SetConfig(config);
+
+  const AirspaceWarning *warning = Update(manager, inside, origin);
+  ok1(warning != nullptr &&
+      warning->GetWarningState() == AirspaceWarning::WARNING_INSIDE);
+
+  warning = manager.GetWarningPtr(ahead);
+  ok1(warning != nullptr &&
+      warning->GetWarningState() == AirspaceWarning::WARNING_GLIDE);
+
+  ok1(manager.GetWarningPtr(far) == nullptr);
+
+  /* fly far enough to leave the cached candidate area */
+  warning = Update(manager, far, East(fixed(58500)));
+  ok1(warning != nullptr &&
+      warning->GetWarningState() == AirspaceWarning::WARNING_GLIDE);
+  ok1(manager.GetWarningPtr(inside) == nullptr);
+
+  /* replace the airspace database; the candidates must not be
+     reused */
+  manager.clear();
+  airspaces.Clear();
+  const AbstractAirspace &replaced =
+    *AddCircle(airspaces, fixed(58500), fixed(500));
+  airspaces.Optimise();
+
+  warning = Update(manager, replaced, East(fixed(58500)));
+  ok1(warning != nullptr &&
+      warning->GetWarningState() == AirspaceWarning::WARNING_INSIDE);
+  ok1(manager.size() == 1);
+
+  /* a database change without moving the aircraft */
+  const AbstractAirspace &added =
+    *AddCircle(airspaces, fixed(60000), fixed(500));
+  airspaces.Optimise();
+
+  warning = Update(manager, added, East(fixed(58500)));
+  ok1(warning != nullptr &&
+      warning->GetWarningState() == AirspaceWarning::WARNING_GLIDE);
+  ok1(manager.size() == 2);
+
+  return exit_status();
+}
@@ -0,0 +1,109 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * Solve the contests with triangle solvers on all IGC files in
+ * test/data, once sequentially and with several threads, and check
+ * that the scores are the same.
+ */
+
+#include "ContestReplay.hpp"
+#include "Engine/Trace/Trace.hpp"
+#include "Contest/ContestManager.hpp"
+#include "Util/Macros.hpp"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+static const Contest contests[] = {
+  Contest::OLC_FAI,
+  Contest::OLC_PLUS,
+  Contest::XCONTEST,
+  Contest::DHV_XC,
+};
+
+static const unsigned thread_counts[] = { 3, 8 };
+
+static ContestStatistics
+Solve(const ContestFlight &flight, Contest contest, unsigned max_threads)
+{
+  const TraceSizes &trace_sizes = default_trace_sizes;
+  Trace full_trace(0, Trace::null_time, trace_sizes.full);
+  Trace triangle_trace(0, Trace::null_time, trace_sizes.triangle);
+  Trace sprint_trace(0, 9000, trace_sizes.sprint);
+
+  ContestManager manager(contest, full_trace, triangle_trace, sprint_trace);
+  manager.SetMaxThreads(max_threads);
+  ContestManager *const idle_manager = &manager;
+  const bool idle = UsesSprintTrace(contest);
+
+  ReplayContestFlight(flight, full_trace, triangle_trace, sprint_trace,
+                      &idle_manager, idle ? 1 : 0);
+  manager.SolveExhaustive();
+  return manager.GetStats();
+}
+
+static void
+TestFlight(const ContestFlight &flight)
+{
+  for (const Contest contest : contests) {
+    const ContestStatistics expected = Solve(flight, contest, 1);
+
+    for (const unsigned max_threads : thread_counts) {
+      const ContestStatistics stats = Solve(flight, contest, max_threads);
+
+      bool equal = true;
+      for (unsigned i = 0; i < ARRAY_SIZE(stats.result); ++i)
+        if (stats.result[i].score != expected.result[i].score ||
+            stats.result[i].distance != expected.result[i].distance)
+          equal = false;
+
+      ok1(equal);
+    }
+  }
+}
+
+int main(int argc, char **argv)
+{
+  std::vector<std::string> files;
+  CollectIGCFiles("test/data", files);
+  std::sort(files.begin(), files.end());
+
+  plan_tests(files.size() * ARRAY_SIZE(contests) *
+             ARRAY_SIZE(thread_counts));
+
+  for (const auto &file : files) {
+    ContestFlight flight;
+    if (!LoadContestFlight(file.c_str(), flight)) {
+      skip(ARRAY_SIZE(contests) * ARRAY_SIZE(thread_counts), 0,
+           "failed to load flight");
+      continue;
+    }
+
+    TestFlight(flight);
+  }
+
+  return exit_status();
+}
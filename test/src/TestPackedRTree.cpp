@@ -0,0 +1,129 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Geo/Flat/PackedRTree.hpp"
+#include "TestUtil.hpp"
+
+#include <vector>
+#include <algorithm>
+
+#include <stdint.h>
+
+struct Item : FlatBoundingBox {
+  unsigned id;
+
+  Item(const FlatBoundingBox &box, unsigned _id)
+    :FlatBoundingBox(box), id(_id) {}
+};
+
+static std::vector<Item> items;
+
+static unsigned seed = 42;
+
+static int
+Random(int max)
+{
+  seed = seed * 1103515245 + 12345;
+  return int((uint64_t(seed) * unsigned(max)) >> 32);
+}
+
+static FlatBoundingBox
+RandomBox(int extent, int max_size)
+{
+  const FlatGeoPoint ll(Random(extent) - extent / 2,
+                        Random(extent) - extent / 2);
+  const FlatGeoPoint ur(ll.longitude + Random(max_size),
+                        ll.latitude + Random(max_size));
+  return FlatBoundingBox(ll, ur);
+}
+
+static void
+Generate(unsigned n, int extent, int max_size)
+{
+  items.clear();
+  for (unsigned i = 0; i < n; ++i)
+    items.emplace_back(RandomBox(extent, max_size), i);
+}
+
+static void
+TestTree(unsigned n, int extent, int max_size)
+{
+  Generate(n, extent, max_size);
+
+  PackedRTree<Item> tree;
+  tree.Load(std::vector<Item>(items));
+  ok1(tree.size() == n);
+
+  bool equal = true;
+  for (unsigned q = 0; q < 200; ++q) {
+    const FlatBoundingBox box = RandomBox(extent, max_size * 4);
+
+    std::vector<unsigned> found;
+    tree.VisitOverlapping(box, [&found](const Item &item){
+        found.push_back(item.id);
+      });
+
+    std::vector<unsigned> expected;
+    for (const auto &item : items)
+      if (item.Overlaps(box))
+        expected.push_back(item.id);
+
+    /* no object may be visited twice */
+    std::sort(found.begin(), found.end());
+    equal &= found == expected;
+  }
+
+  ok1(equal);
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(2 * 5 + 2);
+
+  TestTree(1, 1000, 100);
+  TestTree(16, 1000, 100);
+  TestTree(17, 1000, 100);
+  TestTree(1000, 100000, 2000);
+  /* large, overlapping boxes, and coordinates spanning more than
+     half of the "int" range */
+  TestTree(5000, 2000000000, 200000000);
+
+  PackedRTree<Item> tree;
+  bool visited = false;
+  tree.VisitOverlapping(FlatBoundingBox(FlatGeoPoint(0, 0), 100),
+                        [&visited](const Item &){ visited = true; });
+  ok1(!visited && tree.empty());
+
+  /* loading again replaces the contents */
+  Generate(100, 1000, 100);
+  tree.Load(std::vector<Item>(items));
+  Generate(10, 1000, 100);
+  tree.Load(std::vector<Item>(items));
+  unsigned count = 0;
+  tree.VisitOverlapping(FlatBoundingBox(FlatGeoPoint(-1000, -1000),
+                                        FlatGeoPoint(1000, 1000)),
+                        [&count](const Item &){ ++count; });
+  ok1(count == 10 && tree.size() == 10);
+
+  return exit_status();
+}
@@ -0,0 +1,141 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Geo/PolygonBandIndex.hpp"
+#include "TestUtil.hpp"
+
+#include <vector>
+#include <algorithm>
+
+#include <math.h>
+#include <stdint.h>
+
+static unsigned seed = 42;
+
+static fixed
+Random(fixed max)
+{
+  seed = seed * 1103515245 + 12345;
+  return max * (seed >> 8) / (1 << 24);
+}
+
+/**
+ * Generate a closed, spiky star polygon, so many edges cross each
+ * latitude.
+ */
+static SearchPointVector
+GenerateStar(unsigned n)
+{
+  SearchPointVector polygon;
+  for (unsigned i = 0; i < n; ++i) {
+    const fixed angle = fixed(2 * M_PI) * i / n;
+    const fixed radius = fixed(0.2) + Random(fixed(0.8));
+    polygon.emplace_back(GeoPoint(Angle::Degrees(7 + radius * cos(angle)),
+                                  Angle::Degrees(51 + radius * sin(angle))));
+  }
+
+  polygon.emplace_back(polygon.front().GetLocation());
+  return polygon;
+}
+
+static GeoPoint
+RandomPoint()
+{
+  return GeoPoint(Angle::Degrees(fixed(5.8) + Random(fixed(2.4))),
+                  Angle::Degrees(fixed(49.8) + Random(fixed(2.4))));
+}
+
+static void
+TestInside(const SearchPointVector &polygon, const PolygonBandIndex &index)
+{
+  bool equal = true;
+  unsigned n_inside = 0;
+  for (unsigned i = 0; i < 2000; ++i) {
+    GeoPoint p = RandomPoint();
+    if (i % 10 == 0)
+      /* exactly on a vertex latitude */
+      p.latitude = polygon[i % (polygon.size() - 1)].GetLocation().latitude;
+
+    const bool inside = polygon.IsInside(p);
+    equal &= index.IsInside(polygon, p) == inside;
+    n_inside += inside;
+  }
+
+  ok1(equal);
+  ok1(n_inside > 0);
+}
+
+static void
+TestVisitEdges(const SearchPointVector &polygon,
+               const PolygonBandIndex &index)
+{
+  bool equal = true;
+  for (unsigned i = 0; i < 500; ++i) {
+    Angle a = RandomPoint().latitude, b = RandomPoint().latitude;
+    if (i % 2 == 0)
+      /* short ranges */
+      b = a + Angle::Degrees(Random(fixed(0.05)));
+    if (b < a)
+      std::swap(a, b);
+
+    std::vector<unsigned> found;
+    index.VisitEdges(polygon, a, b, [&found](unsigned edge){
+        found.push_back(edge);
+      });
+
+    /* each edge must be visited once, and all edges overlapping
+       the range must be visited */
+    std::sort(found.begin(), found.end());
+    equal &= std::adjacent_find(found.begin(), found.end()) == found.end();
+
+    for (unsigned j = 0; j + 1 < polygon.size(); ++j) {
+      const Angle min = std::min(polygon[j].GetLocation().latitude,
+                                 polygon[j + 1].GetLocation().latitude);
+      const Angle max = std::max(polygon[j].GetLocation().latitude,
+                                 polygon[j + 1].GetLocation().latitude);
+      if (max >= a && min <= b)
+        equal &= std::binary_search(found.begin(), found.end(), j);
+    }
+  }
+
+  ok1(equal);
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(1 + 3 * 4);
+
+  PolygonBandIndex index;
+  index.Build(GenerateStar(10));
+  ok1(!index.IsDefined());
+
+  for (unsigned n : { 40u, 500u, 5000u }) {
+    const SearchPointVector polygon = GenerateStar(n);
+    index.Build(polygon);
+    ok1(index.IsDefined());
+    TestInside(polygon, index);
+    TestVisitEdges(polygon, index);
+  }
+
+  return exit_status();
+}
@@ -0,0 +1,154 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Terrain/Kernel/Optimised.hpp"
+#include "Util/Macros.hpp"
+#include "TestUtil.hpp"
+
+#include <string.h>
+
+static constexpr unsigned WIDTH = 101, HEIGHT = 60;
+
+static short heights[WIDTH * HEIGHT];
+
+/**
+ * A simple deterministic pseudo random number generator.
+ */
+static unsigned
+NextRandom(unsigned &state)
+{
+  state = state * 1103515245 + 12345;
+  return state >> 16;
+}
+
+static void
+FillHeights()
+{
+  unsigned state = 42;
+  int h = 500;
+
+  for (auto &i : heights) {
+    const unsigned r = NextRandom(state);
+    switch (r % 64) {
+    case 0:
+      i = RasterBuffer::TERRAIN_INVALID;
+      break;
+
+    case 1:
+      i = RasterBuffer::TERRAIN_WATER_THRESHOLD;
+      break;
+
+    case 2:
+      /* broken map file: very large jumps */
+      i = (r & 1) ? 32767 : -29999;
+      break;
+
+    default:
+      h += int(r % 201) - 100;
+      i = h;
+    }
+  }
+}
+
+static bool
+TestHeightIndices(unsigned height_scale, unsigned contour_height_scale)
+{
+  uint8_t index1[WIDTH * HEIGHT], contour1[WIDTH * HEIGHT];
+  uint8_t index2[WIDTH * HEIGHT], contour2[WIDTH * HEIGHT];
+
+  PortableRasterKernels::HeightIndices(heights, ARRAY_SIZE(heights),
+                                       height_scale, contour_height_scale,
+                                       index1, contour1);
+  RasterKernels::HeightIndices(heights, ARRAY_SIZE(heights),
+                               height_scale, contour_height_scale,
+                               index2, contour2);
+
+  for (unsigned i = 0; i < ARRAY_SIZE(heights); ++i)
+    if (!RasterBuffer::IsSpecial(heights[i]) && index1[i] != index2[i])
+      return false;
+
+  return memcmp(contour1, contour2, sizeof(contour1)) == 0;
+}
+
+static bool
+TestIllumination(unsigned q, const SlopeShadingParameters &params)
+{
+  int8_t dest1[WIDTH], dest2[WIDTH];
+
+  for (unsigned y = q; y < HEIGHT - q; ++y) {
+    /* vary the start column and the length, to test the portable
+       remainder of the optimised implementation */
+    const unsigned start = q + y % 3;
+    const unsigned n = WIDTH - q - start - y % 7;
+    const short *src = heights + y * WIDTH + start;
+
+    PortableRasterKernels::Illumination(src, q * WIDTH, q * WIDTH, q, 2 * q,
+                                        n, params, dest1);
+    RasterKernels::Illumination(src, q * WIDTH, q * WIDTH, q, 2 * q,
+                                n, params, dest2);
+
+    if (memcmp(dest1, dest2, n) != 0)
+      return false;
+  }
+
+  return true;
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(8);
+
+  FillHeights();
+
+  ok1(TestHeightIndices(0, 16));
+  ok1(TestHeightIndices(4, 8));
+  ok1(TestHeightIndices(6, 16));
+
+  SlopeShadingParameters params;
+  params.sx = -130;
+  params.sy = 170;
+  params.sz = 120;
+  params.contrast = 160;
+  params.height_slope_factor = 60;
+  ok1(TestIllumination(1, params));
+
+  params.height_slope_factor = 8192;
+  ok1(TestIllumination(1, params));
+
+  params.sx = 200;
+  params.sy = -90;
+  params.sz = 44;
+  params.contrast = 255;
+  params.height_slope_factor = 8192 / (4 * 4);
+  ok1(TestIllumination(4, params));
+
+  params.contrast = 0;
+  params.height_slope_factor = 1;
+  ok1(TestIllumination(2, params));
+
+  params.contrast = 64;
+  params.height_slope_factor = 8192 / (25 * 25);
+  ok1(TestIllumination(25, params));
+
+  return exit_status();
+}
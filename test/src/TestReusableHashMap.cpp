@@ -0,0 +1,88 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "PathSolvers/ReusableHashMap.hpp"
+#include "TestUtil.hpp"
+
+struct Hash {
+  size_t operator()(unsigned key) const {
+    return key;
+  }
+};
+
+typedef ReusableHashMap<unsigned, unsigned, Hash> Map;
+
+static void
+TestInsert(Map &map, unsigned n)
+{
+  map.clear();
+  ok1(map.empty());
+
+  bool inserted = true;
+  for (unsigned i = 0; i < n; ++i)
+    inserted &= map.insert(std::make_pair(i * 7, i)).second;
+  ok1(inserted);
+  ok1(map.size() == n);
+
+  /* duplicates are refused, and the old value is kept */
+  auto result = map.insert(std::make_pair(7u, 42u));
+  ok1(!result.second);
+  ok1(result.first->second == 1);
+
+  bool found = true;
+  for (unsigned i = 0; i < n; ++i) {
+    auto it = map.find(i * 7);
+    found &= it != map.end() && it->first == i * 7 && it->second == i;
+  }
+  ok1(found);
+  ok1(map.find(3) == map.end());
+
+  /* iteration follows insertion order */
+  unsigned i = 0;
+  bool ordered = true;
+  for (const auto &element : map)
+    ordered &= element.first == i++ * 7;
+  ok1(ordered && i == n);
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(3 * 8 + 4);
+
+  Map map;
+  TestInsert(map, 1000);
+
+  /* after clear(), nothing is found, and the memory is reused */
+  const size_t usage = map.GetMemoryUsage();
+  map.clear();
+  ok1(map.find(7) == map.end());
+  ok1(map.begin() == map.end());
+
+  TestInsert(map, 1000);
+  ok1(map.GetMemoryUsage() == usage);
+
+  TestInsert(map, 5000);
+  ok1(map.GetMemoryUsage() > usage);
+
+  return exit_status();
+}
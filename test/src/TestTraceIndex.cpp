@@ -0,0 +1,153 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Engine/Contest/Solvers/TraceIndex.hpp"
+#include "Engine/Trace/Point.hpp"
+#include "Engine/Trace/Vector.hpp"
+#include "Geo/Flat/FlatProjection.hpp"
+#include "TestUtil.hpp"
+
+#include <vector>
+#include <algorithm>
+
+static std::vector<TracePoint> points;
+static TracePointerVector trace;
+
+/**
+ * Generate a random walk, so neighbouring points are close to each
+ * other like in a real trace.
+ */
+static void
+Generate(unsigned n)
+{
+  const GeoPoint center(Angle::Degrees(7), Angle::Degrees(51));
+  const FlatProjection projection(center);
+
+  points.clear();
+  trace.clear();
+
+  unsigned seed = 42;
+  GeoPoint location = center;
+  for (unsigned i = 0; i < n; ++i) {
+    seed = seed * 1103515245 + 12345;
+    location.longitude += Angle::Degrees(fixed(int(seed >> 16) % 201 - 100) / 10000);
+    seed = seed * 1103515245 + 12345;
+    location.latitude += Angle::Degrees(fixed(int(seed >> 16) % 201 - 100) / 10000);
+
+    TracePoint point(location, i, fixed(0), fixed(0), 0);
+    point.Project(projection);
+    points.push_back(point);
+  }
+
+  for (const auto &point : points)
+    trace.push_back(&point);
+}
+
+static bool
+Equals(const FlatBoundingBox &a, const FlatBoundingBox &b)
+{
+  return a.GetLowerLeft() == b.GetLowerLeft() &&
+    a.GetUpperRight() == b.GetUpperRight();
+}
+
+static void
+TestRangeBounds(unsigned n)
+{
+  Generate(n);
+
+  TraceRangeBounds bounds;
+  bounds.Build(trace, n);
+
+  bool equal = true;
+  for (unsigned min = 0; min < n; ++min) {
+    FlatBoundingBox expected(trace[min]->GetFlatLocation());
+    for (unsigned max = min + 1; max <= n; ++max) {
+      expected.Expand(trace[max - 1]->GetFlatLocation());
+      equal &= Equals(bounds.Get(min, max), expected);
+    }
+  }
+
+  ok1(equal);
+}
+
+static void
+TestGrid(unsigned n, unsigned min_cell_size, unsigned range)
+{
+  Generate(n);
+
+  TracePointGrid grid;
+  grid.Build(trace, n, min_cell_size);
+
+  bool sorted = true, equal = true;
+  for (unsigned i = 0; i < n; i += 7) {
+    const FlatGeoPoint location = trace[i]->GetFlatLocation();
+
+    std::vector<unsigned> found;
+    grid.VisitCells(FlatBoundingBox(location, range),
+                    [location, range, &found, &sorted]
+                    (const unsigned *begin, const unsigned *end) {
+      sorted &= std::is_sorted(begin, end);
+      for (const unsigned *j = begin; j != end; ++j)
+        if (trace[*j]->GetFlatLocation().DistanceSquared(location) <= range * range)
+          found.push_back(*j);
+    });
+
+    std::vector<unsigned> expected;
+    for (unsigned j = 0; j < n; ++j)
+      if (trace[j]->GetFlatLocation().DistanceSquared(location) <= range * range)
+        expected.push_back(j);
+
+    std::sort(found.begin(), found.end());
+    equal &= found == expected;
+  }
+
+  ok1(sorted);
+  ok1(equal);
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(4 + 2 * 4 + 1);
+
+  TestRangeBounds(1);
+  TestRangeBounds(2);
+  TestRangeBounds(100);
+  TestRangeBounds(777);
+
+  TestGrid(1000, 10, 10);
+  TestGrid(1000, 10, 35);
+  /* tiny cells are enlarged */
+  TestGrid(1000, 1, 10);
+  TestGrid(5000, 20, 3);
+
+  TracePointGrid grid;
+  grid.Build(trace, 0, 10);
+  bool visited = false;
+  grid.VisitCells(FlatBoundingBox(trace[0]->GetFlatLocation(), 100),
+                  [&visited](const unsigned *, const unsigned *) {
+                    visited = true;
+                  });
+  ok1(!visited);
+
+  return exit_status();
+}
@@ -163,8 +163,8 @@ test_replay(const Contest olc_type,
   TraceComputer trace_computer;
 
   ContestManager contest_manager(olc_type,
-                                 trace_computer.GetFull(),
-                                 trace_computer.GetFull(),
+                                 trace_computer.GetSolverFull(),
+                                 trace_computer.GetSolverFull(),
                                  trace_computer.GetSprint());
   contest_manager.SetHandicap(settings_computer.contest.handicap);
 
@@ -180,6 +180,7 @@ test_replay(const Contest olc_type,
     calculated.flight.flying = true;
     
     trace_computer.Update(settings_computer, basic, calculated);
+    trace_computer.Flush(settings_computer);
     
     contest_manager.UpdateIdle();
   
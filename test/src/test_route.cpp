@@ -138,6 +138,11 @@ test_route(const unsigned n_airspaces, const RasterMap& map)
     AirspaceRoute route;
     route.UpdatePolar(settings, polar, polar, wind);
     route.SetTerrain(&map);
+
+    // the same, but with a view of the master airspaces
+    AirspaceRoute route_view(true);
+    route_view.UpdatePolar(settings, polar, polar, wind);
+    route_view.SetTerrain(&map);
     RoutePlannerConfig config;
     config.mode = RoutePlannerConfig::Mode::BOTH;
 
@@ -162,6 +167,11 @@ test_route(const unsigned n_airspaces, const RasterMap& map)
       char buffer[80];
       sprintf(buffer, "route %d solution", i);
       ok(sol, buffer, 0);
+
+      route_view.Synchronise(airspaces, predicate, loc_start, loc_end);
+      sprintf(buffer, "route %d view solution", i);
+      ok(route_view.Solve(loc_start, loc_end, config) == sol &&
+         route_view.AirspaceSize() == route.AirspaceSize(), buffer, 0);
     }
   }
 
@@ -187,7 +197,7 @@ main(int argc, char** argv)
     map.SetViewCenter(map.GetMapCenter(), fixed(100000));
   } while (map.IsDirty());
 
-  plan_tests(4 + NUM_SOL);
+  plan_tests(4 + 2 * NUM_SOL);
   ok(test_route(28, map), "route 28", 0);
   return exit_status();
 }